@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    GainStageBenchmark.cpp
+    Created: 17 Oct 2026 4:05:51pm
+    Author:  jwmao
+
+    Micro-benchmark for the output gain: the old per-sample
+    Decibels::decibelsToGain (volume.getNextValue()) loop against GainStage,
+    for unity, steady and ramping gain. Prints cycles per sample (TSC on x86,
+    high resolution ticks elsewhere).
+
+    Build as a console app with juce_core and juce_audio_basics, adding
+    ../Source/GainStage.cpp to the target.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/GainStage.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 20000;
+    constexpr double sampleRate = 48000.0;
+
+    juce::uint64 readCycleCounter()
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    // fill with something that isn't denormal or zero
+    void fillBuffer (juce::AudioBuffer<float>& buffer)
+    {
+        juce::Random random (1234);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    template <typename Function>
+    double measureCyclesPerSample (Function&& processBlock)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        fillBuffer (buffer);
+
+        // warm up caches and branch predictors
+        for (int i = 0; i < 100; ++i)
+            processBlock (buffer, i);
+
+        const auto start = readCycleCounter();
+
+        for (int i = 0; i < numBlocks; ++i)
+            processBlock (buffer, i);
+
+        const auto elapsed = readCycleCounter() - start;
+
+        // per sample frame, all channels
+        return (double) elapsed / ((double) numBlocks * blockSize);
+    }
+
+    // what processBlock() used to do
+    double measureOldLoop (float fromDecibels, float toDecibels)
+    {
+        juce::SmoothedValue<float> volume {fromDecibels};
+        volume.reset (sampleRate, 0.02);
+
+        return measureCyclesPerSample ([&] (juce::AudioBuffer<float>& buffer, int blockIndex)
+        {
+            // keep the ramp going for the ramp case
+            if (fromDecibels != toDecibels && ! volume.isSmoothing())
+                volume.setTargetValue ((blockIndex & 1) != 0 ? fromDecibels : toDecibels);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                auto* channelData = buffer.getWritePointer (channel);
+
+                for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                    channelData[sample] *= juce::Decibels::decibelsToGain (volume.getNextValue());
+            }
+        });
+    }
+
+    double measureGainStage (float fromDecibels, float toDecibels)
+    {
+        GainStage gainStage;
+        gainStage.setGainDecibels (fromDecibels);
+        gainStage.prepare (sampleRate, blockSize, 0.02);
+
+        return measureCyclesPerSample ([&] (juce::AudioBuffer<float>& buffer, int blockIndex)
+        {
+            if (fromDecibels != toDecibels && ! gainStage.isSmoothing())
+                gainStage.setGainDecibels ((blockIndex & 1) != 0 ? fromDecibels : toDecibels);
+
+            gainStage.process (buffer, 0, buffer.getNumSamples());
+        });
+    }
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    struct Case { const char* name; float from, to; };
+    const Case cases[] = { { "unity (0 dB)",      0.0f,   0.0f },
+                           { "steady (-6 dB)",   -6.0f,  -6.0f },
+                           { "ramping (-6/+6 dB)", -6.0f, 6.0f } };
+
+    std::cout << "cycles per sample frame (" << numChannels << " channels, " << blockSize << " sample blocks)" << std::endl;
+    std::cout << juce::String ("case").paddedRight (' ', 22) << juce::String ("before").paddedLeft (' ', 10)
+              << juce::String ("after").paddedLeft (' ', 10) << std::endl;
+
+    for (auto& c : cases)
+    {
+        const auto before = measureOldLoop (c.from, c.to);
+        const auto after = measureGainStage (c.from, c.to);
+
+        std::cout << juce::String (c.name).paddedRight (' ', 22)
+                  << juce::String (before, 2).paddedLeft (' ', 10)
+                  << juce::String (after, 2).paddedLeft (' ', 10) << std::endl;
+    }
+
+    return 0;
+}
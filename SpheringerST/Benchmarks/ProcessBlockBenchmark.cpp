@@ -0,0 +1,433 @@
+/*
+  ==============================================================================
+
+    ProcessBlockBenchmark.cpp
+    Created: 17 Oct 2026 9:03:18pm
+    Author:  jwmao
+
+    Benchmark for the whole of processBlock(): drives the processor with
+    synthetic MIDI (single notes, 16-note chords, fast repeated notes and
+    voice stealing storms) over the bundled "Omni AB_S_*" samples, and sweeps
+    block size, sample rate and polyphony, and how samples are stored in
+    memory (see CompactAudioBuffer) to weigh the memory saved against the
+    decoding cost. Output layouts wider than stereo measure what encoding
+    every voice for Ambisonics or surround costs (see SpatialLayout).
+
+    Prints one JSON object per line so runs can be diffed and plotted over
+    time: a "machine" line first, then one line per case with ns per sample
+    frame, mean and p99 block time as a percentage of the block's realtime
+    budget, the bytes of sample data in memory (and as floats), and the disk
+    underruns seen while measuring (which make a case look cheaper than it is).
+
+        ProcessBlockBenchmark [--samples <folder>] [--seconds 2]
+                              [--patterns single,chord,repeat,storm]
+                              [--blocks 16,64,256,1024,4096] [--rates 44100,192000]
+                              [--voices 16,64,256] [--storage float32,int16,int24]
+                              [--layouts stereo,ambisonic1,ambisonic3,7.1.4]
+                              [--parallel]
+
+    Without --samples it looks for the WAVs in the current folder and the
+    folders above it. They are copied to a temporary folder first: loading at
+    a rate other than their own makes the loader write resampled copies and
+    caches next to the files, which must not end up in the checkout. Build as a console app with the same modules and
+    JuceLibraryCode config as the plugin, adding all of ../Source/*.cpp.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+namespace
+{
+    enum class Pattern { single, chord, repeat, storm };
+
+    const char* getPatternName (Pattern pattern)
+    {
+        switch (pattern)
+        {
+            case Pattern::single: return "single";
+            case Pattern::chord:  return "chord";
+            case Pattern::repeat: return "repeat";
+            case Pattern::storm:  return "storm";
+        }
+
+        return "";
+    }
+
+    struct Options
+    {
+        juce::File samples;
+        double seconds = 2.0;
+        juce::Array<Pattern> patterns { Pattern::single, Pattern::chord, Pattern::repeat, Pattern::storm };
+        juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<int> sampleRates { 44100, 48000, 96000, 192000 };
+        juce::Array<int> voiceCounts { 16, 64, 256 };
+        juce::Array<SampleStorage> storages { SampleStorage::float32 };
+        juce::StringArray layouts { "stereo" };
+        bool parallel = false;
+    };
+
+    struct Result
+    {
+        int numBlocks = 0;
+        double nsPerSample = 0.0;
+        double meanBudgetPercent = 0.0;
+        double p99BlockNs = 0.0;
+        double p99BudgetPercent = 0.0;
+        double maxBlockNs = 0.0;
+        int underruns = 0;
+        juce::int64 sampleBytes = 0;
+        juce::int64 sampleBytesAsFloat = 0;
+    };
+
+    //==============================================================================
+    // notes for the block [start, start + numSamples), timed to the sample
+    class PatternGenerator
+    {
+    public:
+        PatternGenerator (Pattern p, double rate) : pattern (p), sampleRate (rate) {}
+
+        void fillBlock (juce::MidiBuffer& midi, juce::int64 start, int numSamples)
+        {
+            midi.clear();
+
+            switch (pattern)
+            {
+                // one held note, restarted every two seconds
+                case Pattern::single:
+                    everyPeriod (midi, start, numSamples, 2.0, [this] (juce::MidiBuffer& m, int offset)
+                    {
+                        m.addEvent (juce::MidiMessage::noteOff (1, 69), offset);
+                        m.addEvent (juce::MidiMessage::noteOn (1, 69, (juce::uint8) 100), offset);
+                    });
+                    break;
+
+                // 16 notes over three octaves, held and restarted every two seconds
+                case Pattern::chord:
+                    everyPeriod (midi, start, numSamples, 2.0, [] (juce::MidiBuffer& m, int offset)
+                    {
+                        for (int i = 0; i < 16; ++i)
+                        {
+                            const auto note = 48 + (i * 37) / 16;
+                            m.addEvent (juce::MidiMessage::noteOff (1, note), offset);
+                            m.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) (60 + 4 * i)), offset);
+                        }
+                    });
+                    break;
+
+                // 16th notes at 200 bpm over a few keys, each let go just before the next
+                case Pattern::repeat:
+                    everyPeriod (midi, start, numSamples, 0.075, [this] (juce::MidiBuffer& m, int offset)
+                    {
+                        static constexpr int notes[] = { 69, 72, 74, 72 };
+                        m.addEvent (juce::MidiMessage::noteOff (1, lastNote), offset);
+                        lastNote = notes[counter++ % 4];
+                        m.addEvent (juce::MidiMessage::noteOn (1, lastNote, (juce::uint8) 100), offset);
+                    });
+                    break;
+
+                // 8 new notes every 10 ms and never a note off, so every voice is stolen over and over
+                case Pattern::storm:
+                    everyPeriod (midi, start, numSamples, 0.01, [this] (juce::MidiBuffer& m, int offset)
+                    {
+                        for (int i = 0; i < 8; ++i)
+                            m.addEvent (juce::MidiMessage::noteOn (1, 36 + random.nextInt (60), (juce::uint8) (30 + random.nextInt (97))), offset);
+                    });
+                    break;
+            }
+        }
+
+    private:
+        template <typename AddEvents>
+        void everyPeriod (juce::MidiBuffer& midi, juce::int64 start, int numSamples, double periodSeconds, AddEvents&& addEvents)
+        {
+            const auto period = juce::jmax ((juce::int64) 1, (juce::int64) (periodSeconds * sampleRate));
+
+            for (auto t = ((start + period - 1) / period) * period; t < start + numSamples; t += period)
+                addEvents (midi, (int) (t - start));
+        }
+
+        const Pattern pattern;
+        const double sampleRate;
+        juce::Random random {1234};
+        int lastNote = 69;
+        int counter = 0;
+    };
+
+    // mono, stereo, ambisonic1 .. ambisonic3, quad, 5.1, 7.1, 7.1.4; disabled() for anything else
+    juce::AudioChannelSet getLayout (const juce::String& name)
+    {
+        if (name == "mono")       return juce::AudioChannelSet::mono();
+        if (name == "stereo")     return juce::AudioChannelSet::stereo();
+        if (name == "quad")       return juce::AudioChannelSet::quadraphonic();
+        if (name == "5.1")        return juce::AudioChannelSet::create5point1();
+        if (name == "7.1")        return juce::AudioChannelSet::create7point1();
+        if (name == "7.1.4")      return juce::AudioChannelSet::create7point1point4();
+
+        const auto order = name.startsWith ("ambisonic") ? name.getTrailingIntValue() : 0;
+
+        if (order > 0 && order <= SpatialLayout::maxAmbisonicOrder)
+            return juce::AudioChannelSet::ambisonic (order);
+
+        return juce::AudioChannelSet::disabled();
+    }
+
+    //==============================================================================
+    Result measure (const Options& options, Pattern pattern, int sampleRate, int blockSize, int numVoices, SampleStorage storage,
+                    const juce::String& layout)
+    {
+        SpheringerSTAudioProcessor processor;
+        processor.setChannelLayoutOfBus (false, 0, getLayout (layout));
+        processor.setSampleStorage (storage);
+        processor.setPolyphony (numVoices);
+        processor.setParallelRendering (options.parallel);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        // not timed. The pool main() holds on to still has the samples decoded for earlier cases, so only a case
+        // with a storage or a rate no case before it had decodes them again
+        processor.loadSamples (options.samples);
+        processor.waitUntilLoaded (60 * 1000);
+
+        juce::AudioBuffer<float> buffer (juce::jmax (processor.getTotalNumOutputChannels(), processor.getTotalNumInputChannels()), blockSize);
+        juce::MidiBuffer midi;
+        PatternGenerator generator (pattern, sampleRate);
+
+        // a quarter second to swap the sound set in and settle caches and the disk thread
+        const auto numWarmUpBlocks = juce::jmax (4, (int) (0.25 * sampleRate / blockSize));
+        const auto numBlocks = juce::jmax (16, (int) (options.seconds * sampleRate / blockSize));
+
+        std::vector<double> blockNs;
+        blockNs.reserve ((size_t) numBlocks);
+
+        const auto nsPerTick = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+        juce::int64 position = 0;
+
+        for (int block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+        {
+            if (block == numWarmUpBlocks)
+                processor.getStreamingStats().reset();
+
+            generator.fillBlock (midi, position, blockSize);
+            buffer.clear();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            if (block >= numWarmUpBlocks)
+                blockNs.push_back ((double) elapsed * nsPerTick);
+
+            position += blockSize;
+        }
+
+        Result result;
+        result.numBlocks = numBlocks;
+        result.underruns = processor.getStreamingStats().underruns.load();
+
+        const auto memoryUse = processor.getSampleMemoryUse();
+        result.sampleBytes = memoryUse.bytes;
+        result.sampleBytesAsFloat = memoryUse.bytesAsFloat;
+
+        const auto budgetNs = 1.0e9 * blockSize / sampleRate;
+        const auto totalNs = std::accumulate (blockNs.begin(), blockNs.end(), 0.0);
+
+        result.nsPerSample = totalNs / ((double) numBlocks * blockSize);
+        result.meanBudgetPercent = 100.0 * totalNs / numBlocks / budgetNs;
+
+        std::sort (blockNs.begin(), blockNs.end());
+        result.p99BlockNs = blockNs[(size_t) juce::jmin (numBlocks - 1, (int) std::ceil (0.99 * numBlocks) - 1)];
+        result.p99BudgetPercent = 100.0 * result.p99BlockNs / budgetNs;
+        result.maxBlockNs = blockNs.back();
+
+        processor.releaseResources();
+        return result;
+    }
+
+    //==============================================================================
+    juce::Array<int> parseList (const juce::String& text)
+    {
+        juce::Array<int> values;
+
+        for (auto& token : juce::StringArray::fromTokens (text, ",", {}))
+            if (token.getIntValue() > 0)
+                values.add (token.getIntValue());
+
+        return values;
+    }
+
+    // the folder the bundled samples are in: here or somewhere above
+    juce::File findSamples()
+    {
+        for (auto folder = juce::File::getCurrentWorkingDirectory(); ! folder.isRoot(); folder = folder.getParentDirectory())
+            if (! folder.findChildFiles (juce::File::findFiles, false, "Omni AB_S_*.wav").isEmpty())
+                return folder;
+
+        return {};
+    }
+
+    // a copy of the sample files in a new temporary folder, deleted again with this
+    struct ScratchSamples
+    {
+        ~ScratchSamples() { folder.deleteRecursively(); }
+
+        bool copyFrom (const juce::File& samples)
+        {
+            folder = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("ProcessBlockBenchmark", {}, false);
+
+            if (! folder.createDirectory())
+                return false;
+
+            juce::AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            for (const auto& file : samples.findChildFiles (juce::File::findFiles, false, formatManager.getWildcardForAllFormats()))
+                if (! file.copyFileTo (folder.getChildFile (file.getFileName())))
+                    return false;
+
+            return true;
+        }
+
+        juce::File folder;
+    };
+
+    bool parseOptions (const juce::ArgumentList& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i].text;
+
+            if (arg == "--parallel")
+            {
+                options.parallel = true;
+                continue;
+            }
+
+            if (i + 1 >= args.size())
+                return false;
+
+            const auto value = args[++i].text;
+
+            if      (arg == "--samples") options.samples = juce::File::getCurrentWorkingDirectory().getChildFile (value);
+            else if (arg == "--seconds") options.seconds = value.getDoubleValue();
+            else if (arg == "--blocks")  options.blockSizes = parseList (value);
+            else if (arg == "--rates")   options.sampleRates = parseList (value);
+            else if (arg == "--voices")  options.voiceCounts = parseList (value);
+            else if (arg == "--layouts") options.layouts = juce::StringArray::fromTokens (value, ",", {});
+            else if (arg == "--storage")
+            {
+                options.storages.clear();
+
+                for (auto storage : { SampleStorage::float32, SampleStorage::int16, SampleStorage::int24 })
+                    if (juce::StringArray::fromTokens (value, ",", {}).contains (CompactAudioBuffer::getName (storage)))
+                        options.storages.add (storage);
+            }
+            else if (arg == "--patterns")
+            {
+                options.patterns.clear();
+
+                for (auto pattern : { Pattern::single, Pattern::chord, Pattern::repeat, Pattern::storm })
+                    if (juce::StringArray::fromTokens (value, ",", {}).contains (getPatternName (pattern)))
+                        options.patterns.add (pattern);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (options.samples == juce::File())
+            options.samples = findSamples();
+
+        return options.samples.isDirectory() && options.seconds > 0.0 && ! options.patterns.isEmpty()
+            && ! options.blockSizes.isEmpty() && ! options.sampleRates.isEmpty() && ! options.voiceCounts.isEmpty()
+            && ! options.storages.isEmpty() && ! options.layouts.isEmpty()
+            && std::all_of (options.layouts.begin(), options.layouts.end(), [] (const juce::String& name) { return ! getLayout (name).isDisabled(); });
+    }
+
+    void printLine (juce::DynamicObject* object)
+    {
+        std::cout << juce::JSON::toString (juce::var (object), true) << std::endl;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    // the processor's parameters need a message manager, nothing here shows a window
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ScopedNoDenormals noDenormals;
+
+    // outlives the pool, which may still have the copies open
+    ScratchSamples scratch;
+
+    // every case's processor is destroyed after it, and with the last one the pool would go too
+    const juce::SharedResourcePointer<SamplePool> samplePool;
+
+    Options options;
+
+    if (! parseOptions (juce::ArgumentList (argc, argv), options))
+    {
+        std::cerr << "usage: ProcessBlockBenchmark [--samples <folder>] [--seconds 2] [--patterns single,chord,repeat,storm]" << std::endl
+                  << "                             [--blocks 16,...,4096] [--rates 44100,...,192000] [--voices 16,64,256]" << std::endl
+                  << "                             [--storage float32,int16,int24] [--layouts stereo,ambisonic3,...] [--parallel]" << std::endl;
+        return 1;
+    }
+
+    if (! scratch.copyFrom (options.samples))
+    {
+        std::cerr << "couldn't copy the samples to " << scratch.folder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    options.samples = scratch.folder;
+
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty ("machine", juce::SystemStats::getComputerName());
+    machine->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty ("cores", juce::SystemStats::getNumPhysicalCpus());
+    machine->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    machine->setProperty ("parallel", options.parallel);
+    printLine (machine);
+
+    for (auto pattern : options.patterns)
+    {
+        for (auto sampleRate : options.sampleRates)
+        {
+            for (auto numVoices : options.voiceCounts)
+            {
+                for (auto blockSize : options.blockSizes)
+                {
+                    for (auto storage : options.storages)
+                    {
+                        for (auto& layout : options.layouts)
+                        {
+                            const auto result = measure (options, pattern, sampleRate, blockSize, numVoices, storage, layout);
+
+                            auto* line = new juce::DynamicObject();
+                            line->setProperty ("pattern", getPatternName (pattern));
+                            line->setProperty ("sampleRate", sampleRate);
+                            line->setProperty ("blockSize", blockSize);
+                            line->setProperty ("voices", numVoices);
+                            line->setProperty ("storage", CompactAudioBuffer::getName (storage));
+                            line->setProperty ("layout", layout);
+                            line->setProperty ("blocks", result.numBlocks);
+                            line->setProperty ("nsPerSample", result.nsPerSample);
+                            line->setProperty ("meanBudgetPercent", result.meanBudgetPercent);
+                            line->setProperty ("p99BlockNs", result.p99BlockNs);
+                            line->setProperty ("p99BudgetPercent", result.p99BudgetPercent);
+                            line->setProperty ("maxBlockNs", result.maxBlockNs);
+                            line->setProperty ("underruns", result.underruns);
+                            line->setProperty ("sampleBytes", result.sampleBytes);
+                            line->setProperty ("sampleBytesAsFloat", result.sampleBytesAsFloat);
+                            printLine (line);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
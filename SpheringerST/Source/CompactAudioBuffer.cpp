@@ -0,0 +1,244 @@
+/*
+  ==============================================================================
+
+    CompactAudioBuffer.cpp
+    Created: 17 Oct 2026 10:27:40pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "CompactAudioBuffer.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+
+ // the 24-bit decoder needs a byte shuffle, which is SSSE3; it's only called if the CPU has it
+ #if JUCE_GCC || JUCE_CLANG
+  #define SPHERINGER_SSSE3_TARGET __attribute__ ((target ("ssse3")))
+ #else
+  #define SPHERINGER_SSSE3_TARGET
+ #endif
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define SPHERINGER_USE_NEON 1
+#endif
+
+namespace
+{
+    constexpr float int16Max = 32767.0f;
+    constexpr float int24Max = 8388607.0f;
+
+    inline juce::int32 readInt24 (const juce::uint8* p) noexcept
+    {
+        // into the top three bytes, then shifted back down for the sign
+        return (juce::int32) (((juce::uint32) p[0] << 8) | ((juce::uint32) p[1] << 16) | ((juce::uint32) p[2] << 24)) >> 8;
+    }
+
+    //==============================================================================
+    void decodeInt16Scalar (const juce::int16* src, float* dest, int numSamples, float scale) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (float) src[i] * scale;
+    }
+
+    void decodeInt24Scalar (const juce::uint8* src, float* dest, int numSamples, float scale) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (float) readInt24 (src + 3 * i) * scale;
+    }
+
+   #if JUCE_INTEL
+    //==============================================================================
+    // eight samples per loop: unpacking a register with itself and shifting right by 16 sign-extends
+    void decodeInt16 (const juce::int16* src, float* dest, int numSamples, float scale) noexcept
+    {
+        const auto gain = _mm_set1_ps (scale);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + i));
+            const auto low = _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+            const auto high = _mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16);
+
+            _mm_storeu_ps (dest + i,     _mm_mul_ps (_mm_cvtepi32_ps (low), gain));
+            _mm_storeu_ps (dest + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (high), gain));
+        }
+
+        decodeInt16Scalar (src + i, dest + i, numSamples - i, scale);
+    }
+
+    // four samples per loop: the shuffle puts each sample's three bytes at the top of a 32-bit lane
+    SPHERINGER_SSSE3_TARGET void decodeInt24SSSE3 (const juce::uint8* src, float* dest, int numSamples, float scale) noexcept
+    {
+        const auto gain = _mm_set1_ps (scale);
+        const auto shuffle = _mm_setr_epi8 (-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        int i = 0;
+
+        // each load reads 16 bytes for 12, so stop while there are at least two samples to spare
+        for (; i + 6 <= numSamples; i += 4)
+        {
+            const auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + 3 * i));
+            const auto samples = _mm_srai_epi32 (_mm_shuffle_epi8 (v, shuffle), 8);
+
+            _mm_storeu_ps (dest + i, _mm_mul_ps (_mm_cvtepi32_ps (samples), gain));
+        }
+
+        decodeInt24Scalar (src + 3 * i, dest + i, numSamples - i, scale);
+    }
+
+    // asked when the plugin is loaded, not the first time the audio thread decodes something
+    const bool useSSSE3 = juce::SystemStats::hasSSSE3();
+
+    void decodeInt24 (const juce::uint8* src, float* dest, int numSamples, float scale) noexcept
+    {
+        if (useSSSE3)
+            decodeInt24SSSE3 (src, dest, numSamples, scale);
+        else
+            decodeInt24Scalar (src, dest, numSamples, scale);
+    }
+   #elif SPHERINGER_USE_NEON
+    //==============================================================================
+    void decodeInt16 (const juce::int16* src, float* dest, int numSamples, float scale) noexcept
+    {
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const auto v = vld1q_s16 (src + i);
+
+            vst1q_f32 (dest + i,     vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (v))), scale));
+            vst1q_f32 (dest + i + 4, vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (v))), scale));
+        }
+
+        decodeInt16Scalar (src + i, dest + i, numSamples - i, scale);
+    }
+
+    // eight samples per loop: the structured load splits the bytes of each sample into three registers
+    void decodeInt24 (const juce::uint8* src, float* dest, int numSamples, float scale) noexcept
+    {
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const auto bytes = vld3_u8 (src + 3 * i);
+            const auto low = vorrq_u16 (vmovl_u8 (bytes.val[0]), vshlq_n_u16 (vmovl_u8 (bytes.val[1]), 8));
+            const auto high = vmovl_s8 (vreinterpret_s8_u8 (bytes.val[2]));
+
+            const auto first = vorrq_s32 (vshlq_n_s32 (vmovl_s16 (vget_low_s16 (high)), 16),
+                                          vreinterpretq_s32_u32 (vmovl_u16 (vget_low_u16 (low))));
+            const auto second = vorrq_s32 (vshlq_n_s32 (vmovl_s16 (vget_high_s16 (high)), 16),
+                                           vreinterpretq_s32_u32 (vmovl_u16 (vget_high_u16 (low))));
+
+            vst1q_f32 (dest + i,     vmulq_n_f32 (vcvtq_f32_s32 (first), scale));
+            vst1q_f32 (dest + i + 4, vmulq_n_f32 (vcvtq_f32_s32 (second), scale));
+        }
+
+        decodeInt24Scalar (src + 3 * i, dest + i, numSamples - i, scale);
+    }
+   #else
+    void decodeInt16 (const juce::int16* src, float* dest, int numSamples, float scale) noexcept
+    {
+        decodeInt16Scalar (src, dest, numSamples, scale);
+    }
+
+    void decodeInt24 (const juce::uint8* src, float* dest, int numSamples, float scale) noexcept
+    {
+        decodeInt24Scalar (src, dest, numSamples, scale);
+    }
+   #endif
+}
+
+//==============================================================================
+CompactAudioBuffer::CompactAudioBuffer (const juce::AudioBuffer<float>& source, SampleStorage storage)
+    : mStorage (storage),
+      mNumChannels (source.getNumChannels()),
+      mNumSamples (source.getNumSamples())
+{
+    mData.allocate ((size_t) mNumChannels * (size_t) mNumSamples * (size_t) getBytesPerSample (storage), false);
+    mScales.allocate ((size_t) juce::jmax (1, mNumChannels), true);
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+    {
+        const auto* in = source.getReadPointer (channel);
+        auto* out = getChannelData (channel);
+
+        if (storage == SampleStorage::float32)
+        {
+            mScales[channel] = 1.0f;
+            std::memcpy (out, in, (size_t) mNumSamples * sizeof (float));
+            continue;
+        }
+
+        const auto maxValue = storage == SampleStorage::int16 ? int16Max : int24Max;
+        const auto peak = source.getMagnitude (channel, 0, mNumSamples);
+        const auto scale = peak > 0.0f ? peak / maxValue : 1.0f;
+        mScales[channel] = scale;
+
+        for (int i = 0; i < mNumSamples; ++i)
+        {
+            const auto value = (juce::int32) juce::jlimit (-maxValue, maxValue, std::round (in[i] / scale));
+
+            if (storage == SampleStorage::int16)
+                reinterpret_cast<juce::int16*> (out)[i] = (juce::int16) value;
+            else
+                juce::ByteOrder::littleEndian24BitToChars (value, out + 3 * i);
+        }
+    }
+}
+
+void CompactAudioBuffer::read (int channel, float* dest, int sourceStart, int numSamples) const noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, mNumChannels));
+    jassert (sourceStart >= 0 && sourceStart + numSamples <= mNumSamples);
+
+    const auto* data = getChannelData (channel);
+
+    switch (mStorage)
+    {
+        case SampleStorage::float32:
+            juce::FloatVectorOperations::copy (dest, reinterpret_cast<const float*> (data) + sourceStart, numSamples);
+            break;
+
+        case SampleStorage::int16:
+            decodeInt16 (reinterpret_cast<const juce::int16*> (data) + sourceStart, dest, numSamples, mScales[channel]);
+            break;
+
+        case SampleStorage::int24:
+            decodeInt24 (reinterpret_cast<const juce::uint8*> (data) + 3 * (size_t) sourceStart, dest, numSamples, mScales[channel]);
+            break;
+    }
+}
+
+void CompactAudioBuffer::read (juce::AudioBuffer<float>& dest, int destStart, int sourceStart, int numSamples) const noexcept
+{
+    jassert (dest.getNumChannels() <= mNumChannels);
+
+    for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+        read (channel, dest.getWritePointer (channel, destStart), sourceStart, numSamples);
+}
+
+int CompactAudioBuffer::getBytesPerSample (SampleStorage storage) noexcept
+{
+    switch (storage)
+    {
+        case SampleStorage::int16:   return 2;
+        case SampleStorage::int24:   return 3;
+        case SampleStorage::float32: break;
+    }
+
+    return (int) sizeof (float);
+}
+
+const char* CompactAudioBuffer::getName (SampleStorage storage) noexcept
+{
+    switch (storage)
+    {
+        case SampleStorage::int16:   return "int16";
+        case SampleStorage::int24:   return "int24";
+        case SampleStorage::float32: break;
+    }
+
+    return "float32";
+}
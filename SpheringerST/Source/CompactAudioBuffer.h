@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    CompactAudioBuffer.h
+    Created: 17 Oct 2026 10:27:40pm
+    Author:  jwmao
+
+    Read-only audio kept as 16 or 24-bit integers instead of floats, for the
+    parts of a sample that live in memory (the head and the mip levels).
+    Voices decode what they need, a render chunk at a time, straight into the
+    scratch buffer the interpolators read from. The decoders are SSE2/SSSE3
+    on x86 and NEON on ARM.
+
+    Every channel gets its own scale from its peak. Filtered mip levels can
+    overshoot full scale, and quiet samples keep all of their bits.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// how the in-memory parts of samples are stored
+enum class SampleStorage
+{
+    float32 = 0,    // as decoded, nothing to do when reading
+    int16,          // half the memory, ~96 dB below each channel's peak
+    int24           // three quarters, ~144 dB below the peak
+};
+
+class CompactAudioBuffer
+{
+public:
+    CompactAudioBuffer() = default;
+
+    // loader thread: encodes the whole of source
+    CompactAudioBuffer (const juce::AudioBuffer<float>& source, SampleStorage storage);
+
+    SampleStorage getStorage() const noexcept { return mStorage; }
+    int getNumChannels() const noexcept { return mNumChannels; }
+    int getNumSamples() const noexcept { return mNumSamples; }
+
+    juce::int64 getSizeInBytes() const noexcept { return (juce::int64) mNumChannels * mNumSamples * getBytesPerSample (mStorage); }
+
+    // what the same audio takes as floats, to see what the storage saves
+    juce::int64 getSizeAsFloat() const noexcept { return (juce::int64) mNumChannels * mNumSamples * (juce::int64) sizeof (float); }
+
+    // any thread: decodes numSamples samples of a channel from sourceStart on into dest
+    void read (int channel, float* dest, int sourceStart, int numSamples) const noexcept;
+
+    // any thread: the same for every channel of dest (which must not have more channels than this)
+    void read (juce::AudioBuffer<float>& dest, int destStart, int sourceStart, int numSamples) const noexcept;
+
+    static int getBytesPerSample (SampleStorage storage) noexcept;
+    static const char* getName (SampleStorage storage) noexcept;
+
+private:
+    char* getChannelData (int channel) const noexcept
+    {
+        return mData.get() + (size_t) channel * (size_t) mNumSamples * (size_t) getBytesPerSample (mStorage);
+    }
+
+    SampleStorage mStorage = SampleStorage::float32;
+    int mNumChannels = 0;
+    int mNumSamples = 0;
+
+    // one channel after the other: 16-bit integers, packed little-endian 24-bit ones or floats
+    juce::HeapBlock<char> mData;
+
+    // what an integer of 1 is worth, per channel
+    juce::HeapBlock<float> mScales;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompactAudioBuffer)
+};
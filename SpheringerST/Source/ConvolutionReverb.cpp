@@ -0,0 +1,764 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 18 Oct 2026 9:48:27am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+#include "RealFFT.h"
+#include "SampleRateConverter.h"
+#include "WakeSemaphore.h"
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int headLength = 64;
+
+    // the partition sizes in the order they follow the head, and which of them the tail thread does
+    struct StageLayout
+    {
+        int partitionSize;
+        bool onTailThread;
+    };
+
+    constexpr StageLayout stageLayouts[] = { { 64,    false },
+                                             { 512,   false },
+                                             { 4096,  true  },
+                                             { 32768, true  } };
+}
+
+//==============================================================================
+// audio for a stretch of time, indexed by absolute frame number
+struct ConvolutionReverb::TimeRing
+{
+    void setSize (int minLength)
+    {
+        const auto length = juce::nextPowerOfTwo (minLength);
+        buffer.setSize (numChannels, length);
+        buffer.clear();
+        mask = length - 1;
+    }
+
+    int getLength() const noexcept { return mask + 1; }
+
+    template <typename Function>
+    void forEachRun (juce::int64 time, int numFrames, Function&& function) const noexcept
+    {
+        for (int done = 0; done < numFrames;)
+        {
+            const auto position = (int) ((time + done) & mask);
+            const auto num = juce::jmin (numFrames - done, getLength() - position);
+
+            function (position, done, num);
+            done += num;
+        }
+    }
+
+    void add (int channel, juce::int64 time, const float* source, int numFrames) noexcept
+    {
+        forEachRun (time, numFrames, [&] (int position, int done, int num)
+        {
+            juce::FloatVectorOperations::add (buffer.getWritePointer (channel, position), source + done, num);
+        });
+    }
+
+    void write (int channel, juce::int64 time, const float* source, int numFrames) noexcept
+    {
+        forEachRun (time, numFrames, [&] (int position, int done, int num)
+        {
+            juce::FloatVectorOperations::copy (buffer.getWritePointer (channel, position), source + done, num);
+        });
+    }
+
+    void clear (int channel, juce::int64 time, int numFrames) noexcept
+    {
+        forEachRun (time, numFrames, [&] (int position, int, int num)
+        {
+            juce::FloatVectorOperations::clear (buffer.getWritePointer (channel, position), num);
+        });
+    }
+
+    void read (int channel, juce::int64 time, float* dest, int numFrames) const noexcept
+    {
+        forEachRun (time, numFrames, [&] (int position, int done, int num)
+        {
+            juce::FloatVectorOperations::copy (dest + done, buffer.getReadPointer (channel, position), num);
+        });
+    }
+
+    // adds the frames to dest and leaves zeros behind for the next time round
+    void addToAndClear (int channel, juce::int64 time, float* dest, int numFrames) noexcept
+    {
+        forEachRun (time, numFrames, [&] (int position, int done, int num)
+        {
+            juce::FloatVectorOperations::add (dest + done, buffer.getReadPointer (channel, position), num);
+            juce::FloatVectorOperations::clear (buffer.getWritePointer (channel, position), num);
+        });
+    }
+
+    juce::AudioBuffer<float> buffer;
+    int mask = 0;
+};
+
+//==============================================================================
+/*  Taps [firstTap, firstTap + numPartitions * size) of the response, in partitions of size frames,
+    convolved a block of size frames at a time in the frequency domain (overlap-save with a
+    delay line of input spectra). The output of a block starting at t goes to t + firstTap.
+*/
+class ConvolutionReverb::PartitionedStage
+{
+public:
+    PartitionedStage (const juce::AudioBuffer<float>& response, int size, int firstTap, int endTap)
+        : mSize (size),
+          mFirstTap (firstTap),
+          mNumPartitions ((endTap - firstTap + size - 1) / size),
+          mNumBins (size + 1),
+          mFFT (2 * size)
+    {
+        const auto spectrumLength = (size_t) (numChannels * mNumPartitions * mNumBins);
+        mResponseReal.resize (spectrumLength);
+        mResponseImag.resize (spectrumLength);
+        mInputReal.resize (spectrumLength);
+        mInputImag.resize (spectrumLength);
+        mInput.resize ((size_t) (numChannels * 2 * size));
+        mSumReal.resize ((size_t) mNumBins);
+        mSumImag.resize ((size_t) mNumBins);
+        mOutput.resize ((size_t) (2 * size));
+
+        // forward then inverse scales by size, which the response's spectra take care of
+        const auto scale = 1.0f / (float) size;
+        std::vector<float> segment ((size_t) (2 * size));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* taps = response.getReadPointer (juce::jmin (channel, response.getNumChannels() - 1));
+
+            for (int partition = 0; partition < mNumPartitions; ++partition)
+            {
+                const auto start = firstTap + partition * size;
+                const auto num = juce::jlimit (0, size, endTap - start);
+
+                std::fill (segment.begin(), segment.end(), 0.0f);
+                juce::FloatVectorOperations::copyWithMultiply (segment.data(), taps + start, scale, num);
+
+                const auto offset = getSpectrumOffset (channel, partition);
+                mFFT.forward (segment.data(), mResponseReal.data() + offset, mResponseImag.data() + offset);
+            }
+        }
+    }
+
+    int getSize() const noexcept { return mSize; }
+    int getFirstTap() const noexcept { return mFirstTap; }
+
+    // where the block being collected starts
+    juce::int64 getBlockStart() const noexcept { return mBlockStart; }
+
+    void reset (juce::int64 blockStart) noexcept
+    {
+        std::fill (mInput.begin(), mInput.end(), 0.0f);
+        std::fill (mInputReal.begin(), mInputReal.end(), 0.0f);
+        std::fill (mInputImag.begin(), mInputImag.end(), 0.0f);
+        mFill = 0;
+        mBlockStart = blockStart;
+    }
+
+    // numFrames of each channel, never past the end of the block being collected. A full block
+    // is convolved straight away and its output added to output.
+    void write (const float* const* input, int numFrames, TimeRing& output) noexcept
+    {
+        jassert (mFill + numFrames <= mSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::copy (getInput (channel) + mSize + mFill, input[channel], numFrames);
+
+        mFill += numFrames;
+
+        if (mFill == mSize)
+            convolveBlock (output);
+    }
+
+private:
+    size_t getSpectrumOffset (int channel, int partition) const noexcept
+    {
+        return (size_t) ((channel * mNumPartitions + partition) * mNumBins);
+    }
+
+    float* getInput (int channel) noexcept { return mInput.data() + (size_t) (channel * 2 * mSize); }
+
+    void convolveBlock (TimeRing& output) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* input = getInput (channel);
+
+            // the spectrum of the last two blocks goes into the delay line...
+            const auto newest = getSpectrumOffset (channel, mPosition);
+            mFFT.forward (input, mInputReal.data() + newest, mInputImag.data() + newest);
+
+            // ...and partition p meets the spectrum from p blocks ago
+            std::fill (mSumReal.begin(), mSumReal.end(), 0.0f);
+            std::fill (mSumImag.begin(), mSumImag.end(), 0.0f);
+
+            for (int partition = 0; partition < mNumPartitions; ++partition)
+            {
+                const auto slot = (mPosition - partition + mNumPartitions) % mNumPartitions;
+                const auto in = getSpectrumOffset (channel, slot);
+                const auto taps = getSpectrumOffset (channel, partition);
+
+                RealFFT::multiplyAdd (mSumReal.data(), mSumImag.data(),
+                                      mInputReal.data() + in, mInputImag.data() + in,
+                                      mResponseReal.data() + taps, mResponseImag.data() + taps, mNumBins);
+            }
+
+            // the second half is the linear convolution for this block
+            mFFT.inverse (mSumReal.data(), mSumImag.data(), mOutput.data());
+            output.add (channel, mBlockStart + mFirstTap, mOutput.data() + mSize, mSize);
+
+            // this block is the previous one next time
+            std::copy (input + mSize, input + 2 * mSize, input);
+        }
+
+        mPosition = (mPosition + 1) % mNumPartitions;
+        mBlockStart += mSize;
+        mFill = 0;
+    }
+
+    const int mSize, mFirstTap, mNumPartitions, mNumBins;
+    RealFFT mFFT;
+
+    // [channel][partition][bin]: the response, and the input spectra of the last mNumPartitions blocks
+    std::vector<float> mResponseReal, mResponseImag;
+    std::vector<float> mInputReal, mInputImag;
+    int mPosition = 0;
+
+    // [channel][2 * size]: the previous block, then the one being collected
+    std::vector<float> mInput;
+    int mFill = 0;
+    juce::int64 mBlockStart = 0;
+
+    std::vector<float> mSumReal, mSumImag, mOutput;
+
+    JUCE_DECLARE_NON_COPYABLE (PartitionedStage)
+};
+
+//==============================================================================
+class ConvolutionReverb::Engine
+{
+public:
+    // response at the processing rate, already normalised
+    explicit Engine (const juce::AudioBuffer<float>& response)
+    {
+        const auto length = response.getNumSamples();
+
+        if (length == 0)
+            return;
+
+        // the head, reversed so each output sample is a plain dot product with the history
+        mHeadLength = juce::jmin (headLength, length);
+        mHead.setSize (numChannels, headLength);
+        mHead.clear();
+        mHistory.setSize (numChannels, 2 * headLength);
+        mHistory.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* taps = response.getReadPointer (juce::jmin (channel, response.getNumChannels() - 1));
+
+            for (int i = 0; i < mHeadLength; ++i)
+                mHead.setSample (channel, headLength - 1 - i, taps[i]);
+        }
+
+        // each stage starts where the one before ends, which is far enough in for it to be on time
+        int firstTap = headLength;
+
+        for (int i = 0; i < juce::numElementsInArray (stageLayouts) && firstTap < length; ++i)
+        {
+            const auto size = stageLayouts[i].partitionSize;
+            auto endTap = length;
+
+            if (i + 1 < juce::numElementsInArray (stageLayouts))
+            {
+                const auto& next = stageLayouts[i + 1];
+                const auto nextFirstTap = next.partitionSize * (next.onTailThread ? 2 : 1);
+                endTap = juce::jmin (length, firstTap + (juce::jmax (0, nextFirstTap - firstTap) + size - 1) / size * size);
+            }
+
+            auto* stage = new PartitionedStage (response, size, firstTap, endTap);
+            (stageLayouts[i].onTailThread ? mTailStages : mStages).add (stage);
+
+            firstTap = firstTap + (endTap - firstTap + size - 1) / size * size;
+        }
+
+        int longestReach = 0;
+
+        for (auto* stage : mStages)
+            longestReach = juce::jmax (longestReach, stage->getFirstTap() + 2 * stage->getSize());
+
+        mEarly.setSize (longestReach + headLength);
+
+        if (! mTailStages.isEmpty())
+            prepareTail();
+    }
+
+    ~Engine()
+    {
+        if (mTailThread != nullptr)
+        {
+            mTailThread->signalThreadShouldExit();
+            mTailWake.post();
+            mTailThread->stopThread (2000);
+        }
+    }
+
+    bool isEmpty() const noexcept { return mHeadLength == 0; }
+
+    // audio thread: adds the reverb of input's first two channels to output's, the wet level ramping from
+    // startGain to endGain. Returns how many samples were missing the tail. With waitForTail it waits for the
+    // tail thread instead, so none are.
+    int process (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int startSample, int numSamples,
+                 float startGain, float endGain, bool waitForTail) noexcept
+    {
+        const auto numInputChannels = juce::jmin (numChannels, input.getNumChannels());
+        const auto numOutputChannels = juce::jmin (numChannels, output.getNumChannels());
+        int numLate = 0;
+
+        if (isEmpty() || numInputChannels == 0 || numOutputChannels == 0)
+            return 0;
+
+        // chunks end on head-length boundaries, which every partition size is a multiple of
+        for (int done = 0; done < numSamples;)
+        {
+            const auto chunk = juce::jmin (numSamples - done, headLength - (int) (mTime & (headLength - 1)));
+
+            // mono input: both sides of the response hear the one channel
+            const float* dry[numChannels] = { input.getReadPointer (0, startSample + done),
+                                              input.getReadPointer (numInputChannels - 1, startSample + done) };
+
+            if (mTailThread != nullptr)
+                sendToTail (dry, chunk);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                convolveHead (channel, dry[channel], chunk);
+
+            for (auto* stage : mStages)
+                stage->write (dry, chunk, mEarly);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                mEarly.addToAndClear (channel, mTime, mWet.getWritePointer (channel), chunk);
+
+            if (mTailThread != nullptr)
+                numLate += addTail (chunk, waitForTail);
+
+            // on top of the dry signal, the gain ramping across the block
+            const auto gainAtStart = startGain + (endGain - startGain) * (float) done / (float) numSamples;
+            const auto gainStep = (endGain - startGain) / (float) numSamples;
+
+            for (int channel = 0; channel < numOutputChannels; ++channel)
+            {
+                auto* out = output.getWritePointer (channel, startSample + done);
+                const auto* wet = mWet.getReadPointer (channel);
+
+                if (gainStep == 0.0f)
+                {
+                    juce::FloatVectorOperations::addWithMultiply (out, wet, gainAtStart, chunk);
+                }
+                else
+                {
+                    for (int i = 0; i < chunk; ++i)
+                        out[i] += wet[i] * (gainAtStart + gainStep * (float) i);
+                }
+            }
+
+            mTime += chunk;
+            done += chunk;
+        }
+
+        return numLate;
+    }
+
+private:
+    //==============================================================================
+    class TailThread : public juce::Thread
+    {
+    public:
+        explicit TailThread (Engine& e) : juce::Thread ("Spheringer reverb tail"), engine (e) {}
+
+        void run() override
+        {
+            const juce::ScopedNoDenormals noDenormals;
+
+            // asleep unless there's a block to do: with no input (nothing playing, the transport stopped) it stays that way
+            while (! threadShouldExit())
+            {
+                if (engine.hasTailBlock())
+                    engine.processTail();
+                else
+                    engine.parkTail();
+            }
+        }
+
+    private:
+        Engine& engine;
+    };
+
+    //==============================================================================
+    void convolveHead (int channel, const float* input, int numFrames) noexcept
+    {
+        // headLength - 1 frames of history, then this chunk
+        auto* history = mHistory.getWritePointer (channel);
+        juce::FloatVectorOperations::copy (history + headLength - 1, input, numFrames);
+
+        const auto* taps = mHead.getReadPointer (channel);
+        auto* wet = mWet.getWritePointer (channel);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            float sum = 0.0f;
+
+            for (int j = 0; j < headLength; ++j)
+                sum += taps[j] * history[i + j];
+
+            wet[i] = sum;
+        }
+
+        std::memmove (history, history + numFrames, (size_t) (headLength - 1) * sizeof (float));
+    }
+
+    //==============================================================================
+    void prepareTail()
+    {
+        int longestReach = 0;
+        mSmallestTailPartition = mTailStages.getFirst()->getSize();
+        mLargestTailPartition = mTailStages.getLast()->getSize();
+
+        for (auto* stage : mTailStages)
+            longestReach = juce::jmax (longestReach, stage->getFirstTap() + 2 * stage->getSize());
+
+        // the input has to last until the tail thread has got to it, even when it's a long block behind
+        mTailInput.setSize (juce::jmax (65536, 4 * mLargestTailPartition));
+        mTailAccumulator.setSize (longestReach + mSmallestTailPartition);
+        mTailOutput.setSize (4 * mTailStages.getFirst()->getFirstTap());
+        mTailChunk.setSize (numChannels, mSmallestTailPartition);
+
+        // nothing reaches the output before the first tail tap: the audio thread can have those zeros right away
+        publishTail();
+
+        mTailThread = std::make_unique<TailThread> (*this);
+        mTailThread->startThread (juce::Thread::Priority::high);
+    }
+
+    // audio thread
+    void sendToTail (const float* const* input, int numFrames) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            mTailInput.write (channel, mTime, input[channel], numFrames);
+
+        // sequentially consistent, like the flag after it: parkTail() raises the flag, then looks at the input time
+        const auto inputTime = mTime + numFrames;
+        mInputTime.store (inputTime);
+
+        // the thread only has something to do once a block has filled up
+        if (inputTime / mSmallestTailPartition > mTime / mSmallestTailPartition
+             && mTailParked.load (std::memory_order_relaxed) && mTailParked.exchange (false))
+            mTailWake.post();
+    }
+
+    // tail thread: sleeps until the audio thread has filled a block (or the engine goes)
+    void parkTail() noexcept
+    {
+        mTailParked.store (true);
+
+        // a block may have filled up between the last look and the flag going up. If the audio thread has
+        // taken the flag down meanwhile it's posting as well, which the wait then takes straight back
+        if (hasTailBlock() && mTailParked.exchange (false))
+            return;
+
+        mTailWake.wait();
+    }
+
+    // tail thread: whether one of its blocks has filled up since it last looked
+    bool hasTailBlock() const noexcept
+    {
+        return mInputTime.load() / mSmallestTailPartition > mTailTime / mSmallestTailPartition;
+    }
+
+    // audio thread: adds what the tail thread has published for this chunk to mWet
+    int addTail (int numFrames, bool waitForTail) noexcept
+    {
+        auto published = mTailPublished.load (std::memory_order_acquire);
+
+        // rendering offline: every run has to come out the same, so the tail is waited for rather than left out
+        while (waitForTail && published < mTime + numFrames && mTailThread->isThreadRunning())
+        {
+            std::this_thread::yield();
+            published = mTailPublished.load (std::memory_order_acquire);
+        }
+
+        const auto available = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numFrames, published - mTime);
+
+        // published too long ago means the tail thread restarted past us
+        if (available > 0 && mTime >= published - mTailOutput.getLength())
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                mTailOutput.forEachRun (mTime, available, [&] (int position, int done, int num)
+                {
+                    juce::FloatVectorOperations::add (mWet.getWritePointer (channel, done),
+                                                      mTailOutput.buffer.getReadPointer (channel, position), num);
+                });
+
+            return numFrames - available;
+        }
+
+        return numFrames;
+    }
+
+    // tail thread
+    void processTail() noexcept
+    {
+        const auto inputTime = mInputTime.load (std::memory_order_acquire);
+
+        // so far behind that the input has been overwritten: start again from the present
+        if (inputTime - mTailTime > mTailInput.getLength() - mLargestTailPartition)
+        {
+            mTailTime = inputTime / mLargestTailPartition * mLargestTailPartition;
+
+            for (auto* stage : mTailStages)
+                stage->reset (mTailTime);
+
+            mTailAccumulator.buffer.clear();
+
+            // what was never worked out is silence, not whatever the ring held last time round
+            if (mPublishedUpTo < mTailTime)
+            {
+                const auto from = juce::jmax (mPublishedUpTo, mTailTime - mTailOutput.getLength());
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    mTailOutput.clear (channel, from, (int) (mTailTime - from));
+
+                mPublishedUpTo = mTailTime;
+                mTailPublished.store (mPublishedUpTo, std::memory_order_release);
+            }
+        }
+
+        while (mTailTime < inputTime && ! mTailThread->threadShouldExit())
+        {
+            const auto chunk = (int) juce::jmin (inputTime - mTailTime,
+                                                 (juce::int64) (mSmallestTailPartition - (int) (mTailTime % mSmallestTailPartition)));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                mTailInput.read (channel, mTailTime, mTailChunk.getWritePointer (channel), chunk);
+
+            for (auto* stage : mTailStages)
+                stage->write (mTailChunk.getArrayOfReadPointers(), chunk, mTailAccumulator);
+
+            mTailTime += chunk;
+            publishTail();
+        }
+    }
+
+    // tail thread: everything no later block can add to any more goes to the audio thread
+    void publishTail() noexcept
+    {
+        auto horizon = std::numeric_limits<juce::int64>::max();
+
+        for (auto* stage : mTailStages)
+            horizon = juce::jmin (horizon, stage->getBlockStart() + stage->getFirstTap());
+
+        // never over what the audio thread hasn't read yet
+        horizon = juce::jmin (horizon, mInputTime.load (std::memory_order_acquire) - headLength + mTailOutput.getLength());
+
+        if (horizon <= mPublishedUpTo)
+            return;
+
+        const auto numFrames = (int) (horizon - mPublishedUpTo);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            mTailAccumulator.forEachRun (mPublishedUpTo, numFrames, [&] (int position, int done, int num)
+            {
+                auto* source = mTailAccumulator.buffer.getWritePointer (channel, position);
+                mTailOutput.write (channel, mPublishedUpTo + done, source, num);
+                juce::FloatVectorOperations::clear (source, num);
+            });
+        }
+
+        mPublishedUpTo = horizon;
+        mTailPublished.store (horizon, std::memory_order_release);
+    }
+
+    //==============================================================================
+    int mHeadLength = 0;
+    juce::AudioBuffer<float> mHead, mHistory;
+
+    // audio thread
+    juce::OwnedArray<PartitionedStage> mStages;
+    TimeRing mEarly;
+    juce::AudioBuffer<float> mWet { numChannels, headLength };
+    juce::int64 mTime = 0;
+
+    // the audio thread writes the input and mInputTime, the tail thread the output and mTailPublished
+    juce::OwnedArray<PartitionedStage> mTailStages;
+    TimeRing mTailInput, mTailOutput;
+    std::atomic<juce::int64> mInputTime {0};
+    std::atomic<juce::int64> mTailPublished {0};
+
+    // raised by the tail thread before it sleeps, taken down by whoever wakes it
+    std::atomic<bool> mTailParked {false};
+    WakeSemaphore mTailWake;
+
+    // tail thread
+    TimeRing mTailAccumulator;
+    juce::AudioBuffer<float> mTailChunk;
+    juce::int64 mTailTime = 0, mPublishedUpTo = 0;
+    int mSmallestTailPartition = 0, mLargestTailPartition = 0;
+
+    std::unique_ptr<TailThread> mTailThread;
+
+    JUCE_DECLARE_NON_COPYABLE (Engine)
+};
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb() = default;
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    // audio has stopped by now
+    delete mPending.exchange (nullptr);
+    delete mRetired.exchange (nullptr);
+    delete mCurrent;
+}
+
+void ConvolutionReverb::prepare (double sampleRate)
+{
+    {
+        const juce::ScopedLock sl (mResponseLock);
+
+        if (sampleRate == mSampleRate)
+            return;
+
+        mSampleRate = sampleRate;
+    }
+
+    publishEngine();
+}
+
+bool ConvolutionReverb::loadImpulseResponse (const juce::File& file, juce::AudioFormatManager& formatManager)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    const auto length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxSeconds * reader->sampleRate));
+    juce::AudioBuffer<float> response (juce::jlimit (1, numChannels, (int) reader->numChannels), length);
+    reader->read (&response, 0, length, 0, true, true);
+
+    {
+        const juce::ScopedLock sl (mResponseLock);
+        mResponseFile = file;
+        mResponse = std::move (response);
+        mResponseSampleRate = reader->sampleRate;
+    }
+
+    publishEngine();
+    return true;
+}
+
+void ConvolutionReverb::clearImpulseResponse()
+{
+    {
+        const juce::ScopedLock sl (mResponseLock);
+        mResponseFile = juce::File();
+        mResponse.setSize (0, 0);
+    }
+
+    publishEngine();
+}
+
+juce::File ConvolutionReverb::getImpulseResponseFile() const
+{
+    const juce::ScopedLock sl (mResponseLock);
+    return mResponseFile;
+}
+
+double ConvolutionReverb::getLengthSeconds() const
+{
+    const juce::ScopedLock sl (mResponseLock);
+    return mResponseSampleRate > 0.0 ? mResponse.getNumSamples() / mResponseSampleRate : 0.0;
+}
+
+void ConvolutionReverb::publishEngine()
+{
+    juce::AudioBuffer<float> response;
+
+    {
+        const juce::ScopedLock sl (mResponseLock);
+
+        if (mResponse.getNumSamples() > 0)
+        {
+            // to the processing rate, band-limited like the samples so a higher rate response doesn't fold back into the room
+            response = SampleRateConverter::resample (mResponse, mResponseSampleRate, mSampleRate);
+            const auto length = response.getNumSamples();
+
+            // unit energy: white noise comes out of the reverb as loud as it went in, whatever the response
+            double energy = 0.0;
+
+            for (int channel = 0; channel < response.getNumChannels(); ++channel)
+                for (int i = 0; i < length; ++i)
+                    energy += (double) response.getSample (channel, i) * response.getSample (channel, i);
+
+            if (energy > 0.0)
+                response.applyGain ((float) (1.0 / std::sqrt (energy / response.getNumChannels())));
+        }
+    }
+
+    // a response that is still pending was never seen by the audio thread, so it can go straight away
+    delete mPending.exchange (new Engine (response), std::memory_order_acq_rel);
+}
+
+void ConvolutionReverb::process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    process (buffer, buffer, startSample, numSamples);
+}
+
+void ConvolutionReverb::process (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept
+{
+    // swap in a new response, once the background thread has taken the last old one away
+    if (mPending.load (std::memory_order_relaxed) != nullptr && mRetired.load (std::memory_order_acquire) == nullptr)
+    {
+        if (auto* next = mPending.exchange (nullptr, std::memory_order_acq_rel))
+        {
+            mRetired.store (mCurrent, std::memory_order_release);
+            mCurrent = next;
+            mLateTailSamples.store (0, std::memory_order_relaxed);
+        }
+    }
+
+    const auto wetLevel = mWetLevel.load (std::memory_order_relaxed);
+    const auto startGain = mCurrentWetLevel;
+    mCurrentWetLevel = wetLevel;
+
+    if (mCurrent == nullptr || mCurrent->isEmpty() || numSamples <= 0)
+        return;
+
+    const auto waitForTail = mNonRealtime.load (std::memory_order_relaxed);
+
+    if (const auto numLate = mCurrent->process (input, output, startSample, numSamples, startGain, wetLevel, waitForTail))
+        mLateTailSamples.fetch_add (numLate, std::memory_order_relaxed);
+}
+
+juce::int64 ConvolutionReverb::getLateTailSamples() const noexcept
+{
+    return mLateTailSamples.load (std::memory_order_relaxed);
+}
+
+int ConvolutionReverb::useTimeSlice()
+{
+    // deleting an engine stops its tail thread, which is why it happens here
+    delete mRetired.exchange (nullptr, std::memory_order_acq_rel);
+    return 100;
+}
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 18 Oct 2026 9:48:27am
+    Author:  jwmao
+
+    Convolution with an impulse response, to put the dry samples in a room.
+    The impulse response is cut into partitions that get longer the later
+    they start (non-uniform partitioned convolution):
+
+        taps     0 ..    64    direct FIR                     audio thread
+                64 ..   512    64-frame partitions (FFT)      audio thread
+               512 ..  8192    512-frame partitions           audio thread
+              8192 .. 65536    4096-frame partitions          tail thread
+             65536 ..   end    32768-frame partitions         tail thread
+
+    A partition of P frames only needs a block of input once P frames of it
+    have come in, and every partition starts at least P taps in, so the
+    output is never late and there is no added latency. The tail partitions
+    start at least 2P taps in, which gives the tail thread P frames of time
+    to deliver. It sleeps until the audio thread has filled one of its
+    blocks, and is woken through a WakeSemaphore, which takes no lock, so
+    nothing wakes it while there's no input. It hands its output back through a ring buffer indexed by time, so the audio
+    thread never waits for it. If it does fall behind, the
+    tail is left out for those samples and counted. Rendering offline (see
+    setNonRealtime()) the audio thread waits for it instead, so a bounce
+    always comes out the same.
+
+    A new impulse response is partitioned on the thread that loads it and
+    swapped in by the audio thread at the start of a block; the old one is
+    deleted by the background thread, like sound sets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ConvolutionReverb : public juce::TimeSliceClient
+{
+public:
+    ConvolutionReverb();
+    ~ConvolutionReverb() override;
+
+    // message thread, from prepareToPlay(): impulse responses are resampled to this rate,
+    // the loaded one again if it changed
+    void prepare (double sampleRate);
+
+    // message / loader thread: reads, resamples and partitions the file, then queues it for the audio thread.
+    // Takes a moment for long responses. Returns false if the file can't be read.
+    bool loadImpulseResponse (const juce::File& file, juce::AudioFormatManager& formatManager);
+    void clearImpulseResponse();
+
+    // empty if none is loaded
+    juce::File getImpulseResponseFile() const;
+
+    // how long the loaded response rings for (after it was cut to maxSeconds), 0 if none is loaded
+    double getLengthSeconds() const;
+
+    // any thread: how much of the reverb is added to the dry signal, 0..1 (ramped over a block)
+    void setWetLevel (float newWetLevel) noexcept { mWetLevel.store (newWetLevel, std::memory_order_relaxed); }
+
+    // any thread: when rendering offline, process() waits for the tail thread rather than leave the tail out
+    void setNonRealtime (bool isNonRealtime) noexcept { mNonRealtime.store (isNonRealtime, std::memory_order_relaxed); }
+
+    // audio thread, after the sampler: adds the reverb of the first two channels to them
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    // audio thread: the same, but adds the reverb of input's first two channels to output's (which may be input)
+    void process (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept;
+
+    // audio thread: whether process() has anything to add, i.e. a response is loaded or on its way
+    bool isActive() const noexcept { return mCurrent != nullptr || mPending.load (std::memory_order_relaxed) != nullptr; }
+
+    // any thread: samples the tail thread didn't deliver in time, since the response was loaded
+    juce::int64 getLateTailSamples() const noexcept;
+
+    // background thread: deletes responses the audio thread has swapped out
+    int useTimeSlice() override;
+
+    // longer responses are cut off
+    static constexpr double maxSeconds = 10.0;
+
+private:
+    struct TimeRing;
+    class PartitionedStage;
+    class Engine;
+
+    // builds an engine from mResponse at mSampleRate and queues it (message / loader thread)
+    void publishEngine();
+
+    // under mResponseLock: what was loaded, at the file's own rate
+    juce::CriticalSection mResponseLock;
+    juce::File mResponseFile;
+    juce::AudioBuffer<float> mResponse;
+    double mResponseSampleRate = 0.0;
+    double mSampleRate = 44100.0;
+
+    // engines on their way to the audio thread and back, like SoundSetExchange
+    std::atomic<Engine*> mPending {nullptr};
+    std::atomic<Engine*> mRetired {nullptr};
+    Engine* mCurrent = nullptr; // audio thread
+
+    std::atomic<float> mWetLevel {0.0f};
+    float mCurrentWetLevel = 0.0f; // audio thread
+
+    std::atomic<bool> mNonRealtime {false};
+
+    std::atomic<juce::int64> mLateTailSamples {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionReverb)
+};
@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    DiskStreamer.cpp
+    Created: 17 Oct 2026 12:31:50pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "DiskStreamer.h"
+
+namespace
+{
+    // how much one stream may read per time slice, so one voice can't hold up the others
+    constexpr int maxFramesPerSlice = 8192;
+}
+
+//==============================================================================
+VoiceStream::VoiceStream() = default;
+
+void VoiceStream::prepare()
+{
+    if (isPrepared())
+        return;
+
+    mRing.setSize (2, ringBufferFrames);
+    mRing.clear();
+}
+
+VoiceStream::~VoiceStream()
+{
+    if (auto* pending = mPendingData.exchange (nullptr))
+        pending->decReferenceCount();
+}
+
+void VoiceStream::start (SampleData* data, int level) noexcept
+{
+    stop();
+
+    if (data == nullptr)
+        return;
+
+    const auto resident = SampleMipMap::getResidentLength (*data, level);
+    const auto length = SampleMipMap::getDecimatedLength (data->getLengthInSamples(), level);
+
+    if (resident >= length)
+        return;
+
+    jassert (isPrepared());
+
+    const auto generation = (mState.load (std::memory_order_relaxed) >> positionBits) + 1;
+
+    mStreamEnd = length;
+    mReadPosition.store (0, std::memory_order_release);
+    mPendingLevel.store (level, std::memory_order_relaxed);
+
+    // the I/O thread gets its own reference; the voice's zone still holds one, so this never frees anything
+    data->incReferenceCount();
+
+    if (auto* stale = mPendingData.exchange (data, std::memory_order_acq_rel))
+        stale->decReferenceCount();
+
+    mActive.store (true, std::memory_order_release);
+    mState.store (pack (generation, resident), std::memory_order_release);
+}
+
+void VoiceStream::stop() noexcept
+{
+    if (! mActive.load (std::memory_order_relaxed))
+        return;
+
+    mActive.store (false, std::memory_order_release);
+
+    if (auto* stale = mPendingData.exchange (nullptr, std::memory_order_acq_rel))
+        stale->decReferenceCount();
+
+    // a new generation makes any read that's still in flight on the I/O thread fail to commit
+    const auto generation = (mState.load (std::memory_order_relaxed) >> positionBits) + 1;
+    mState.store (pack (generation, 0), std::memory_order_release);
+}
+
+bool VoiceStream::waitUntilAvailable (juce::int64 endFrame, int timeoutMs) const noexcept
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+    while (mActive.load (std::memory_order_acquire)
+            && (juce::int64) (mState.load (std::memory_order_acquire) & positionMask) < juce::jmin (endFrame, mStreamEnd))
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::yield();
+    }
+
+    return true;
+}
+
+void VoiceStream::read (juce::AudioBuffer<float>& dest, int destStart, juce::int64 sourceStart, int numFrames, StreamingStats& stats) noexcept
+{
+    const auto writePosition = (juce::int64) (mState.load (std::memory_order_acquire) & positionMask);
+    const auto available = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numFrames, writePosition - sourceStart);
+
+    const auto ringIndex = (int) (sourceStart % ringBufferFrames);
+    const auto firstPart = juce::jmin (available, ringBufferFrames - ringIndex);
+
+    for (int channel = 0; channel < juce::jmin (2, dest.getNumChannels()); ++channel)
+    {
+        dest.copyFrom (channel, destStart, mRing, channel, ringIndex, firstPart);
+
+        if (firstPart < available)
+            dest.copyFrom (channel, destStart + firstPart, mRing, channel, 0, available - firstPart);
+
+        if (available < numFrames)
+            dest.clear (channel, destStart + available, numFrames - available);
+    }
+
+    if (available < numFrames)
+    {
+        stats.underruns.fetch_add (1, std::memory_order_relaxed);
+        stats.underrunFrames.fetch_add (numFrames - available, std::memory_order_relaxed);
+    }
+
+    // how far ahead of the playhead the I/O thread is, ignoring the end of the file
+    if (writePosition < mStreamEnd)
+    {
+        const auto headroom = (int) juce::jmax ((juce::int64) 0, writePosition - (sourceStart + numFrames));
+        auto lowest = stats.lowestHeadroom.load (std::memory_order_relaxed);
+
+        while (headroom < lowest && ! stats.lowestHeadroom.compare_exchange_weak (lowest, headroom, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+bool VoiceStream::service (StreamingStats& stats)
+{
+    // the order matters: the audio thread hands over the sample before it bumps the state,
+    // so a sample we pick up is never older than the state we read
+    const auto active = mActive.load (std::memory_order_acquire);
+    const auto state = mState.load (std::memory_order_acquire);
+    auto* newData = mPendingData.exchange (nullptr, std::memory_order_acq_rel);
+
+    if (newData != nullptr)
+    {
+        SampleData::Ptr data (newData);
+        newData->decReferenceCount(); // the Ptr has taken over the reference start() gave us
+
+        // set before the sample was handed over. A newer level for a newer note can only fail to commit below
+        mLevel = mPendingLevel.load (std::memory_order_relaxed);
+
+        // a retriggered sample can keep its reader open
+        if (data != mData)
+        {
+            mData = data;
+            mReader = mData->isMemoryMapped() ? nullptr : mData->createReader();
+        }
+    }
+
+    if (! active)
+    {
+        // let go of the file once the voice is done with it
+        if (newData == nullptr)
+        {
+            mReader.reset();
+            mData = nullptr;
+        }
+
+        return false;
+    }
+
+    if (mData == nullptr || (mReader == nullptr && ! mData->isMemoryMapped()))
+        return false;
+
+    const auto generation = state >> positionBits;
+    const auto writePosition = (juce::int64) (state & positionMask);
+    const auto readPosition = mReadPosition.load (std::memory_order_acquire);
+
+    // never overwrite frames the voice may still read
+    const auto sourceLength = mData->getLengthInSamples();
+    const auto end = juce::jmin (SampleMipMap::getDecimatedLength (sourceLength, mLevel), readPosition + ringBufferFrames);
+    const auto numToRead = (int) juce::jmin ((juce::int64) maxFramesPerSlice, end - writePosition);
+
+    if (numToRead <= 0)
+        return false;
+
+    const auto ringIndex = (int) (writePosition % ringBufferFrames);
+    const auto firstPart = juce::jmin (numToRead, ringBufferFrames - ringIndex);
+
+    auto readInto = [this, sourceLength] (int ringStart, int numFrames, juce::int64 sourceStart)
+    {
+        if (mLevel > 0)
+        {
+            juce::AudioBuffer<float> part (mRing.getArrayOfWritePointers(), mRing.getNumChannels(), ringStart, numFrames);
+            SampleMipMap::readLevel (SampleMipMap::readerFor (*mData, mReader.get()), sourceLength, mLevel, part, sourceStart, numFrames);
+        }
+        else if (mReader != nullptr)
+        {
+            mReader->read (&mRing, ringStart, numFrames, sourceStart, true, true);
+        }
+        else
+        {
+            mData->readMapped (mRing, ringStart, sourceStart, numFrames);
+        }
+    };
+
+    readInto (ringIndex, firstPart, writePosition);
+
+    if (firstPart < numToRead)
+        readInto (0, numToRead - firstPart, writePosition + firstPart);
+
+    // only commit if the voice is still playing the same note
+    auto expected = state;
+
+    if (mState.compare_exchange_strong (expected, pack (generation, writePosition + numToRead), std::memory_order_acq_rel))
+        stats.framesStreamed.fetch_add (numToRead, std::memory_order_relaxed);
+
+    return true;
+}
+
+//==============================================================================
+void DiskStreamer::addStream (VoiceStream* stream)
+{
+    const juce::ScopedLock sl (mStreamsLock);
+    mStreams.addIfNotAlreadyThere (stream);
+}
+
+void DiskStreamer::removeStream (VoiceStream* stream)
+{
+    const juce::ScopedLock sl (mStreamsLock);
+    mStreams.removeFirstMatchingValue (stream);
+}
+
+int DiskStreamer::useTimeSlice()
+{
+    bool busy = false;
+
+    const juce::ScopedLock sl (mStreamsLock);
+
+    for (auto* stream : mStreams)
+        busy = stream->service (mStats) || busy;
+
+    // keep going while there is work, otherwise check back shortly
+    return busy ? 0 : 2;
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    DiskStreamer.h
+    Created: 17 Oct 2026 12:31:50pm
+    Author:  jwmao
+
+    Disk streaming for the sampler voices.
+
+    Every voice owns a VoiceStream per mic layer, a ring buffer that the
+    DiskStreamer (a TimeSliceClient running on its own I/O thread) keeps filled
+    with the part of the sample that comes after its preloaded head. The audio
+    thread only ever reads from the ring and bumps a few atomics.
+
+    A voice playing from a mip level streams that level instead: the I/O thread
+    decimates the file as it reads it, past the level's resident start.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleZone.h"
+
+//==============================================================================
+// counters for sizing the preload and ring buffers against the actual disk speed
+struct StreamingStats
+{
+    std::atomic<int> underruns {0};             // blocks where a voice ran past the streamed data
+    std::atomic<juce::int64> underrunFrames {0}; // frames that were played as silence because of it
+    std::atomic<juce::int64> framesStreamed {0}; // frames read from disk by the I/O thread
+    std::atomic<int> lowestHeadroom {std::numeric_limits<int>::max()}; // fewest frames ever buffered ahead of a voice
+
+    void reset() noexcept
+    {
+        underruns = 0;
+        underrunFrames = 0;
+        framesStreamed = 0;
+        lowestHeadroom = std::numeric_limits<int>::max();
+    }
+};
+
+//==============================================================================
+class VoiceStream
+{
+public:
+    // ring size in frames per voice, ~0.7s at 48kHz
+    static constexpr int ringBufferFrames = 1 << 15;
+
+    VoiceStream();
+    ~VoiceStream();
+
+    // any thread but the audio thread, before the first start(): allocates the ring. Does nothing the second time.
+    // Voices prepare the streams of their extra mic layers only once a set has that many.
+    void prepare();
+    bool isPrepared() const noexcept { return mRing.getNumSamples() > 0; }
+
+    //==============================================================================
+    // audio thread: start streaming the part of a mip level of the sample (level 0 is the sample itself)
+    // that comes after what is in memory
+    void start (SampleData* data, int level) noexcept;
+
+    // audio thread: the voice is done, the I/O thread can let go of the file
+    void stop() noexcept;
+
+    // audio thread: frames before this will not be read again, so the ring may reuse them
+    void setReadPosition (juce::int64 frame) noexcept { mReadPosition.store (frame, std::memory_order_release); }
+
+    // audio thread: copies frames [sourceStart, sourceStart + numFrames) of the streamed part into dest.
+    // Frames that have not arrived yet are zero-filled and counted as an underrun.
+    void read (juce::AudioBuffer<float>& dest, int destStart, juce::int64 sourceStart, int numFrames, StreamingStats& stats) noexcept;
+
+    // offline rendering only: waits until the I/O thread has streamed up to endFrame (or the note stopped).
+    // Returns false on timeout. Never call this from a realtime audio thread.
+    bool waitUntilAvailable (juce::int64 endFrame, int timeoutMs) const noexcept;
+
+    //==============================================================================
+    // I/O thread: read more of the file into the ring, returns true if there was work to do
+    bool service (StreamingStats& stats);
+
+private:
+    // generation and write position are packed together so the I/O thread can only
+    // commit frames for the note that was playing when it started reading them
+    static constexpr int positionBits = 40;
+    static constexpr juce::uint64 positionMask = (((juce::uint64) 1) << positionBits) - 1;
+
+    static juce::uint64 pack (juce::uint64 generation, juce::int64 position) noexcept
+    {
+        return (generation << positionBits) | ((juce::uint64) position & positionMask);
+    }
+
+    juce::AudioBuffer<float> mRing;
+
+    std::atomic<juce::uint64> mState {0};
+    std::atomic<juce::int64> mReadPosition {0};
+    std::atomic<bool> mActive {false};
+    juce::int64 mStreamEnd = 0; // audio thread only
+
+    // sample handed from the audio thread to the I/O thread, carries its own reference. The level is set first
+    std::atomic<SampleData*> mPendingData {nullptr};
+    std::atomic<int> mPendingLevel {0};
+
+    // I/O thread only. Memory-mapped samples are read through the pool, anything else needs a reader per stream.
+    SampleData::Ptr mData;
+    std::unique_ptr<juce::AudioFormatReader> mReader;
+    int mLevel = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoiceStream)
+};
+
+//==============================================================================
+class DiskStreamer : public juce::TimeSliceClient
+{
+public:
+    DiskStreamer() = default;
+
+    // message thread, streams are registered by the voices that own them
+    void addStream (VoiceStream* stream);
+    void removeStream (VoiceStream* stream);
+
+    StreamingStats& getStats() noexcept { return mStats; }
+
+    int useTimeSlice() override;
+
+private:
+    // guards the list against the I/O thread, never taken on the audio thread
+    juce::CriticalSection mStreamsLock;
+    juce::Array<VoiceStream*> mStreams;
+
+    StreamingStats mStats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DiskStreamer)
+};
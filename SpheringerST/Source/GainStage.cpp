@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    GainStage.cpp
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "GainStage.h"
+
+void GainStage::prepare (double sampleRate, int maximumBlockSize, double rampLengthSeconds)
+{
+    mRampCapacity = juce::jmax (1, maximumBlockSize);
+    mRamp.allocate ((size_t) mRampCapacity, true);
+
+    mGain.reset (sampleRate, rampLengthSeconds);
+    reset();
+}
+
+void GainStage::reset() noexcept
+{
+    mCurrentTargetDecibels = mTargetDecibels.load (std::memory_order_relaxed);
+    mGain.setCurrentAndTargetValue (juce::Decibels::decibelsToGain (mCurrentTargetDecibels));
+}
+
+void GainStage::updateTarget() noexcept
+{
+    const auto targetDecibels = mTargetDecibels.load (std::memory_order_relaxed);
+
+    // the only pow() in here, and only when the value actually changed
+    if (targetDecibels != mCurrentTargetDecibels)
+    {
+        mCurrentTargetDecibels = targetDecibels;
+        mGain.setTargetValue (juce::Decibels::decibelsToGain (targetDecibels));
+    }
+}
+
+void GainStage::process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    updateTarget();
+
+    const auto numChannels = buffer.getNumChannels();
+
+    while (numSamples > 0)
+    {
+        if (! mGain.isSmoothing())
+        {
+            const auto gain = mGain.getCurrentValue();
+
+            // steady at unity: nothing to do
+            if (gain == 1.0f)
+                return;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::multiply (buffer.getWritePointer (channel, startSample), gain, numSamples);
+
+            return;
+        }
+
+        // ramp: advance the smoother once per frame, then apply the same gains to every channel
+        jassert (mRampCapacity > 0); // call prepare() first
+
+        if (mRampCapacity == 0)
+            return;
+
+        const auto numThisTime = juce::jmin (numSamples, mRampCapacity);
+
+        for (int i = 0; i < numThisTime; ++i)
+            mRamp[i] = mGain.getNextValue();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply (buffer.getWritePointer (channel, startSample), mRamp, numThisTime);
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
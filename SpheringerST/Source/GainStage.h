@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    GainStage.h
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  jwmao
+
+    Output gain. The dB -> gain conversion happens once per change (not per
+    sample), the ramp is smoothed in the linear domain and advanced once per
+    frame for all channels, steady gain is applied with FloatVectorOperations
+    and unity gain costs nothing at all.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class GainStage
+{
+public:
+    GainStage() = default;
+
+    // message thread, before playback
+    void prepare (double sampleRate, int maximumBlockSize, double rampLengthSeconds = 0.02);
+
+    // any thread; the audio thread picks the new value up on its next block
+    void setGainDecibels (float newGainDecibels) noexcept { mTargetDecibels.store (newGainDecibels, std::memory_order_relaxed); }
+    float getGainDecibels() const noexcept { return mTargetDecibels.load (std::memory_order_relaxed); }
+
+    // audio thread
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    // jump straight to the target, e.g. after a transport reset
+    void reset() noexcept;
+
+    bool isSmoothing() const noexcept { return mGain.isSmoothing(); }
+
+private:
+    void updateTarget() noexcept;
+
+    std::atomic<float> mTargetDecibels {0.0f};
+    float mCurrentTargetDecibels = 0.0f;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mGain {1.0f};
+
+    // per-frame gains of a ramp, worked out once and applied to every channel
+    juce::HeapBlock<float> mRamp;
+    int mRampCapacity = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GainStage)
+};
@@ -0,0 +1,510 @@
+/*
+  ==============================================================================
+
+    Interpolators.cpp
+    Created: 17 Oct 2026 4:52:30pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "Interpolators.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+
+ // the AVX2 kernels are compiled for AVX2 on their own and only called if the CPU has it
+ #if JUCE_GCC || JUCE_CLANG
+  #define SPHERINGER_AVX2_TARGET __attribute__ ((target ("avx2,fma")))
+ #else
+  #define SPHERINGER_AVX2_TARGET
+ #endif
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define SPHERINGER_USE_NEON 1
+#endif
+
+//==============================================================================
+constexpr float SincTable::bandRatios[];
+
+const SincTable& SincTable::getInstance()
+{
+    static const SincTable table;
+    return table;
+}
+
+SincTable::SincTable()
+    : mCoefficients ((size_t) numBands * (size_t) (numPhases + 1) * (size_t) numTaps)
+{
+    constexpr auto pi = juce::MathConstants<double>::pi;
+    constexpr auto halfWidth = (double) (numTaps / 2);
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        // a little below Nyquist of whichever rate is lower, source or output
+        const auto cutoff = 0.9 / (double) bandRatios[band];
+
+        for (int phase = 0; phase <= numPhases; ++phase)
+        {
+            auto* row = mCoefficients.data() + ((size_t) band * (size_t) (numPhases + 1) + (size_t) phase) * (size_t) numTaps;
+            const auto fraction = (double) phase / (double) numPhases;
+            double sum = 0.0;
+
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                // distance between this tap's source frame and the position we want
+                const auto t = (double) (tap - (numTaps / 2 - 1)) - fraction;
+                const auto x = cutoff * t;
+                const auto sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (pi * x) / (pi * x);
+
+                // Blackman window over the kernel's width
+                const auto w = std::abs (t) >= halfWidth ? 0.0
+                                                        : 0.42 + 0.5 * std::cos (pi * t / halfWidth) + 0.08 * std::cos (2.0 * pi * t / halfWidth);
+
+                row[tap] = (float) (cutoff * sinc * w);
+                sum += row[tap];
+            }
+
+            // unity gain at DC for every phase
+            for (int tap = 0; tap < numTaps; ++tap)
+                row[tap] = (float) (row[tap] / sum);
+        }
+    }
+}
+
+int SincTable::getBandForRatio (double ratio) const noexcept
+{
+    for (int band = 0; band < numBands - 1; ++band)
+        if (ratio <= (double) bandRatios[band])
+            return band;
+
+    return numBands - 1;
+}
+
+//==============================================================================
+namespace Interpolators
+{
+    Footprint getFootprint (InterpolationQuality quality) noexcept
+    {
+        switch (quality)
+        {
+            case InterpolationQuality::hermite: return { 1, 2 };
+            case InterpolationQuality::sinc:    return { SincTable::numTaps / 2 - 1, SincTable::numTaps / 2 };
+            case InterpolationQuality::linear:
+            default:                            return { 0, 1 };
+        }
+    }
+
+    //==============================================================================
+    // scalar kernels
+    namespace
+    {
+        inline float hermite (float xm1, float x0, float x1, float x2, float t) noexcept
+        {
+            const auto c1 = 0.5f * (x1 - xm1);
+            const auto c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+            const auto c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+
+            return ((c3 * t + c2) * t + c1) * t + x0;
+        }
+
+        // the two neighbouring coefficient rows and the weight between them for a fractional position
+        struct SincPhase
+        {
+            const float* row0;
+            const float* row1;
+            float weight;
+        };
+
+        inline SincPhase getSincPhase (const float* sincBand, float fraction) noexcept
+        {
+            const auto phase = fraction * (float) SincTable::numPhases;
+            const auto index = juce::jmin ((int) phase, SincTable::numPhases - 1);
+            const auto* row0 = sincBand + (size_t) index * SincTable::numTaps;
+
+            return { row0, row0 + SincTable::numTaps, phase - (float) index };
+        }
+
+        void linearScalar (const float* src, double position, double increment, float* out, int numSamples, const float*)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto t = (float) (pos - index);
+
+                out[i] = src[index] + t * (src[index + 1] - src[index]);
+            }
+        }
+
+        void hermiteScalar (const float* src, double position, double increment, float* out, int numSamples, const float*)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto t = (float) (pos - index);
+
+                out[i] = hermite (src[index - 1], src[index], src[index + 1], src[index + 2], t);
+            }
+        }
+
+        void sincScalar (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto phase = getSincPhase (sincBand, (float) (pos - index));
+                const auto* s = src + index - (SincTable::numTaps / 2 - 1);
+
+                float sum = 0.0f;
+
+                for (int tap = 0; tap < SincTable::numTaps; ++tap)
+                    sum += s[tap] * (phase.row0[tap] + phase.weight * (phase.row1[tap] - phase.row0[tap]));
+
+                out[i] = sum;
+            }
+        }
+
+       #if JUCE_INTEL
+        //==============================================================================
+        // SSE: four outputs at a time for linear/Hermite (the taps are gathered one by one,
+        // the maths is vectorised), four taps at a time for sinc
+        inline float horizontalSum (__m128 v) noexcept
+        {
+            const auto high = _mm_movehl_ps (v, v);
+            const auto pairs = _mm_add_ps (v, high);
+            return _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+        }
+
+        void linearSSE (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            int i = 0;
+
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                alignas (16) float x0[4], x1[4], t[4];
+
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const auto pos = position + (i + lane) * increment;
+                    const auto index = (int) pos;
+
+                    t[lane]  = (float) (pos - index);
+                    x0[lane] = src[index];
+                    x1[lane] = src[index + 1];
+                }
+
+                const auto a = _mm_load_ps (x0);
+                const auto b = _mm_load_ps (x1);
+                _mm_storeu_ps (out + i, _mm_add_ps (a, _mm_mul_ps (_mm_load_ps (t), _mm_sub_ps (b, a))));
+            }
+
+            linearScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        void hermiteSSE (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            const auto half = _mm_set1_ps (0.5f);
+            const auto onePointFive = _mm_set1_ps (1.5f);
+            const auto two = _mm_set1_ps (2.0f);
+            const auto twoPointFive = _mm_set1_ps (2.5f);
+
+            int i = 0;
+
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                alignas (16) float xm1[4], x0[4], x1[4], x2[4], t[4];
+
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const auto pos = position + (i + lane) * increment;
+                    const auto index = (int) pos;
+
+                    t[lane]   = (float) (pos - index);
+                    xm1[lane] = src[index - 1];
+                    x0[lane]  = src[index];
+                    x1[lane]  = src[index + 1];
+                    x2[lane]  = src[index + 2];
+                }
+
+                const auto vxm1 = _mm_load_ps (xm1);
+                const auto vx0  = _mm_load_ps (x0);
+                const auto vx1  = _mm_load_ps (x1);
+                const auto vx2  = _mm_load_ps (x2);
+                const auto vt   = _mm_load_ps (t);
+
+                const auto c1 = _mm_mul_ps (half, _mm_sub_ps (vx1, vxm1));
+                const auto c2 = _mm_sub_ps (_mm_add_ps (_mm_sub_ps (vxm1, _mm_mul_ps (twoPointFive, vx0)), _mm_mul_ps (two, vx1)),
+                                            _mm_mul_ps (half, vx2));
+                const auto c3 = _mm_add_ps (_mm_mul_ps (half, _mm_sub_ps (vx2, vxm1)), _mm_mul_ps (onePointFive, _mm_sub_ps (vx0, vx1)));
+
+                auto y = _mm_add_ps (_mm_mul_ps (c3, vt), c2);
+                y = _mm_add_ps (_mm_mul_ps (y, vt), c1);
+                y = _mm_add_ps (_mm_mul_ps (y, vt), vx0);
+
+                _mm_storeu_ps (out + i, y);
+            }
+
+            hermiteScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        void sincSSE (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto phase = getSincPhase (sincBand, (float) (pos - index));
+                const auto* s = src + index - (SincTable::numTaps / 2 - 1);
+                const auto weight = _mm_set1_ps (phase.weight);
+
+                auto sum = _mm_setzero_ps();
+
+                for (int tap = 0; tap < SincTable::numTaps; tap += 4)
+                {
+                    const auto c0 = _mm_loadu_ps (phase.row0 + tap);
+                    const auto c1 = _mm_loadu_ps (phase.row1 + tap);
+                    const auto c = _mm_add_ps (c0, _mm_mul_ps (weight, _mm_sub_ps (c1, c0)));
+
+                    sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (s + tap), c));
+                }
+
+                out[i] = horizontalSum (sum);
+            }
+        }
+
+        //==============================================================================
+        // AVX2/FMA: eight outputs at a time with hardware gathers for linear/Hermite,
+        // eight taps at a time with FMA for sinc
+        struct Lanes8
+        {
+            __m256i index;
+            __m256 t;
+        };
+
+        SPHERINGER_AVX2_TARGET inline Lanes8 getLanes8 (double base, __m256d offsetsLow, __m256d offsetsHigh) noexcept
+        {
+            const auto posLow  = _mm256_add_pd (_mm256_set1_pd (base), offsetsLow);
+            const auto posHigh = _mm256_add_pd (_mm256_set1_pd (base), offsetsHigh);
+
+            // positions are never negative, so truncating is the same as floor
+            const auto indexLow  = _mm256_cvttpd_epi32 (posLow);
+            const auto indexHigh = _mm256_cvttpd_epi32 (posHigh);
+
+            const auto tLow  = _mm256_cvtpd_ps (_mm256_sub_pd (posLow,  _mm256_cvtepi32_pd (indexLow)));
+            const auto tHigh = _mm256_cvtpd_ps (_mm256_sub_pd (posHigh, _mm256_cvtepi32_pd (indexHigh)));
+
+            return { _mm256_inserti128_si256 (_mm256_castsi128_si256 (indexLow), indexHigh, 1),
+                     _mm256_insertf128_ps (_mm256_castps128_ps256 (tLow), tHigh, 1) };
+        }
+
+        SPHERINGER_AVX2_TARGET void linearAVX2 (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            const auto offsetsLow  = _mm256_mul_pd (_mm256_set_pd (3.0, 2.0, 1.0, 0.0), _mm256_set1_pd (increment));
+            const auto offsetsHigh = _mm256_mul_pd (_mm256_set_pd (7.0, 6.0, 5.0, 4.0), _mm256_set1_pd (increment));
+
+            int i = 0;
+
+            for (; i + 8 <= numSamples; i += 8)
+            {
+                const auto lanes = getLanes8 (position + i * increment, offsetsLow, offsetsHigh);
+                const auto x0 = _mm256_i32gather_ps (src, lanes.index, 4);
+                const auto x1 = _mm256_i32gather_ps (src + 1, lanes.index, 4);
+
+                _mm256_storeu_ps (out + i, _mm256_fmadd_ps (lanes.t, _mm256_sub_ps (x1, x0), x0));
+            }
+
+            linearScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        SPHERINGER_AVX2_TARGET void hermiteAVX2 (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            const auto offsetsLow  = _mm256_mul_pd (_mm256_set_pd (3.0, 2.0, 1.0, 0.0), _mm256_set1_pd (increment));
+            const auto offsetsHigh = _mm256_mul_pd (_mm256_set_pd (7.0, 6.0, 5.0, 4.0), _mm256_set1_pd (increment));
+
+            const auto half = _mm256_set1_ps (0.5f);
+            const auto onePointFive = _mm256_set1_ps (1.5f);
+            const auto two = _mm256_set1_ps (2.0f);
+            const auto twoPointFive = _mm256_set1_ps (2.5f);
+
+            int i = 0;
+
+            for (; i + 8 <= numSamples; i += 8)
+            {
+                const auto lanes = getLanes8 (position + i * increment, offsetsLow, offsetsHigh);
+                const auto xm1 = _mm256_i32gather_ps (src - 1, lanes.index, 4);
+                const auto x0  = _mm256_i32gather_ps (src,     lanes.index, 4);
+                const auto x1  = _mm256_i32gather_ps (src + 1, lanes.index, 4);
+                const auto x2  = _mm256_i32gather_ps (src + 2, lanes.index, 4);
+
+                const auto c1 = _mm256_mul_ps (half, _mm256_sub_ps (x1, xm1));
+                const auto c2 = _mm256_fnmadd_ps (half, x2, _mm256_fmadd_ps (two, x1, _mm256_fnmadd_ps (twoPointFive, x0, xm1)));
+                const auto c3 = _mm256_fmadd_ps (onePointFive, _mm256_sub_ps (x0, x1), _mm256_mul_ps (half, _mm256_sub_ps (x2, xm1)));
+
+                auto y = _mm256_fmadd_ps (c3, lanes.t, c2);
+                y = _mm256_fmadd_ps (y, lanes.t, c1);
+                y = _mm256_fmadd_ps (y, lanes.t, x0);
+
+                _mm256_storeu_ps (out + i, y);
+            }
+
+            hermiteScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        SPHERINGER_AVX2_TARGET void sincAVX2 (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto phase = getSincPhase (sincBand, (float) (pos - index));
+                const auto* s = src + index - (SincTable::numTaps / 2 - 1);
+                const auto weight = _mm256_set1_ps (phase.weight);
+
+                auto sum = _mm256_setzero_ps();
+
+                for (int tap = 0; tap < SincTable::numTaps; tap += 8)
+                {
+                    const auto c0 = _mm256_loadu_ps (phase.row0 + tap);
+                    const auto c1 = _mm256_loadu_ps (phase.row1 + tap);
+                    const auto c = _mm256_fmadd_ps (weight, _mm256_sub_ps (c1, c0), c0);
+
+                    sum = _mm256_fmadd_ps (_mm256_loadu_ps (s + tap), c, sum);
+                }
+
+                const auto quad = _mm_add_ps (_mm256_castps256_ps128 (sum), _mm256_extractf128_ps (sum, 1));
+                const auto pairs = _mm_add_ps (quad, _mm_movehl_ps (quad, quad));
+                out[i] = _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+            }
+        }
+
+       #elif SPHERINGER_USE_NEON
+        //==============================================================================
+        // NEON: same layout as the SSE kernels
+        inline float horizontalSum (float32x4_t v) noexcept
+        {
+           #if JUCE_64BIT
+            return vaddvq_f32 (v);
+           #else
+            const auto pairs = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+            return vget_lane_f32 (vpadd_f32 (pairs, pairs), 0);
+           #endif
+        }
+
+        void linearNEON (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            int i = 0;
+
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                float x0[4], x1[4], t[4];
+
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const auto pos = position + (i + lane) * increment;
+                    const auto index = (int) pos;
+
+                    t[lane]  = (float) (pos - index);
+                    x0[lane] = src[index];
+                    x1[lane] = src[index + 1];
+                }
+
+                const auto a = vld1q_f32 (x0);
+                vst1q_f32 (out + i, vmlaq_f32 (a, vld1q_f32 (t), vsubq_f32 (vld1q_f32 (x1), a)));
+            }
+
+            linearScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        void hermiteNEON (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            int i = 0;
+
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                float xm1[4], x0[4], x1[4], x2[4], t[4];
+
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const auto pos = position + (i + lane) * increment;
+                    const auto index = (int) pos;
+
+                    t[lane]   = (float) (pos - index);
+                    xm1[lane] = src[index - 1];
+                    x0[lane]  = src[index];
+                    x1[lane]  = src[index + 1];
+                    x2[lane]  = src[index + 2];
+                }
+
+                const auto vxm1 = vld1q_f32 (xm1);
+                const auto vx0  = vld1q_f32 (x0);
+                const auto vx1  = vld1q_f32 (x1);
+                const auto vx2  = vld1q_f32 (x2);
+                const auto vt   = vld1q_f32 (t);
+
+                const auto c1 = vmulq_n_f32 (vsubq_f32 (vx1, vxm1), 0.5f);
+                const auto c2 = vsubq_f32 (vaddq_f32 (vsubq_f32 (vxm1, vmulq_n_f32 (vx0, 2.5f)), vmulq_n_f32 (vx1, 2.0f)),
+                                           vmulq_n_f32 (vx2, 0.5f));
+                const auto c3 = vaddq_f32 (vmulq_n_f32 (vsubq_f32 (vx2, vxm1), 0.5f), vmulq_n_f32 (vsubq_f32 (vx0, vx1), 1.5f));
+
+                auto y = vmlaq_f32 (c2, c3, vt);
+                y = vmlaq_f32 (c1, y, vt);
+                y = vmlaq_f32 (vx0, y, vt);
+
+                vst1q_f32 (out + i, y);
+            }
+
+            hermiteScalar (src, position + i * increment, increment, out + i, numSamples - i, sincBand);
+        }
+
+        void sincNEON (const float* src, double position, double increment, float* out, int numSamples, const float* sincBand)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto pos = position + i * increment;
+                const auto index = (int) pos;
+                const auto phase = getSincPhase (sincBand, (float) (pos - index));
+                const auto* s = src + index - (SincTable::numTaps / 2 - 1);
+
+                auto sum = vdupq_n_f32 (0.0f);
+
+                for (int tap = 0; tap < SincTable::numTaps; tap += 4)
+                {
+                    const auto c0 = vld1q_f32 (phase.row0 + tap);
+                    const auto c1 = vld1q_f32 (phase.row1 + tap);
+                    const auto c = vmlaq_n_f32 (c0, vsubq_f32 (c1, c0), phase.weight);
+
+                    sum = vmlaq_f32 (sum, vld1q_f32 (s + tap), c);
+                }
+
+                out[i] = horizontalSum (sum);
+            }
+        }
+       #endif
+    }
+
+    //==============================================================================
+    const KernelSet& getScalarKernels()
+    {
+        static const KernelSet kernels { "scalar", linearScalar, hermiteScalar, sincScalar };
+        return kernels;
+    }
+
+    const KernelSet& getKernels()
+    {
+       #if JUCE_INTEL
+        static const KernelSet sse  { "SSE",      linearSSE,  hermiteSSE,  sincSSE };
+        static const KernelSet avx2 { "AVX2/FMA", linearAVX2, hermiteAVX2, sincAVX2 };
+
+        static const bool useAVX2 = juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+        return useAVX2 ? avx2 : sse;
+       #elif SPHERINGER_USE_NEON
+        static const KernelSet neon { "NEON", linearNEON, hermiteNEON, sincNEON };
+        return neon;
+       #else
+        return getScalarKernels();
+       #endif
+    }
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    Interpolators.h
+    Created: 17 Oct 2026 4:52:30pm
+    Author:  jwmao
+
+    Resampling kernels for the sampler voices: linear, 4-point Hermite and a
+    16-tap windowed-sinc polyphase kernel.
+
+    Every kernel has a scalar version plus SSE, AVX2/FMA and NEON versions.
+    SSE and NEON are chosen at compile time, AVX2 at runtime when the CPU has
+    it, so one binary runs everywhere and still uses the widest registers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+enum class InterpolationQuality
+{
+    linear = 0,
+    hermite,
+    sinc
+};
+
+//==============================================================================
+/*
+    Coefficients for the sinc kernel: numPhases + 1 rows of numTaps taps per band,
+    rows are linearly interpolated for the fractional phase in between.
+    Each band lowers the cutoff for a higher playback ratio, so reading the source
+    faster than its own rate doesn't alias.
+*/
+class SincTable
+{
+public:
+    static constexpr int numTaps = 16;
+    static constexpr int numPhases = 256;
+    static constexpr int numBands = 4;
+
+    // builds the table the first time it's called, so call it before the audio starts
+    static const SincTable& getInstance();
+
+    // the band to use for a given source frames per output sample ratio
+    int getBandForRatio (double ratio) const noexcept;
+
+    // the first row of a band, rows are numTaps floats apart
+    const float* getBand (int band) const noexcept
+    {
+        return mCoefficients.data() + (size_t) band * (size_t) (numPhases + 1) * (size_t) numTaps;
+    }
+
+private:
+    SincTable();
+
+    // the highest ratio each band is designed for
+    static constexpr float bandRatios[numBands] = { 1.0f, 1.5f, 2.0f, 4.0f };
+
+    std::vector<float> mCoefficients;
+
+    JUCE_DECLARE_NON_COPYABLE (SincTable)
+};
+
+//==============================================================================
+namespace Interpolators
+{
+    // how many frames a kernel reads before and after the frame at the integer position
+    struct Footprint
+    {
+        int before = 0;
+        int after = 0;
+    };
+
+    Footprint getFootprint (InterpolationQuality quality) noexcept;
+
+    /*  Resamples one channel: out[i] = src interpolated at (position + i * increment).
+        position must be >= 0, and src[-before] to src[last index + after] must be readable.
+        sincBand is only used by the sinc kernel (see SincTable::getBand()).
+    */
+    using Kernel = void (*) (const float* src, double position, double increment,
+                             float* out, int numSamples, const float* sincBand);
+
+    struct KernelSet
+    {
+        const char* name;
+        Kernel linear;
+        Kernel hermite;
+        Kernel sinc;
+
+        Kernel get (InterpolationQuality quality) const noexcept
+        {
+            switch (quality)
+            {
+                case InterpolationQuality::hermite: return hermite;
+                case InterpolationQuality::sinc:    return sinc;
+                case InterpolationQuality::linear:
+                default:                            return linear;
+            }
+        }
+    };
+
+    // the fastest kernels this CPU can run, chosen once
+    const KernelSet& getKernels();
+
+    // plain C++ versions, what getKernels() gives where neither SSE nor NEON is available
+    const KernelSet& getScalarKernels();
+}
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Created: 17 Oct 2026 9:41:26pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+namespace
+{
+    double ticksToSeconds (juce::int64 ticks) noexcept
+    {
+        return juce::Time::highResolutionTicksToSeconds (ticks);
+    }
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+    stopTrace();
+}
+
+void PerformanceMonitor::pushBlock (const BlockRecord& record) noexcept
+{
+    if (! mBlocks.push (record))
+        mRecordsLost.fetch_add (1, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::postMessage (const juce::String& message)
+{
+    Message entry;
+    entry.ticks = juce::Time::getHighResolutionTicks();
+    message.copyToUTF8 (entry.text, sizeof (entry.text));
+
+    const juce::ScopedLock sl (mMessageWriteLock);
+
+    // waiting here would hold up the loader for every line while the ring is full
+    if (! mMessages.push (entry))
+        mMessagesLost.fetch_add (1, std::memory_order_relaxed);
+}
+
+PerformanceMonitor::Summary PerformanceMonitor::getSummary() const
+{
+    const juce::SpinLock::ScopedLockType sl (mSummaryLock);
+    return mSummary;
+}
+
+//==============================================================================
+bool PerformanceMonitor::startTrace (const juce::File& file)
+{
+    stopTrace();
+
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream> (file);
+
+    if (! stream->openedOk())
+        return false;
+
+    // the JSON array form of the trace event format
+    stream->writeText ("[\n", false, false, nullptr);
+
+    const juce::ScopedLock sl (mTraceLock);
+    mTrace = std::move (stream);
+    mTraceStartTicks = juce::Time::getHighResolutionTicks();
+    mIsFirstTraceEvent = true;
+    return true;
+}
+
+void PerformanceMonitor::stopTrace()
+{
+    const juce::ScopedLock sl (mTraceLock);
+
+    if (mTrace == nullptr)
+        return;
+
+    mTrace->writeText ("\n]\n", false, false, nullptr);
+    mTrace.reset();
+}
+
+bool PerformanceMonitor::isTracing() const
+{
+    const juce::ScopedLock sl (mTraceLock);
+    return mTrace != nullptr;
+}
+
+//==============================================================================
+int PerformanceMonitor::useTimeSlice()
+{
+    const juce::ScopedLock sl (mTraceLock);
+
+    mBlocks.popAll ([this] (const BlockRecord& record)
+    {
+        addToSummary (record);
+
+        if (mTrace != nullptr)
+            traceBlock (record);
+    });
+
+    mMessages.popAll ([this] (const Message& message)
+    {
+        std::cout << message.text << std::endl;
+
+        if (mTrace != nullptr)
+            traceMessage (message);
+    });
+
+    const auto messagesLost = mMessagesLost.load (std::memory_order_relaxed);
+
+    if (messagesLost != mMessagesLostReported)
+    {
+        std::cout << "(" << (messagesLost - mMessagesLostReported) << " log lines dropped)" << std::endl;
+        mMessagesLostReported = messagesLost;
+    }
+
+    if (mTrace != nullptr)
+        mTrace->flush();
+
+    {
+        const juce::SpinLock::ScopedLockType summaryLock (mSummaryLock);
+        mSummary.recordsLost = mRecordsLost.load (std::memory_order_relaxed);
+        mSummary.messagesLost = messagesLost;
+    }
+
+    // a few times per HUD refresh, and often enough that the rings never fill up
+    return 20;
+}
+
+void PerformanceMonitor::addToSummary (const BlockRecord& record)
+{
+    if (record.sampleRate <= 0.0 || record.numSamples <= 0)
+        return;
+
+    const auto budget = record.numSamples / record.sampleRate;
+    const auto busy = ticksToSeconds (record.endTicks - record.startTicks);
+    const auto load = (float) (busy / budget);
+
+    mWindowSeconds += budget;
+    mWindowBusySeconds += busy;
+    mWindowGainSeconds += ticksToSeconds (record.gainEndTicks - record.gainStartTicks);
+    mWindowPeak = juce::jmax (mWindowPeak, load);
+
+    const juce::SpinLock::ScopedLockType sl (mSummaryLock);
+
+    mSummary.activeVoices = record.activeVoices;
+    mSummary.notesStolen += record.notesStolen;
+    mSummary.notesDropped += record.notesDropped;
+
+    if (load > 1.0f)
+        ++mSummary.overloads;
+
+    if (mWindowSeconds >= summaryWindowSeconds)
+    {
+        mSummary.cpuPercent = (float) (100.0 * mWindowBusySeconds / mWindowSeconds);
+        mSummary.gainPercent = (float) (100.0 * mWindowGainSeconds / mWindowSeconds);
+        mSummary.peakPercent = 100.0f * mWindowPeak;
+
+        mWindowSeconds = mWindowBusySeconds = mWindowGainSeconds = 0.0;
+        mWindowPeak = 0.0f;
+    }
+}
+
+//==============================================================================
+double PerformanceMonitor::toTraceMicroseconds (juce::int64 ticks) const noexcept
+{
+    return 1.0e6 * ticksToSeconds (ticks - mTraceStartTicks);
+}
+
+void PerformanceMonitor::traceBlock (const BlockRecord& record)
+{
+    // blocks from before the trace started
+    if (record.startTicks < mTraceStartTicks)
+        return;
+
+    const auto start = toTraceMicroseconds (record.startTicks);
+    const auto budget = 1.0e6 * record.numSamples / juce::jmax (1.0, record.sampleRate);
+
+    writeTraceEvent ("{\"name\":\"processBlock\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" + juce::String (start, 3)
+                     + ",\"dur\":" + juce::String (toTraceMicroseconds (record.endTicks) - start, 3)
+                     + ",\"args\":{\"samples\":" + juce::String (record.numSamples)
+                     + ",\"budgetUs\":" + juce::String (budget, 3)
+                     + ",\"stolen\":" + juce::String (record.notesStolen)
+                     + ",\"dropped\":" + juce::String (record.notesDropped) + "}}");
+
+    const auto gainStart = toTraceMicroseconds (record.gainStartTicks);
+
+    writeTraceEvent ("{\"name\":\"gain\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" + juce::String (gainStart, 3)
+                     + ",\"dur\":" + juce::String (toTraceMicroseconds (record.gainEndTicks) - gainStart, 3) + "}");
+
+    writeTraceEvent ("{\"name\":\"voices\",\"ph\":\"C\",\"pid\":1,\"ts\":" + juce::String (start, 3)
+                     + ",\"args\":{\"active\":" + juce::String (record.activeVoices) + "}}");
+}
+
+void PerformanceMonitor::traceMessage (const Message& message)
+{
+    if (message.ticks < mTraceStartTicks)
+        return;
+
+    writeTraceEvent ("{\"name\":" + juce::JSON::toString (juce::String::fromUTF8 (message.text))
+                     + ",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":2,\"ts\":"
+                     + juce::String (toTraceMicroseconds (message.ticks), 3) + "}");
+}
+
+void PerformanceMonitor::writeTraceEvent (const juce::String& json)
+{
+    if (! mIsFirstTraceEvent)
+        mTrace->writeText (",\n", false, false, nullptr);
+
+    mTrace->writeText (json, false, false, nullptr);
+    mIsFirstTraceEvent = false;
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Created: 17 Oct 2026 9:41:26pm
+    Author:  jwmao
+
+    What the audio thread spends its time on, collected without it ever
+    waiting or allocating. processBlock() pushes one BlockRecord per block
+    into a single-producer single-consumer ring, and the loader and the
+    message thread push their log lines into another one, one at a time
+    under a lock.
+
+    A background TimeSliceThread drains both rings. It keeps the summary the
+    editor's HUD polls and prints the log lines. When a trace file is open, it
+    also writes everything there as Chrome trace events, which open in
+    chrome://tracing or Perfetto.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// a fixed size lock-free queue between exactly one producer thread and one consumer thread
+template <typename Item, int capacity>
+class SpscRing
+{
+public:
+    // producer: returns false (and drops the item) if the consumer has fallen behind
+    bool push (const Item& item) noexcept
+    {
+        if (mFifo.getFreeSpace() == 0)
+            return false;
+
+        mFifo.write (1).forEach ([this, &item] (int index) { mItems[(size_t) index] = item; });
+        return true;
+    }
+
+    // consumer: hands every waiting item to the callback, oldest first
+    template <typename Callback>
+    void popAll (Callback&& callback)
+    {
+        mFifo.read (mFifo.getNumReady()).forEach ([this, &callback] (int index) { callback (mItems[(size_t) index]); });
+    }
+
+private:
+    juce::AbstractFifo mFifo {capacity};
+    std::array<Item, (size_t) capacity> mItems {};
+};
+
+//==============================================================================
+// what processBlock() measured for one block, times in Time::getHighResolutionTicks()
+struct BlockRecord
+{
+    juce::int64 startTicks = 0, endTicks = 0;
+    juce::int64 gainStartTicks = 0, gainEndTicks = 0;
+    double sampleRate = 0.0;
+    int numSamples = 0;
+    int activeVoices = 0;
+    int notesStolen = 0;    // notes that took a voice over from another note
+    int notesDropped = 0;   // notes that found no voice at all
+};
+
+//==============================================================================
+class PerformanceMonitor : public juce::TimeSliceClient
+{
+public:
+    // what the HUD shows. Loads are over the last window of about half a second, counts since the start
+    struct Summary
+    {
+        float cpuPercent = 0.0f;        // time in processBlock() against the realtime budget
+        float peakPercent = 0.0f;       // the worst single block
+        float gainPercent = 0.0f;       // the gain stage's share of the budget
+        int activeVoices = 0;           // in the latest block
+        juce::int64 notesStolen = 0;
+        juce::int64 notesDropped = 0;
+        juce::int64 overloads = 0;      // blocks that took longer than they last
+        juce::int64 recordsLost = 0;    // blocks the audio thread couldn't report because the ring was full
+        juce::int64 messagesLost = 0;   // log lines dropped for the same reason
+    };
+
+    PerformanceMonitor() = default;
+    ~PerformanceMonitor() override;
+
+    // audio thread, once per block
+    void pushBlock (const BlockRecord& record) noexcept;
+
+    // any non-audio thread (the loader's, and the message thread's): a line for the log, cut to fit a ring slot.
+    // Never waits for the background thread: if it has fallen behind, the line is dropped and counted
+    void postMessage (const juce::String& message);
+
+    // any non-audio thread
+    Summary getSummary() const;
+
+    // any non-audio thread: writes everything drained from now on to a Chrome trace file
+    bool startTrace (const juce::File& file);
+    void stopTrace();
+    bool isTracing() const;
+
+    // background thread: drains the rings
+    int useTimeSlice() override;
+
+private:
+    struct Message
+    {
+        juce::int64 ticks = 0;
+        char text[248] {};
+    };
+
+    static constexpr double summaryWindowSeconds = 0.5;
+
+    void addToSummary (const BlockRecord& record);
+    void traceBlock (const BlockRecord& record);
+    void traceMessage (const Message& message);
+    void writeTraceEvent (const juce::String& json);
+    double toTraceMicroseconds (juce::int64 ticks) const noexcept;
+
+    SpscRing<BlockRecord, 4096> mBlocks;
+    SpscRing<Message, 256> mMessages;
+    juce::CriticalSection mMessageWriteLock; // the ring takes one producer at a time, there are several
+    std::atomic<juce::int64> mRecordsLost {0}, mMessagesLost {0};
+    juce::int64 mMessagesLostReported = 0;
+
+    // background thread only: the window that is being summed up
+    double mWindowSeconds = 0.0, mWindowBusySeconds = 0.0, mWindowGainSeconds = 0.0;
+    float mWindowPeak = 0.0f;
+
+    Summary mSummary;
+    mutable juce::SpinLock mSummaryLock;
+
+    mutable juce::CriticalSection mTraceLock;
+    std::unique_ptr<juce::FileOutputStream> mTrace;
+    juce::int64 mTraceStartTicks = 0;
+    bool mIsFirstTraceEvent = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceMonitor)
+};
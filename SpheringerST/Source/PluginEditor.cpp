@@ -21,6 +21,19 @@ audioProcessor (p)
     mLoadButton.onClick = [&]() { audioProcessor.loadFile(); }; // on click execute function in clause
     addAndMakeVisible(mLoadButton); // make button visible
     
+    // same for a whole folder of samples
+    mLoadFolderButton.onClick = [&]() { audioProcessor.loadFolder(); };
+    addAndMakeVisible(mLoadFolderButton);
+    
+    // and for the reverb's impulse response
+    mLoadImpulseResponseButton.onClick = [&]() { audioProcessor.loadImpulseResponse(); };
+    addAndMakeVisible(mLoadImpulseResponseButton);
+    
+    // only shown while a load is in progress, see timerCallback()
+    mStopLoadingButton.onClick = [&]() { audioProcessor.stopLoading(); };
+    addChildComponent(mLoadProgressBar);
+    addChildComponent(mStopLoadingButton);
+    
     // Link audio processor to keyboard state Make MIDI keyboard visible
     p.keyboardState.addListener(this);
     addAndMakeVisible(keyboardComponent);
@@ -33,35 +46,21 @@ audioProcessor (p)
     mAttackSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     // Add text box (value) under the slider
     mAttackSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20); // text box content is fixed, cannot re-enter value by double click and can only change value by dragging the slider vertical dial
-    // Set range of the slider
-    mAttackSlider.setRange(0.01f, 2.0f, 0.01f); // min, max, increment
-    mAttackSlider.setDoubleClickReturnValue(true, 0.1f); // default: 0.1s
-    // Add the audioProcessorEditor as a listener: monitors value change
-    mAttackSlider.addListener(this);
     addAndMakeVisible(mAttackSlider); // make slider visible and add to child component of editor
     
     // Decay
     mDecaySlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     mDecaySlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
-    mDecaySlider.setRange(0.01f, 2.0f, 0.01f);
-    mDecaySlider.setDoubleClickReturnValue(true, 0.1f); // default: 0.1s
-    mDecaySlider.addListener(this);
     addAndMakeVisible(mDecaySlider);
     
     // Sustain
     mSustainSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     mSustainSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
-    mSustainSlider.setRange(0.01f, 10.0f, 0.01f);
-    mSustainSlider.setDoubleClickReturnValue(true, 1.0f); // default: 1.0s
-    mSustainSlider.addListener(this);
     addAndMakeVisible(mSustainSlider);
     
     // Release
     mReleaseSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     mReleaseSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
-    mReleaseSlider.setRange(0.01f, 5.0f, 0.01f);
-    mReleaseSlider.setDoubleClickReturnValue(true, 0.1f); // default: 0.1s
-    mReleaseSlider.addListener(this);
     //change color
     //mReleaseSlider.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::red); // can also input integer for color id
     addAndMakeVisible(mReleaseSlider);
@@ -69,11 +68,13 @@ audioProcessor (p)
     // Add volume slider
     mVolumeSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     mVolumeSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
-    mVolumeSlider.setRange(-20.0f, 20.0f, 0.1f); // in dB
-    mVolumeSlider.setDoubleClickReturnValue(true, 0.0f); // double click to return to detente/neutral position
-    mVolumeSlider.addListener(this);
     addAndMakeVisible(mVolumeSlider);
     
+    // Add reverb slider
+    mReverbSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
+    mReverbSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
+    addAndMakeVisible(mReverbSlider);
+    
     ////////////// Font and UI =================================================================
     
     // Set label texts for the sliders
@@ -111,18 +112,142 @@ audioProcessor (p)
     mVolumeLabel.setJustificationType(juce::Justification::centredTop);
     mVolumeLabel.attachToComponent(&mVolumeSlider, false);
     
-    // on volume value change
-    mVolumeSlider.onValueChange = [this]()
+    // Reverb
+    mReverbLabel.setFont(fontSize);
+    mReverbLabel.setText("Reverb (%)", juce::NotificationType::dontSendNotification);
+    mReverbLabel.setJustificationType(juce::Justification::centredTop);
+    mReverbLabel.attachToComponent(&mReverbSlider, false);
+    
+    // connect the dials to the processor's parameters: range, default (double click) and
+    // host automation all come from there, and moving a dial never touches the audio thread's data
+    mAttackAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "attack", mAttackSlider);
+    mDecayAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "decay", mDecaySlider);
+    mSustainAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "sustain", mSustainSlider);
+    mReleaseAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "release", mReleaseSlider);
+    mVolumeAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "volume", mVolumeSlider);
+    mReverbAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "reverb", mReverbSlider);
+    
+    // mic levels: small horizontal sliders next to the waveform, the labels get the set's position names in timerCallback()
+    for (size_t i = 0; i < mMicSliders.size(); ++i)
+    {
+        mMicSliders[i].setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+        mMicSliders[i].setTextBoxStyle(juce::Slider::TextBoxRight, true, 40, 20);
+        addAndMakeVisible(mMicSliders[i]);
+        
+        mMicLabels[i].setFont(fontSize);
+        mMicLabels[i].setText("Mic " + juce::String(i + 1), juce::NotificationType::dontSendNotification);
+        mMicLabels[i].setJustificationType(juce::Justification::centredLeft);
+        mMicLabels[i].attachToComponent(&mMicSliders[i], true);
+        
+        mMicAttachments[i] = std::make_unique<SliderAttachment>(audioProcessor.apvts, "mic" + juce::String(i + 1), mMicSliders[i]);
+    }
+    
+    // articulations above the mic levels. Not an attachment: the choices come and go with the loaded set,
+    // the parameter's range doesn't
+    mArticulationBox.setTextWhenNoChoicesAvailable("None loaded");
+    mArticulationBox.onChange = [this]()
     {
-        audioProcessor.volume.setTargetValue(mVolumeSlider.getValue());
+        const auto index = mArticulationBox.getSelectedItemIndex();
+        auto* parameter = audioProcessor.apvts.getParameter("articulation");
+        
+        if (parameter != nullptr && index >= 0)
+        {
+            parameter->beginChangeGesture();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1((float) (index + 1)));
+            parameter->endChangeGesture();
+        }
     };
+    addAndMakeVisible(mArticulationBox);
+    
+    mArticulationLabel.setFont(fontSize);
+    mArticulationLabel.setText("Articulation", juce::NotificationType::dontSendNotification);
+    mArticulationLabel.setJustificationType(juce::Justification::centredLeft);
+    mArticulationLabel.attachToComponent(&mArticulationBox, true);
+    
+    // performance HUD: only reads the monitor's summary, the audio thread never waits for us
+    mPerformanceLabel.setFont(fontSize);
+    mPerformanceLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(mPerformanceLabel);
     
+    // the view polls the voices' playheads itself, through the processor's lock-free list
+    mWaveformView.getPlayheads = [this] (juce::uint32 sampleId, juce::Array<juce::int64>& frames) { audioProcessor.getPlayheads(sampleId, frames); };
+    addAndMakeVisible(mWaveformView);
+    
+    startTimerHz(4);
 }
 
 //
 
 SpheringerSTAudioProcessorEditor::~SpheringerSTAudioProcessorEditor()
 {
+    stopTimer();
+    
+    // the keyboard state outlives us
+    audioProcessor.keyboardState.removeListener(this);
+}
+
+void SpheringerSTAudioProcessorEditor::timerCallback()
+{
+    const auto summary = audioProcessor.getPerformanceMonitor().getSummary();
+    
+    juce::String text;
+    text << "CPU " << juce::String(summary.cpuPercent, 1) << "% (peak " << juce::String(summary.peakPercent, 1) << "%, gain "
+         << juce::String(summary.gainPercent, 2) << "%)   voices " << summary.activeVoices << "/" << audioProcessor.getPolyphony()
+         << "   stolen " << summary.notesStolen << "   dropped " << summary.notesDropped
+         << "   overloads " << summary.overloads;
+    
+    if (summary.recordsLost > 0)
+        text << "   (" << summary.recordsLost << " blocks not reported)";
+    
+    if (summary.messagesLost > 0)
+        text << "   (" << summary.messagesLost << " log lines dropped)";
+    
+    mPerformanceLabel.setText(text, juce::dontSendNotification);
+    
+    // a new note or a new set can mean another zone; setZone() does nothing if it's the same one
+    const auto lastNote = mLastNote.load(std::memory_order_relaxed);
+    mWaveformView.setZone(audioProcessor.getZoneForNote(lastNote >= 0 ? lastNote : audioProcessor.baseNum.load()));
+    
+    // file names without a mic prefix leave the position unnamed
+    const auto micPositions = audioProcessor.getMicPositions();
+    
+    for (int i = 0; i < (int) mMicLabels.size(); ++i)
+    {
+        const auto name = micPositions[i].isEmpty() ? "Mic " + juce::String(i + 1) : micPositions[i];
+        mMicLabels[(size_t) i].setText(name, juce::dontSendNotification);
+    }
+    
+    // the set's articulations (as many as the parameter can reach), and the one the parameter points at now
+    const auto maxArticulations = (int) audioProcessor.apvts.getParameterRange("articulation").end;
+    auto articulations = audioProcessor.getArticulations();
+    articulations.removeRange(maxArticulations, articulations.size());
+    
+    if (articulations != mArticulations)
+    {
+        mArticulations = articulations;
+        mArticulationBox.clear(juce::dontSendNotification);
+        
+        // file names without an articulation token share an unnamed one
+        for (int i = 0; i < articulations.size(); ++i)
+            mArticulationBox.addItem(articulations[i].isEmpty() ? "Default" : articulations[i], i + 1);
+    }
+    
+    const auto articulation = juce::roundToInt(audioProcessor.apvts.getRawParameterValue("articulation")->load()) - 1;
+    mArticulationBox.setSelectedItemIndex(juce::jmin(articulation, articulations.size() - 1), juce::dontSendNotification);
+    
+    // the set plays in batches while its files come in, the bar shows how many are left
+    const auto progress = audioProcessor.getLoadProgress();
+    const auto isLoading = progress.filesDone < progress.numFiles;
+    
+    if (isLoading)
+    {
+        mLoadProgress = (double) progress.filesDone / progress.numFiles;
+        mLoadProgressBar.setTextToDisplay((progress.resampling ? "Resampling " : "Loading ") + juce::String(progress.filesDone)
+                                          + " / " + juce::String(progress.numFiles) + " files");
+    }
+    
+    mLoadProgressBar.setVisible(isLoading);
+    mStopLoadingButton.setVisible(isLoading);
 }
 
 //==============================================================================
@@ -173,7 +298,9 @@ void SpheringerSTAudioProcessorEditor::resized()
     // subcomponents in your editor..
     
     // Set button size and position
-    mLoadButton.setBounds(getWidth()/2 - 100, getHeight()/3 - 30, 200, 60);
+    mLoadButton.setBounds(getWidth()/2 - 245, getHeight()/3 - 30, 160, 60);
+    mLoadFolderButton.setBounds(getWidth()/2 - 80, getHeight()/3 - 30, 160, 60);
+    mLoadImpulseResponseButton.setBounds(getWidth()/2 + 85, getHeight()/3 - 30, 160, 60);
     
     // Set MIDI keyboard bounds
     juce::Rectangle<int> r = getLocalBounds();
@@ -182,6 +309,11 @@ void SpheringerSTAudioProcessorEditor::resized()
     float keybHeight = resizedKeybHeight > MAX_KEYB_HEIGHT ? MAX_KEYB_HEIGHT : resizedKeybHeight;
     keyboardComponent.setBounds (MARGIN, MARGIN, keybWidth, keybHeight);
     
+    // load progress in the gap between the keyboard and the buttons
+    const auto progressTop = MARGIN + (int) keybHeight + 1, progressHeight = 15;
+    mLoadProgressBar.setBounds(MARGIN, progressTop, getWidth() - 3 * MARGIN - BUTTON_WIDTH, progressHeight);
+    mStopLoadingButton.setBounds(getWidth() - MARGIN - BUTTON_WIDTH, progressTop, BUTTON_WIDTH, progressHeight);
+    
     // Add ADSR sliders to window and set positions
     // positions are relative values proportional to the physical window length
     // current window size is 600*400
@@ -199,68 +331,49 @@ void SpheringerSTAudioProcessorEditor::resized()
     const auto startXX = 0.2f;
     mVolumeSlider.setBoundsRelative(startXX , startY, dialWidth, dialHeight);
     
+    // Set reverb slider position
+    mReverbSlider.setBoundsRelative(0.05f, startY, dialWidth, dialHeight);
+    
+    // waveform between the buttons and the dials' labels, the mic levels in a column on its right
+    const auto waveformTop = getHeight()/3 + 36;
+    const auto waveformHeight = juce::roundToInt(getHeight() * startY) - 24 - waveformTop;
+    mWaveformView.setBounds(MARGIN, waveformTop, getWidth() - 3 * MARGIN - MIC_COLUMN_WIDTH, waveformHeight);
+    
+    // the articulation on the first row of the column, then a row per mic
+    const auto micLabelWidth = 50;
+    const auto micRowHeight = waveformHeight / ((int) mMicSliders.size() + 1);
+    
+    mArticulationBox.setBounds(getWidth() - MARGIN - MIC_COLUMN_WIDTH + micLabelWidth, waveformTop,
+                               MIC_COLUMN_WIDTH - micLabelWidth, micRowHeight);
+    
+    for (int i = 0; i < (int) mMicSliders.size(); ++i)
+        mMicSliders[(size_t) i].setBounds(getWidth() - MARGIN - MIC_COLUMN_WIDTH + micLabelWidth, waveformTop + (i + 1) * micRowHeight,
+                                          MIC_COLUMN_WIDTH - micLabelWidth, micRowHeight);
+    
+    // HUD along the bottom edge
+    mPerformanceLabel.setBounds(MARGIN, getHeight() - 22, getWidth() - 2 * MARGIN, 20);
+    
 
 }
-/*
 bool SpheringerSTAudioProcessorEditor::isInterestedInFileDrag(const juce::StringArray &files)
 {
-    // check if dropped files are audio files: check on file name suffix
-    // for loop: for a *file* in the input array *files*
-    for (auto file : files)
-    {
-        if (file.contains(".wav") || file.contains(".mp3") || file.contains(".aif"))
-        {
-            return true;
-        }
-    }
-    
-    return false;
+    // check if dropped files are audio files (by the formats the sample pool can read) or folders
+    return audioProcessor.canLoadSamples(files);
 }
 
 void SpheringerSTAudioProcessorEditor::filesDropped(const juce::StringArray &files, int x, int y)
 {
-    for (auto file : files)
-    {
-        if (isInterestedInFileDrag(file))
-        {
-            // if returns true, is an audio file: load this file
-            audioProcessor.loadFile(file);
-        }
-    }
-    
-    repaint(); // dunno what's this for tho...
+    // returns straight away: the files are decoded in the background, timerCallback() shows how far it has got
+    audioProcessor.loadSamples(files);
 }
-*/
 // =========================================================
 
 // pure virtual methods for the Listener classes are re-defined here...
 
-void SpheringerSTAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
-{
-    if (slider == &mAttackSlider)
-    {
-        audioProcessor.getADSRParams().attack = mAttackSlider.getValue();
-    }
-    else if (slider == &mDecaySlider)
-    {
-        audioProcessor.getADSRParams().decay = mDecaySlider.getValue();
-    }
-    else if (slider == &mSustainSlider)
-    {
-        audioProcessor.getADSRParams().sustain = mSustainSlider.getValue();
-    }
-    else if (slider == &mReleaseSlider)
-    {
-        audioProcessor.getADSRParams().release = mReleaseSlider.getValue();
-    }
-    
-    // Update ADSR upon user input
-    audioProcessor.updateADSR();
-}
-
 void SpheringerSTAudioProcessorEditor::handleNoteOn(juce::MidiKeyboardState *source, int midiChannel, int midiNoteNumber, float velocity)
 {
-    
+    // just note it down, the timer picks the zone
+    mLastNote.store(midiNoteNumber, std::memory_order_relaxed);
 }
 
 void SpheringerSTAudioProcessorEditor::handleNoteOff(juce::MidiKeyboardState *source, int midiChannel, int midiNoteNumber, float velocity)
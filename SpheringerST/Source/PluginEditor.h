@@ -11,15 +11,16 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "WaveformView.h"
 
 //==============================================================================
 /**
 */
-// FileDragAndDropTarget and Slider::Listener are an abstract class: just inherit its functions
+// FileDragAndDropTarget is an abstract class: just inherit its functions
 class SpheringerSTAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                         //public juce::FileDragAndDropTarget,
-                                         public juce::Slider::Listener,
-                                         public juce::MidiKeyboardState::Listener
+                                         public juce::FileDragAndDropTarget,
+                                         public juce::MidiKeyboardState::Listener,
+                                         private juce::Timer
 {
 public:
     SpheringerSTAudioProcessorEditor (SpheringerSTAudioProcessor&);
@@ -31,22 +32,28 @@ public:
     
     // virtual functions MUST be specified for this class before building
     // override for independent implementation
-    //bool isInterestedInFileDrag (const juce::StringArray& files) override;
-    //void filesDropped (const juce::StringArray& files, int x, int y) override;
-    
-    // pure virtual function must be implemented before the code can compile
-    // override means refering to existing functions
-    // slider is referring to a pointer
-    void sliderValueChanged(juce::Slider* slider) override;
+    // any mix of audio files and folders can be dropped, they load as one set
+    bool isInterestedInFileDrag (const juce::StringArray& files) override;
+    void filesDropped (const juce::StringArray& files, int x, int y) override;
     
     // specify pure virtual methods as juce::MidiKeyboardState::Listener is an abstract class
     void handleNoteOn (juce::MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
     void handleNoteOff (juce::MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
 
 private:
+    // refreshes the CPU/voice HUD from the processor's performance monitor, and which zone the waveform shows
+    void timerCallback() override;
+    
     
     // Create a text button for loading samples
     juce::TextButton mLoadButton {"Please load an audio file..."};
+    juce::TextButton mLoadFolderButton {"Load a sample folder..."};
+    juce::TextButton mLoadImpulseResponseButton {"Load a reverb response..."};
+    
+    // while a set's files are loading (or resampling): how far it has got (the bar polls mLoadProgress itself) and a button to stop it there
+    double mLoadProgress = 0.0;
+    juce::ProgressBar mLoadProgressBar {mLoadProgress};
+    juce::TextButton mStopLoadingButton {"Stop"};
     
     // Create 4 rotary sliders for ADSR envelope customization
     // Create 4 labels for these sliders
@@ -58,6 +65,33 @@ private:
     juce::Slider mVolumeSlider;
     juce::Label mVolumeLabel;
     
+    // how much of the convolution reverb is heard
+    juce::Slider mReverbSlider;
+    juce::Label mReverbLabel;
+    
+    // a level per mic position, named after the positions in the loaded set's file names
+    std::array<juce::Slider, SampleZone::maxLayers> mMicSliders;
+    std::array<juce::Label, SampleZone::maxLayers> mMicLabels;
+    
+    // which articulation plays: the loaded set's names, refreshed in timerCallback(), drive the "articulation" parameter
+    juce::ComboBox mArticulationBox;
+    juce::Label mArticulationLabel;
+    juce::StringArray mArticulations;
+    
+    // keep the sliders and the processor's parameters in sync (declared after the sliders so they go first)
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    std::unique_ptr<SliderAttachment> mAttackAttachment, mDecayAttachment, mSustainAttachment, mReleaseAttachment, mVolumeAttachment, mReverbAttachment;
+    std::array<std::unique_ptr<SliderAttachment>, SampleZone::maxLayers> mMicAttachments;
+    
+    // CPU load, voices and overloads, updated a few times a second
+    juce::Label mPerformanceLabel;
+    
+    // the zone of the last note played (or of the set's root until then), with the voices' playheads
+    WaveformView mWaveformView;
+    
+    // set by handleNoteOn(), for the on-screen keyboard's notes and the host's, which the processor puts on the keyboard state
+    std::atomic<int> mLastNote {-1};
+    
     // Create MIDI keyboard visualization
     juce::MidiKeyboardState keyboardState;
     juce::MidiKeyboardComponent keyboardComponent;
@@ -65,7 +99,7 @@ private:
     
     // GUI constants
     static const int MARGIN = 4, MAX_WINDOW_HEIGHT = 800, MAX_WINDOW_WIDTH = 1200 + 2 * MARGIN,
-    MAX_KEYB_WIDTH = 1200, MAX_KEYB_HEIGHT = 82, BUTTON_WIDTH = 50, BUTTON_HEIGHT = 30;
+    MAX_KEYB_WIDTH = 1200, MAX_KEYB_HEIGHT = 82, BUTTON_WIDTH = 50, BUTTON_HEIGHT = 30, MIC_COLUMN_WIDTH = 160;
     //Colour backgroundColor { 44,54,60 }; // stock bckgrd colour
     
     SpheringerSTAudioProcessor& audioProcessor;
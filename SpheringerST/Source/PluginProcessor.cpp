@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeChecker.h"
 
 
 //==============================================================================
@@ -17,21 +18,73 @@ SpheringerSTAudioProcessor::SpheringerSTAudioProcessor()
                        .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 
 {
-    // allows plugin to use basic audio formats, e.g. .mp3, .wav, ...
-    mFormatManager.registerBasicFormats();
+    // the shared sample pool registers the basic audio formats, e.g. .mp3, .wav, ...
     // Initialize MIDI keyboard state
     keyboardState.reset();
+    keyboardState.addListener(this);
     
-    for (int i = 0; i < mNumVoices; i++)
-    {
-        mSampler.addVoice(new juce::SamplerVoice() );
-    }
+    // parameter values the audio thread reads every block
+    mAttack = apvts.getRawParameterValue("attack");
+    mDecay = apvts.getRawParameterValue("decay");
+    mSustain = apvts.getRawParameterValue("sustain");
+    mRelease = apvts.getRawParameterValue("release");
+    mVolume = apvts.getRawParameterValue("volume");
+    mInterpolation = apvts.getRawParameterValue("interpolation");
+    mVoiceStealing = apvts.getRawParameterValue("stealing");
+    mAlternates = apvts.getRawParameterValue("alternates");
+    mArticulation = apvts.getRawParameterValue("articulation");
+    mReverbLevel = apvts.getRawParameterValue("reverb");
+    
+    for (int i = 0; i < SampleZone::maxLayers; ++i)
+        mMicLevels[(size_t) i] = apvts.getRawParameterValue("mic" + juce::String(i + 1));
+    
+    mAzimuth = apvts.getRawParameterValue("azimuth");
+    mElevation = apvts.getRawParameterValue("elevation");
+    mSpread = apvts.getRawParameterValue("spread");
+    
+    // preallocate the voice pool
+    setPolyphony(defaultPolyphony);
+    
+    // finished sets come back from the loader thread
+    mLoader.onSoundSetLoaded = [this] (SoundSet::Ptr newSet) { soundSetLoaded (newSet); };
+    
+    // the loader's log goes through the monitor, so it ends up in traces next to the blocks. postMessage()
+    // takes a lock, it's never called from the audio thread
+    mLoader.onLogMessage = [this] (const juce::String& message) { mMonitor.postMessage (message); };
+    
+    // once old sounds are freed, sample data no instance uses any more can leave the pool
+    mSampler.getSoundSetExchange().onSetsFreed = [this] { mSamplePool->purgeUnused(); };
+    
+    mBackgroundThread.addTimeSliceClient(&mSampler.getSoundSetExchange());
+    mBackgroundThread.addTimeSliceClient(&mMonitor);
+    mBackgroundThread.addTimeSliceClient(&mReverb);
+    mBackgroundThread.startThread();
+    
+    const auto tracePath = juce::SystemStats::getEnvironmentVariable("SPHERINGER_TRACE", {});
+    
+    if (juce::File::isAbsolutePath(tracePath))
+        mMonitor.startTrace(juce::File(tracePath));
+    
+    mDiskThread.addTimeSliceClient(&mDiskStreamer);
+    mDiskThread.startThread();
+    
+    // mic levels crossing zero change what has to be loaded
+    updateMicPositions();
+    startTimerHz(timerHz);
 }
 
 // this is the destructor
 SpheringerSTAudioProcessor::~SpheringerSTAudioProcessor()
 {
-    mFormatReader = nullptr;
+    stopTimer();
+    keyboardState.removeListener(this);
+    mLoader.cancelAll();
+    mBackgroundThread.removeTimeSliceClient(&mSampler.getSoundSetExchange());
+    mBackgroundThread.removeTimeSliceClient(&mMonitor);
+    mBackgroundThread.removeTimeSliceClient(&mReverb);
+    mBackgroundThread.stopThread(1000);
+    mDiskThread.removeTimeSliceClient(&mDiskStreamer);
+    mDiskThread.stopThread(1000);
 }
 
 //==============================================================================
@@ -69,7 +122,8 @@ bool SpheringerSTAudioProcessor::isMidiEffect() const
 
 double SpheringerSTAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // after the last note off: the longest release there can be, then the room rings for as long as its response
+    return apvts.getParameterRange("release").end + mReverb.getLengthSeconds();
 }
 
 int SpheringerSTAudioProcessor::getNumPrograms()
@@ -105,11 +159,40 @@ void SpheringerSTAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
     // specify playback sample rate
     mSampler.setCurrentPlaybackSampleRate(sampleRate);
     
-    // Update ADSR from user input, via SamplerSound built-in function
-    updateADSR();
+    // samples play from copies at this rate, converted in the background (and kept next to them for next time).
+    // The set that's loaded now plays at its old rate until the reloaded one replaces it. Offline renders (bounces,
+    // the batch renderer) play the files at their own rates instead, rather than fill sample folders with copies
+    const auto hostRate = isNonRealtime() ? 0 : juce::roundToInt(sampleRate);
+    
+    if (hostRate != mLoader.getHostSampleRate())
+    {
+        mLoader.setHostSampleRate(hostRate);
+        
+        if (hostRate > 0)
+            reloadSource();
+    }
+    
+    // sizes the parallel renderer's per-voice buffers
+    mSampler.setMaximumBlockSize(samplesPerBlock);
+    
+    // Ambisonics and surround: the voices encode themselves at their positions, mono and stereo play as they are
+    mSpatialLayout = SpatialLayout(getBus(false, 0)->getCurrentLayout());
+    mSampler.setOutputLayout(mSpatialLayout);
+    
+    if (mSpatialLayout.isSpatial())
+    {
+        mSpatialLayout.computeGains(0.0f, 0.0f, 180.0f, mReverbReturn);
+        mReverbBuffer.setSize(4, samplesPerBlock);
+    }
+    
+    // impulse responses are resampled to the playback rate (a loaded one again if the rate changed)
+    mReverb.prepare(sampleRate);
+    
+    // start from the current parameter values rather than ramping to them
+    updateParameters();
     
     // Reset volume value
-    volume.reset(sampleRate, 0.02f); // ramp length in seconds: 0.02
+    mGainStage.prepare(sampleRate, samplesPerBlock, 0.02); // ramp length in seconds: 0.02
     
 }
 
@@ -122,17 +205,21 @@ void SpheringerSTAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SpheringerSTAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo() && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono())
-        return false;
-    else
-        return true;
-    
+    // mono, stereo, first- to third-order Ambisonics, quad, 5.1, 7.1 and 7.1.4
+    return SpatialLayout::isSupported(layouts.getMainOutputChannelSet());
 }
 #endif
 
 void SpheringerSTAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    
+    // no allocating or locking from here on (only checked in a SPHERINGER_REALTIME_CHECKS build)
+    const RealtimeChecker::ScopedRealtimeThread realtimeThread;
+    
+    BlockRecord record;
+    record.startTicks = juce::Time::getHighResolutionTicks();
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -143,32 +230,110 @@ void SpheringerSTAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         
     //std::cout << buffer.getNumChannels() << std::endl;
     
-    // Read MIDI message for keyboard visualization
-    keyboardState.processNextMidiBuffer (midiMessages, 0, buffer.getNumSamples(), true);
+    // the host's notes for the keyboard visualization, which the message thread shows
+    pushHostNotes(midiMessages);
+    
+    // pick up a newly loaded sound set, if there is one (lock-free)
+    mSampler.updateSoundSet();
+    
+    // ADSR, volume etc. from the host or the editor, read once per block
+    updateParameters();
+    
+    // notes from the on-screen keyboard, at the start of the block
+    mKeyboardNotes.popAll([this] (const KeyboardNote& note)
+    {
+        mSampler.handleMidiEvent(note.velocity > 0.0f ? juce::MidiMessage::noteOn(note.channel, note.note, note.velocity)
+                                                       : juce::MidiMessage::noteOff(note.channel, note.note));
+    });
     
     // let the buffer do the parsing automatically
     mSampler.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
     
-    // Add volume change from slider value input
+    // the room, before the output volume so the tail follows it too (does nothing without an impulse response)
+    if (mSpatialLayout.isSpatial() && buffer.getNumChannels() >= mSpatialLayout.getNumChannels())
+        processSpatialReverb(buffer);
+    else
+        mReverb.process(buffer, 0, buffer.getNumSamples());
     
-    for (int channel = 0; channel < totalNumOutputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            channelData[sample] *= juce::Decibels::decibelsToGain(volume.getNextValue());
-            // gain in volumes
-        }
-    }
+    // Add volume change from slider value input (skipped entirely at 0 dB)
+    record.gainStartTicks = juce::Time::getHighResolutionTicks();
+    mGainStage.process(buffer, 0, buffer.getNumSamples());
+    record.gainEndTicks = juce::Time::getHighResolutionTicks();
      
     // Clear MidiBuffer as the plugin does not have MIDI output
     midiMessages.clear();
+    
+    // what this block cost, picked up by the background thread (never blocks)
+    const auto stats = mSampler.takeBlockStats();
+    record.sampleRate = getSampleRate();
+    record.numSamples = buffer.getNumSamples();
+    record.activeVoices = stats.activeVoices;
+    record.notesStolen = stats.notesStolen;
+    record.notesDropped = stats.notesDropped;
+    record.endTicks = juce::Time::getHighResolutionTicks();
+    mMonitor.pushBlock(record);
 
     
     
 }
 
+void SpheringerSTAudioProcessor::pushHostNotes(const juce::MidiBuffer& midiMessages)
+{
+    for (const auto metadata : midiMessages)
+    {
+        // longer ones are sysex, which aren't notes (and would allocate as a MidiMessage)
+        if (metadata.numBytes > 3)
+            continue;
+        
+        const auto message = metadata.getMessage();
+        
+        if (message.isNoteOn())
+            mHostNotes.push({ message.getChannel(), message.getNoteNumber(), message.getFloatVelocity() });
+        else if (message.isNoteOff())
+            mHostNotes.push({ message.getChannel(), message.getNoteNumber(), 0.0f });
+        else if (message.isAllNotesOff() || message.isAllSoundOff())
+            mHostNotes.push({ message.getChannel(), -1, 0.0f });
+    }
+}
+
+void SpheringerSTAudioProcessor::handleNoteOn(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+{
+    // a note on at velocity 0 would go through as a note off
+    if (! mShowingHostNotes)
+        mKeyboardNotes.push({ midiChannel, midiNoteNumber, juce::jmax(velocity, 1.0f / 127.0f) });
+}
+
+void SpheringerSTAudioProcessor::handleNoteOff(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float)
+{
+    if (! mShowingHostNotes)
+        mKeyboardNotes.push({ midiChannel, midiNoteNumber, 0.0f });
+}
+
+void SpheringerSTAudioProcessor::processSpatialReverb(juce::AudioBuffer<float>& buffer)
+{
+    // no response loaded: don't bother with the downmix
+    if (! mReverb.isActive() || mReverbBuffer.getNumSamples() == 0)
+        return;
+    
+    // a host block longer than it said it would be goes through in pieces
+    for (int done = 0; done < buffer.getNumSamples();)
+    {
+        const auto chunk = juce::jmin(buffer.getNumSamples() - done, mReverbBuffer.getNumSamples());
+        
+        // views of the preallocated buffer, nothing is allocated here
+        juce::AudioBuffer<float> send(mReverbBuffer.getArrayOfWritePointers(), 2, chunk);
+        juce::AudioBuffer<float> wet(mReverbBuffer.getArrayOfWritePointers() + 2, 2, chunk);
+        
+        mSpatialLayout.downmixToStereo(buffer, done, send, 0, chunk);
+        wet.clear();
+        
+        mReverb.process(send, wet, 0, chunk);
+        mSpatialLayout.encode(buffer, done, wet.getReadPointer(0), wet.getReadPointer(1), chunk, mReverbReturn, mReverbReturn, 1.0f);
+        
+        done += chunk;
+    }
+}
+
 //==============================================================================
 bool SpheringerSTAudioProcessor::hasEditor() const
 {
@@ -183,81 +348,446 @@ juce::AudioProcessorEditor* SpheringerSTAudioProcessor::createEditor()
 //==============================================================================
 void SpheringerSTAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // binary rather than XML: small, and quick to write and parse for sessions with lots of instances
+    SessionState state;
+    
+    for (auto* parameter : getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            state.parameterIDs.add(ranged->paramID);
+            state.parameterValues.add(ranged->convertFrom0to1(ranged->getValue()));
+        }
+    }
+    
+    state.polyphony = mSampler.getPolyphony();
+    state.parallelRendering = mSampler.isRenderingInParallel();
+    state.noteUsage = mSampler.getNoteUsage();
+    state.impulseResponse = mReverb.getImpulseResponseFile();
+    
+    {
+        const juce::ScopedLock sl (mLoadedSetLock);
+        state.source = mSource;
+        
+        // by name, the index of an articulation changes when files are added. A restored session whose set
+        // hasn't loaded yet keeps the name it came with
+        state.articulation = mRestoredArticulation;
+        
+        if (state.articulation.isEmpty() && mLoadedSet != nullptr)
+            if (auto* keymap = mLoadedSet->getKeymap(mSampler.getArticulation()))
+                state.articulation = keymap->getArticulation();
+    }
+    
+    juce::MemoryOutputStream stream (destData, false);
+    state.writeTo(stream);
 }
 
 void SpheringerSTAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+    SessionState state;
+    
+    if (! state.readFrom(stream))
+        return;
+    
+    // parameters apply straight away, through the tree rather than one by one as if they were being automated...
+    auto parameters = apvts.copyState();
+    
+    for (int i = 0; i < state.parameterIDs.size(); ++i)
+    {
+        auto parameter = parameters.getChildWithProperty("id", state.parameterIDs[i]);
+        
+        if (parameter.isValid())
+            parameter.setProperty("value", state.parameterValues[i], nullptr);
+    }
+    
+    apvts.replaceState(parameters);
+    
+    // the articulation parameter came back with the rest, but its index may point elsewhere in the set as it
+    // loads now: soundSetLoaded() looks the name up and timerCallback() moves the parameter there
+    {
+        const juce::ScopedLock sl (mLoadedSetLock);
+        mRestoredArticulation = state.articulation;
+    }
+    
+    mSampler.setNoteUsage(state.noteUsage);
+    setPolyphony(state.polyphony);
+    setParallelRendering(state.parallelRendering);
+    
+    // the reverb's response is read here, it's small next to the samples
+    if (state.impulseResponse != mReverb.getImpulseResponseFile())
+    {
+        if (state.impulseResponse == juce::File())
+            mReverb.clearImpulseResponse();
+        else
+            loadImpulseResponse(state.impulseResponse);
+    }
+    
+    // ...the samples load in the background, the most played zones first
+    if (! state.source.isEmpty())
+    {
+        updateMicPositions();
+        mLoader.load(state.source, state.noteUsage);
+        sourceRequested(state.source);
+    }
 }
 
 // define the loadFile() function
 void SpheringerSTAudioProcessor::loadFile()
 {
-    mSampler.clearSounds();
     // file chooser class under API
     juce::FileChooser chooser {"Please load a stereo WAV file..."};
     
     // sub-function in FileChooser(), returns bool.; also function for multiple files
     if (chooser.browseForFileToOpen())
     {
-        auto file = chooser.getResult(); // get and store file?
-        mFormatReader = mFormatManager.createReaderFor(file); // create a pointer for file?
-        
-        // read MIDI base number from file name
-        baseNum = file.getFileNameWithoutExtension().getTrailingIntValue();
-        
-        // output log
-        std::cout << "File loaded! File name: " << file.getFileName() << ", Base MIDI number: " << baseNum << std::endl;
+        // decoding happens on the loader thread, the old sound keeps playing until the new one is ready
+        updateMicPositions();
+        sourceRequested(mLoader.loadFile(chooser.getResult()));
     }
+}
+
+void SpheringerSTAudioProcessor::loadFolder()
+{
+    juce::FileChooser chooser {"Please choose a folder of samples..."};
     
-    // MIDI note numbers use BigInteger? Specify MIDI number range
-    juce::BigInteger range;
-    range.setRange(0, 128, true);
+    if (chooser.browseForDirectory())
+    {
+        // file names like "Omni AB_S_long_LAHHH_forte_A4_69.wav" give mic, articulation, dynamic and root note
+        updateMicPositions();
+        sourceRequested(mLoader.loadFolder(chooser.getResult()));
+    }
+}
+
+void SpheringerSTAudioProcessor::loadImpulseResponse()
+{
+    juce::FileChooser chooser {"Please choose an impulse response...", {}, mSamplePool->getFormatManager().getWildcardForAllFormats()};
     
-    mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, range, baseNum, 0.1, 0.1, 10.0));
-    // to reference a pointer, add a star operator
-    // midi note for normnal pitch is C3 = 60, Yamaha notation
-    // attack and release times: both set to 0.1 seconds for now
-    // max sample length set to 10 seconds
+    if (chooser.browseForFileToOpen())
+        loadImpulseResponse(chooser.getResult());
 }
 
-/*
-void SpheringerSTAudioProcessor::loadFile(const juce::String &path)
+bool SpheringerSTAudioProcessor::loadImpulseResponse(const juce::File& file)
 {
-    // make sure old sample is cleared when new sample is loaded
-    mSampler.clearSounds();
+    // the old response keeps playing until the audio thread swaps the new one in
+    const auto loaded = mReverb.loadImpulseResponse(file, mSamplePool->getFormatManager());
     
-    auto file = juce::File(path);
-    mFormatReader = mFormatManager.createReaderFor(file); // create reader
+    // from the message thread, while the loader may be logging too: postMessage() serialises the two
+    if (! loaded)
+        mMonitor.postMessage("Couldn't read impulse response " + file.getFullPathName());
     
-    // set range for MIDI keys
-    juce::BigInteger range;
-    range.setRange(0, 128, true);
+    return loaded;
+}
+
+void SpheringerSTAudioProcessor::loadSamples(const juce::File& fileOrFolder)
+{
+    updateMicPositions();
     
-    mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, range, 60, 0.1, 0.1, 10.0));
+    if (fileOrFolder.isDirectory())
+        sourceRequested(mLoader.loadFolder(fileOrFolder));
+    else if (fileOrFolder.existsAsFile())
+        sourceRequested(mLoader.loadFile(fileOrFolder));
 }
-*/
 
-// updateADSR() is essentially a user-defined function that inherits the juce::ADSR class and does 2 functions:
-// 1. check if the input the sound sample is a SamplerSound class object;
-// 2. set ADSR parameters to the sound with the JUCE native ADSR::setEnvelopeParameters() method
-// that's why it seems we have not called the actual function but juce::ADSR class is very involved thruout the process.
+void SpheringerSTAudioProcessor::loadSamples(const juce::StringArray& paths)
+{
+    juce::Array<juce::File> files;
+    
+    for (auto& path : paths)
+        files.add(juce::File(path));
+    
+    updateMicPositions();
+    const auto source = mLoader.loadFiles(files);
+    
+    if (! source.isEmpty())
+        sourceRequested(source);
+}
+
+bool SpheringerSTAudioProcessor::canLoadSamples(const juce::StringArray& paths) const
+{
+    for (auto& path : paths)
+        if (mLoader.canLoad(juce::File(path)))
+            return true;
+    
+    return false;
+}
+
+void SpheringerSTAudioProcessor::setSampleStorage(SampleStorage storage)
+{
+    if (storage == mLoader.getStorage())
+        return;
+    
+    mLoader.setStorage(storage);
+    reloadSource();
+}
+
+void SpheringerSTAudioProcessor::reloadSource()
+{
+    // the set that's playing keeps playing until the reloaded one replaces it
+    SoundSetSource source;
+    
+    {
+        const juce::ScopedLock sl (mLoadedSetLock);
+        source = mSource;
+    }
+    
+    if (! source.isEmpty())
+        mLoader.load(source, mSampler.getNoteUsage());
+}
+
+bool SpheringerSTAudioProcessor::updateMicPositions()
+{
+    juce::uint32 enabled = 0;
+    
+    for (int i = 0; i < SampleZone::maxLayers; ++i)
+        if (mMicLevels[(size_t) i]->load(std::memory_order_relaxed) > 0.0f)
+            enabled |= 1u << i;
+    
+    if (enabled == mLoader.getMicPositions())
+        return false;
+    
+    mLoader.setMicPositions(enabled);
+    return true;
+}
+
+void SpheringerSTAudioProcessor::timerCallback()
+{
+    // the host's notes light up the keyboard, without going back to the audio thread through handleNoteOn()
+    mShowingHostNotes = true;
+    
+    mHostNotes.popAll([this] (const KeyboardNote& note)
+    {
+        if (note.note < 0)
+            keyboardState.allNotesOff(note.channel);
+        else if (note.velocity > 0.0f)
+            keyboardState.noteOn(note.channel, note.note, note.velocity);
+        else
+            keyboardState.noteOff(note.channel, note.note, 0.0f);
+    });
+    
+    mShowingHostNotes = false;
+    
+    if (++mTimerTicks < ticksPerUpdate)
+        return;
+    
+    mTimerTicks = 0;
+    
+    // the levels themselves apply straight away, only what has to be in memory changes here
+    if (updateMicPositions())
+        reloadSource();
+    
+    // a restored session's articulation, found in the set it loaded. Through the tree like the rest of the
+    // restored parameters, the host mustn't see it as an edit
+    const auto articulation = mRestoredArticulationIndex.exchange(-1);
+    
+    if (articulation >= 0 && articulation != juce::roundToInt(mArticulation->load()) - 1)
+    {
+        auto parameters = apvts.copyState();
+        auto parameter = parameters.getChildWithProperty("id", "articulation");
+        
+        if (parameter.isValid())
+        {
+            parameter.setProperty("value", articulation + 1, nullptr);
+            apvts.replaceState(parameters);
+        }
+    }
+}
+
+juce::StringArray SpheringerSTAudioProcessor::getArticulations() const
+{
+    const juce::ScopedLock sl (mLoadedSetLock);
+    return mLoadedSet != nullptr ? mLoadedSet->getArticulations() : juce::StringArray();
+}
+
+juce::StringArray SpheringerSTAudioProcessor::getMicPositions() const
+{
+    const juce::ScopedLock sl (mLoadedSetLock);
+    return mMicPositions;
+}
+
+SampleLoader::MemoryUse SpheringerSTAudioProcessor::getSampleMemoryUse()
+{
+    const juce::ScopedLock sl (mLoadedSetLock);
+    
+    if (mLoadedSet == nullptr)
+        return {};
+    
+    return SampleLoader::getMemoryUse(*mLoadedSet);
+}
+
+void SpheringerSTAudioProcessor::sourceRequested(const SoundSetSource& source)
+{
+    // saved with the session even if it hasn't finished loading yet
+    const auto micPositions = source.getMicPositions();
+    
+    const juce::ScopedLock sl (mLoadedSetLock);
+    mSource = source;
+    mMicPositions = micPositions;
+    mAdoptNextSource = false;
+}
+
+void SpheringerSTAudioProcessor::stopLoading()
+{
+    // nothing queued after the set that's loading is going to load, so whatever it ends up with is the session's
+    {
+        const juce::ScopedLock sl (mLoadedSetLock);
+        mAdoptNextSource = true;
+    }
+    
+    mLoader.stopLoading();
+}
 
-void SpheringerSTAudioProcessor::updateADSR()
+void SpheringerSTAudioProcessor::soundSetLoaded(SoundSet::Ptr newSet)
 {
-    for (int i = 0; i < mSampler.getNumSounds(); ++i) // int or auto? need to declare...
+    const juce::ScopedLock sl (mLoadedSetLock);
+    
+    baseNum = newSet->rootNote;
+    mLoadedSet = newSet;
+    
+    // the finished set knows the files' content hashes, keep them for the next save. A set whose loading
+    // was stopped only lists the files that made it, and is saved as just those
+    if (! newSet->isPartial && (mAdoptNextSource || newSet->source.files == mSource.files))
     {
-        if (auto sound = dynamic_cast<juce::SamplerSound*>(mSampler.getSound(i).get()))
+        mSource = newSet->source;
+        mAdoptNextSource = false;
+        
+        // the session's articulation, if this set still has it
+        if (mRestoredArticulation.isNotEmpty())
         {
-            sound->setEnvelopeParameters(mADSRParams);
+            mRestoredArticulationIndex = newSet->getArticulations().indexOf(mRestoredArticulation);
+            mRestoredArticulation.clear();
         }
     }
+    
+    // every voice needs a stream per mic layer before any note can play the set
+    for (auto* sound : newSet->sounds)
+        if (auto* zone = dynamic_cast<SampleZone*>(sound))
+            mNumLayers = juce::jmax(mNumLayers, zone->getNumLayers());
+    
+    for (auto* voice : mVoices)
+        voice->prepareLayers(mNumLayers);
+    
+    // hand the set over to the audio thread, the old one is freed by the background thread
+    mSampler.getSoundSetExchange().publish(newSet);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout SpheringerSTAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    
+    // same ranges and defaults the sliders used to set themselves
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"attack", 1}, "Attack", juce::NormalisableRange<float>(0.01f, 2.0f, 0.01f), 0.1f, "s"));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"decay", 1}, "Decay", juce::NormalisableRange<float>(0.01f, 2.0f, 0.01f), 0.1f, "s"));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"sustain", 1}, "Sustain", juce::NormalisableRange<float>(0.01f, 10.0f, 0.01f), 1.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"release", 1}, "Release", juce::NormalisableRange<float>(0.01f, 5.0f, 0.01f), 0.1f, "s"));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"volume", 1}, "Volume", juce::NormalisableRange<float>(-20.0f, 20.0f, 0.1f), 0.0f, "dB"));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"reverb", 1}, "Reverb", juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 20.0f, "%"));
+    
+    // one level per mic position of the set, only the first is on to begin with
+    for (int i = 1; i <= SampleZone::maxLayers; ++i)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"mic" + juce::String(i), 1}, "Mic " + juce::String(i) + " level", juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), i == 1 ? 100.0f : 0.0f, "%"));
+    
+    // where notes go on Ambisonic and surround buses (mono and stereo ignore these): the centre, and how far
+    // apart the lowest and highest notes are. Pan (CC 10) moves a MIDI channel's notes on from there
+    const juce::String degrees(juce::CharPointer_UTF8("\xc2\xb0"));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"azimuth", 1}, "Azimuth", juce::NormalisableRange<float>(-180.0f, 180.0f, 0.1f), 0.0f, degrees));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"elevation", 1}, "Elevation", juce::NormalisableRange<float>(-90.0f, 90.0f, 0.1f), 0.0f, degrees));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"spread", 1}, "Spread", juce::NormalisableRange<float>(0.0f, 360.0f, 0.1f), 60.0f, degrees));
+    
+    // same order as the InterpolationQuality, SpheringerSynth::StealPolicy and AlternateMode enums
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID {"interpolation", 1}, "Interpolation", juce::StringArray {"Linear", "Hermite", "Sinc"}, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID {"stealing", 1}, "Voice stealing", juce::StringArray {"Oldest", "Quietest", "Same note"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID {"alternates", 1}, "Alternates", juce::StringArray {"Round robin", "Random", "MIDI channel"}, 0));
+    
+    // which of the set's articulations plays, by their names' order (the editor lists the names)
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID {"articulation", 1}, "Articulation", 1, maxArticulations, 1));
+    
+    return layout;
 }
 
+void SpheringerSTAudioProcessor::updateParameters()
+{
+    // plain atomic loads, the synth only bumps the voices' settings if something actually changed
+    juce::ADSR::Parameters envelope;
+    envelope.attack = mAttack->load(std::memory_order_relaxed);
+    envelope.decay = mDecay->load(std::memory_order_relaxed);
+    envelope.sustain = mSustain->load(std::memory_order_relaxed);
+    envelope.release = mRelease->load(std::memory_order_relaxed);
+    
+    const auto quality = (InterpolationQuality) juce::roundToInt(mInterpolation->load(std::memory_order_relaxed));
+    mSampler.updateVoiceSettings(envelope, quality);
+    mSampler.setNonRealtime(isNonRealtime());
+    
+    mSampler.setStealPolicy((SpheringerSynth::StealPolicy) juce::roundToInt(mVoiceStealing->load(std::memory_order_relaxed)));
+    mSampler.setAlternateMode((AlternateMode) juce::roundToInt(mAlternates->load(std::memory_order_relaxed)));
+    mSampler.setArticulation(juce::roundToInt(mArticulation->load(std::memory_order_relaxed)) - 1);
+    
+    // percent, a layer at zero isn't read by notes that start now
+    std::array<float, SampleZone::maxLayers> micLevels;
+    
+    for (size_t i = 0; i < micLevels.size(); ++i)
+        micLevels[i] = mMicLevels[i]->load(std::memory_order_relaxed) * 0.01f;
+    
+    mSampler.setMicLevels(micLevels);
+    mSampler.setSpatialPosition(mAzimuth->load(std::memory_order_relaxed), mElevation->load(std::memory_order_relaxed),
+                                mSpread->load(std::memory_order_relaxed));
+    
+    // the gain stage does its own dB -> gain conversion, only when this changes
+    mGainStage.setGainDecibels(mVolume->load(std::memory_order_relaxed));
+    
+    // percent, ramped by the reverb across the block
+    mReverb.setWetLevel(mReverbLevel->load(std::memory_order_relaxed) * 0.01f);
+    mReverb.setNonRealtime(isNonRealtime());
+}
+
+void SpheringerSTAudioProcessor::setPolyphony(int numVoices)
+{
+    // new voices are created here on the message thread, never while playing
+    mSampler.setPolyphony(numVoices, [this]
+    {
+        auto* voice = new StreamingVoice(mDiskStreamer, mSampler.getVoiceSettings());
+        
+        // the loader thread prepares the voices for sets with more mic layers as it publishes them
+        const juce::ScopedLock sl (mLoadedSetLock);
+        voice->prepareLayers(mNumLayers);
+        mVoices.add(voice);
+        return voice;
+    });
+}
+
+SampleZone::Ptr SpheringerSTAudioProcessor::getZoneForNote(int midiNoteNumber)
+{
+    const juce::ScopedLock sl (mLoadedSetLock);
+    
+    if (mLoadedSet == nullptr || ! juce::isPositiveAndBelow(midiNoteNumber, 128))
+        return nullptr;
+    
+    auto* keymap = mLoadedSet->getKeymap(mSampler.getArticulation());
+    
+    if (keymap == nullptr)
+        return nullptr;
+    
+    // the first take at a middling velocity
+    const auto soundIndex = keymap->getSoundIndex(midiNoteNumber, 100, AlternateMode::roundRobin, 0, 1);
+    return dynamic_cast<SampleZone*>(mLoadedSet->sounds[soundIndex].get());
+}
+
+void SpheringerSTAudioProcessor::getPlayheads(juce::uint32 sampleId, juce::Array<juce::int64>& frames) const
+{
+    frames.clearQuick();
+    
+    // our own list of the voices: asking the synth for them would take the lock the audio thread renders under
+    for (auto* voice : mVoices)
+    {
+        const auto playhead = voice->getPlayhead();
+        
+        if (playhead.sampleId == sampleId && sampleId != 0)
+            frames.add((juce::int64) playhead.frame);
+    }
+}
+
+
 
 //==============================================================================
 // This creates new instances of the plugin..
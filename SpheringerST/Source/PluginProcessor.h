@@ -9,11 +9,21 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SpheringerSynth.h"
+#include "SampleLoader.h"
+#include "StreamingVoice.h"
+#include "SamplePool.h"
+#include "GainStage.h"
+#include "SessionState.h"
+#include "PerformanceMonitor.h"
+#include "ConvolutionReverb.h"
 
 //==============================================================================
 /**
 */
-class SpheringerSTAudioProcessor  : public juce::AudioProcessor
+class SpheringerSTAudioProcessor  : public juce::AudioProcessor,
+                                    private juce::MidiKeyboardState::Listener,
+                                    private juce::Timer
 {
 public:
     //==============================================================================
@@ -54,48 +64,207 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     // create a load file function for the button
+    // the file is decoded in the background, this returns as soon as a file was chosen
     void loadFile();
-    int baseNum = 60; // default to central C in case the file does not have MIDI num tag
-    // another load file function for drag n drop
-    // input: take file path (string)
-    //void loadFile(const juce::String& path);
+    std::atomic<int> baseNum {60}; // default to central C in case the file does not have MIDI num tag
+    
+    // load every sample in a folder, split across the keyboard and velocity by their file names
+    void loadFolder();
+    
+    // the room the samples play in: an impulse response (.wav etc.) the convolution reverb after the sampler uses,
+    // read and partitioned on the message thread. The "reverb" parameter sets how much of it is heard
+    void loadImpulseResponse();
+    bool loadImpulseResponse(const juce::File& file);
+    
+    // no chooser: a single sample or a folder of them, e.g. for offline rendering
+    void loadSamples(const juce::File& fileOrFolder);
+    
+    // files and folders dropped on the editor, loaded as one set (see SampleLoader::loadFiles()).
+    // Decoded on the loader's threads, the set plays in batches as the files come in
+    void loadSamples(const juce::StringArray& paths);
+    bool canLoadSamples(const juce::StringArray& paths) const;
+    
+    // how far the set that's loading has got, and stopping it there (see SampleLoader::stopLoading())
+    SampleLoader::Progress getLoadProgress() const { return mLoader.getProgress(); }
+    void stopLoading();
+    
+    // blocks until the requested samples (and their mip levels) are loaded, false on timeout.
+    // For offline use only, a plugin's message thread must never wait on this
+    bool waitUntilLoaded(int timeoutMs) { return mLoader.waitUntilIdle(timeoutMs); }
     
     // create a method/getter to detect if sound is loaded and the number of sounds
     int getNumSamplerSounds()
     {
-        return mSampler.getNumSounds();
+        return mSampler.getSoundSetExchange().getNumPublishedSounds();
     }
     
-    void updateADSR();
+    // underrun counters etc. from the disk streaming, for sizing the preload and ring buffers
+    StreamingStats& getStreamingStats() { return mDiskStreamer.getStats(); }
     
-    // mADSRParams is private but can read with swgetParameters()
-    juce::ADSR::Parameters& getADSRParams()
-    {
-        return mADSRParams; // reference to private object via pointer
-    }
+    // keep the in-memory parts of samples (heads, mip levels) as 16/24-bit integers to save memory,
+    // decoded by the voices as they play. Message thread: reloads the current samples if it changes
+    void setSampleStorage(SampleStorage storage);
+    SampleStorage getSampleStorage() const { return mLoader.getStorage(); }
+    
+    // message thread: the loaded set's articulations, in the order of the "articulation" parameter's values
+    juce::StringArray getArticulations() const;
+    
+    // the mic positions of what was last asked to load, in the order of the "mic1".."mic4" level parameters.
+    // Positions turned down to zero aren't loaded; turning one up (or down to zero) reloads the set
+    juce::StringArray getMicPositions() const;
     
-    // Volume value
-    juce::SmoothedValue<float> volume {0.0f};
+    // what the loaded samples take in memory, and what the same would take as floats
+    SampleLoader::MemoryUse getSampleMemoryUse();
     
-    // declare keyboard state as public to associate w processor
+    // message thread: the zone the loaded set plays for a note (its first take, at velocity 100), for the waveform view
+    SampleZone::Ptr getZoneForNote(int midiNoteNumber);
+    
+    // message thread: the source frame of every voice playing the sample with that SampleData::getId(),
+    // read from the voices' atomics without locking
+    void getPlayheads(juce::uint32 sampleId, juce::Array<juce::int64>& frames) const;
+    
+    // how many notes can play at once (message thread), up to SpheringerSynth::maxPolyphony
+    void setPolyphony(int numVoices);
+    int getPolyphony() const { return mSampler.getPolyphony(); }
+    
+    // spread dense blocks across worker threads (off by default, small blocks always stay on the audio thread)
+    void setParallelRendering(bool shouldRenderInParallel) { mSampler.setParallelRendering(shouldRenderInParallel); }
+    
+    // per-block timing, voice counts and the loader's log, for the editor's HUD and for traces
+    // (set the SPHERINGER_TRACE environment variable to a file path to trace from the start)
+    PerformanceMonitor& getPerformanceMonitor() { return mMonitor; }
+    
+    // every parameter the host can automate: ADSR, volume, reverb, mic levels, position on a spatial bus, interpolation,
+    // voice stealing, alternate takes and articulation.
+    // The editor attaches its controls here, the audio thread reads the raw values once per block.
+    juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    
+    // declare keyboard state as public to associate w processor.
+    // Its notes reach the audio thread through a ring rather than processNextMidiBuffer(), which locks, and the host's
+    // come back the same way to be shown; play it from the message thread only
     juce::MidiKeyboardState keyboardState;
 
 private:
-    juce::Synthesiser mSampler; // if not using namespace, remember to add juce::
-    const int mNumVoices {16}; // not that much is needed but put in the capacity all the same or it will clip
+    // called on the loader thread once a new set of sounds is ready
+    void soundSetLoaded (SoundSet::Ptr newSet);
+    
+    // remembers what was last asked to load, for getStateInformation()
+    void sourceRequested (const SoundSetSource& source);
+    
+    // audio thread, start of every block: hands changed parameter values to the synth and gain stage
+    void updateParameters();
+    
+    // tells the loader which mic positions have a level above zero, true if that changed (message thread)
+    bool updateMicPositions();
+    
+    // loads what was last asked for again, e.g. with other mic positions; the current set plays until it's replaced
+    void reloadSource();
+    
+    // message thread: shows the host's notes on the keyboard state, and a few times a second reloads when a mic
+    // level has gone to or come up from zero, and moves the articulation parameter to a restored session's
+    // articulation once its set is in
+    void timerCallback() override;
+    
+    // message thread: notes played on the keyboard state, passed on to the audio thread
+    void handleNoteOn(juce::MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
+    void handleNoteOff(juce::MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
+    
+    // audio thread: the notes in the host's MIDI, for timerCallback() to show
+    void pushHostNotes(const juce::MidiBuffer& midiMessages);
+    
+    // audio thread, on a spatial bus: the reverb is stereo, so it hears a stereo downmix of the bus
+    // and comes back as a wide pair to the sides
+    void processSpatialReverb(juce::AudioBuffer<float>& buffer);
+    
+    // the parameters' atomic values, looked up once so the audio thread never searches by ID
+    std::atomic<float>* mAttack = nullptr;
+    std::atomic<float>* mDecay = nullptr;
+    std::atomic<float>* mSustain = nullptr;
+    std::atomic<float>* mRelease = nullptr;
+    std::atomic<float>* mVolume = nullptr;
+    std::atomic<float>* mInterpolation = nullptr;
+    std::atomic<float>* mVoiceStealing = nullptr;
+    std::atomic<float>* mAlternates = nullptr;
+    std::atomic<float>* mArticulation = nullptr;
+    std::atomic<float>* mReverbLevel = nullptr;
+    std::array<std::atomic<float>*, SampleZone::maxLayers> mMicLevels {};
+    std::atomic<float>* mAzimuth = nullptr;
+    std::atomic<float>* mElevation = nullptr;
+    std::atomic<float>* mSpread = nullptr;
+    
+    // the output bus as of prepareToPlay(); for a spatial one, where the reverb comes back in and the
+    // buffer it runs in (channels 0-1 the send, 2-3 what it adds)
+    SpatialLayout mSpatialLayout;
+    SpatialLayout::Gains mReverbReturn;
+    juce::AudioBuffer<float> mReverbBuffer;
+    
+    // convolution with the loaded impulse response, between the sampler and the output volume
+    ConvolutionReverb mReverb;
+    
+    // output volume, smoothed
+    GainStage mGainStage;
+    
+    // the audio thread reports every block here, the background thread drains it
+    PerformanceMonitor mMonitor;
+    
+    // sample data (and the audio format manager) shared by every instance in the process
+    juce::SharedResourcePointer<SamplePool> mSamplePool;
+    
+    // I/O thread that keeps the voices' ring buffers filled from disk
+    // (declared before the sampler, the voices unregister from it when they're deleted)
+    DiskStreamer mDiskStreamer;
+    juce::TimeSliceThread mDiskThread {"Spheringer disk streaming"};
+    
+    SpheringerSynth mSampler; // juce::Synthesiser that plays from the sets published by the loader
+    static constexpr int defaultPolyphony {32}; // voices allocated up front, setPolyphony() can add more
+    static constexpr int maxArticulations {16}; // the "articulation" parameter's range, later ones can't be chosen
+    
+    // a note on its way between the keyboard state and the audio thread, either way
+    struct KeyboardNote
+    {
+        int channel = 0;
+        int note = 0;           // -1 for all notes off on the channel (from the host only)
+        float velocity = 0.0f;  // 0 for a note off
+    };
+    
+    // on-screen notes to the audio thread, and the host's back to the message thread. Full rings drop notes
+    SpscRing<KeyboardNote, 256> mKeyboardNotes, mHostNotes;
+    
+    // message thread: set while the host's notes are put on the keyboard state, which mustn't play them again
+    bool mShowingHostNotes = false;
+    
+    // the timer runs fast enough for the keyboard, the rest only needs every few ticks
+    static constexpr int timerHz {30};
+    static constexpr int ticksPerUpdate {15};
+    int mTimerTicks = 0;
+    
+    // every voice the sampler owns, for reading their playheads (message thread only, the pool never shrinks)
+    juce::Array<StreamingVoice*> mVoices;
+    
+    // background thread that frees sound sets once the audio thread has swapped them out
+    juce::TimeSliceThread mBackgroundThread {"Spheringer background"};
     
-    // Create an ADSR class project for storing parameters
-    juce::ADSR::Parameters mADSRParams;
+    // decodes files on its own job threads, the readers it creates are owned by the jobs
+    SampleLoader mLoader {*mSamplePool};
     
-    // audio format manager classs
-    juce::AudioFormatManager mFormatManager;
+    // the most recently loaded set (never touched by the audio thread)
+    // and what the last load asked for, which is what gets saved
+    SoundSet::Ptr mLoadedSet;
+    SoundSetSource mSource;
+    juce::StringArray mMicPositions;
+    juce::CriticalSection mLoadedSetLock;
     
-    // audio format reader, as a pointer
-    // start as null pointer: when choosing another file, we don't want to delete the original pointer, just point to somewhere else
-    juce::AudioFormatReader* mFormatReader {nullptr};
+    // set by stopLoading(): the next full set is saved as the source, whatever it was loaded from (under mLoadedSetLock)
+    bool mAdoptNextSource = false;
     
-   
+    // the most mic layers a published set has had, every voice is prepared for that many (under mLoadedSetLock)
+    int mNumLayers = 1;
     
+    // a restored session's articulation until its set has loaded (under mLoadedSetLock), then where that set has it,
+    // for timerCallback() to set the parameter to
+    juce::String mRestoredArticulation;
+    std::atomic<int> mRestoredArticulationIndex {-1};
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpheringerSTAudioProcessor)
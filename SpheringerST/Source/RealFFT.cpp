@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    RealFFT.cpp
+    Created: 18 Oct 2026 9:14:52am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "RealFFT.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define SPHERINGER_USE_NEON 1
+#endif
+
+RealFFT::RealFFT (int size)
+    : mSize (size),
+      mHalf (size / 2)
+{
+    jassert (size >= 4 && juce::isPowerOfTwo (size));
+
+    mBitReversed.resize ((size_t) mHalf);
+    int numBits = 0;
+
+    while ((1 << numBits) < mHalf)
+        ++numBits;
+
+    for (int i = 0; i < mHalf; ++i)
+    {
+        int reversed = 0;
+
+        for (int bit = 0; bit < numBits; ++bit)
+            reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+
+        mBitReversed[(size_t) i] = reversed;
+    }
+
+    // in double, so the tables are as exact as floats can be
+    for (int k = 0; k < juce::jmax (1, mHalf / 2); ++k)
+    {
+        const auto angle = juce::MathConstants<double>::twoPi * k / mHalf;
+        mCos.push_back ((float) std::cos (angle));
+        mSin.push_back ((float) std::sin (angle));
+    }
+
+    for (int k = 0; k < mHalf; ++k)
+    {
+        const auto angle = juce::MathConstants<double>::twoPi * k / mSize;
+        mSplitCos.push_back ((float) std::cos (angle));
+        mSplitSin.push_back ((float) std::sin (angle));
+    }
+
+    mReal.resize ((size_t) mHalf);
+    mImag.resize ((size_t) mHalf);
+}
+
+void RealFFT::transform (bool isInverse) noexcept
+{
+    auto* re = mReal.data();
+    auto* im = mImag.data();
+
+    for (int i = 0; i < mHalf; ++i)
+    {
+        const auto j = mBitReversed[(size_t) i];
+
+        if (j > i)
+        {
+            std::swap (re[i], re[j]);
+            std::swap (im[i], im[j]);
+        }
+    }
+
+    const auto sign = isInverse ? 1.0f : -1.0f;
+
+    for (int length = 2; length <= mHalf; length <<= 1)
+    {
+        const auto half = length / 2;
+        const auto step = mHalf / length;
+
+        for (int j = 0; j < half; ++j)
+        {
+            const auto wr = mCos[(size_t) (j * step)];
+            const auto wi = sign * mSin[(size_t) (j * step)];
+
+            for (int a = j; a < mHalf; a += length)
+            {
+                const auto b = a + half;
+                const auto tr = re[b] * wr - im[b] * wi;
+                const auto ti = re[b] * wi + im[b] * wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void RealFFT::forward (const float* input, float* real, float* imag) noexcept
+{
+    // even samples as the real part, odd ones as the imaginary part
+    for (int i = 0; i < mHalf; ++i)
+    {
+        mReal[(size_t) i] = input[2 * i];
+        mImag[(size_t) i] = input[2 * i + 1];
+    }
+
+    transform (false);
+
+    // Z[k] = E[k] + i O[k], E and O the spectra of the even and odd samples; X[k] = E[k] + e^(-2 pi i k / N) O[k]
+    real[0] = mReal[0] + mImag[0];
+    imag[0] = 0.0f;
+    real[mHalf] = mReal[0] - mImag[0];
+    imag[mHalf] = 0.0f;
+
+    for (int k = 1; k < mHalf; ++k)
+    {
+        const auto zr = mReal[(size_t) k], zi = mImag[(size_t) k];
+        const auto cr = mReal[(size_t) (mHalf - k)], ci = mImag[(size_t) (mHalf - k)];
+
+        const auto er = 0.5f * (zr + cr), ei = 0.5f * (zi - ci);
+        const auto orr = 0.5f * (zi + ci), oi = -0.5f * (zr - cr);
+
+        const auto c = mSplitCos[(size_t) k], s = mSplitSin[(size_t) k];
+
+        real[k] = er + c * orr + s * oi;
+        imag[k] = ei + c * oi - s * orr;
+    }
+}
+
+void RealFFT::inverse (const float* real, const float* imag, float* output) noexcept
+{
+    // back to Z[k] = E[k] + i O[k], with E[k] = (X[k] + X*[M - k]) / 2 and O[k] = (X[k] - X*[M - k]) e^(2 pi i k / N) / 2
+    for (int k = 0; k < mHalf; ++k)
+    {
+        const auto xr = real[k], xi = imag[k];
+        const auto yr = real[mHalf - k], yi = -imag[mHalf - k];
+
+        const auto er = 0.5f * (xr + yr), ei = 0.5f * (xi + yi);
+        const auto dr = 0.5f * (xr - yr), di = 0.5f * (xi - yi);
+
+        const auto c = mSplitCos[(size_t) k], s = mSplitSin[(size_t) k];
+        const auto orr = dr * c - di * s, oi = dr * s + di * c;
+
+        mReal[(size_t) k] = er - oi;
+        mImag[(size_t) k] = ei + orr;
+    }
+
+    transform (true);
+
+    for (int i = 0; i < mHalf; ++i)
+    {
+        output[2 * i] = mReal[(size_t) i];
+        output[2 * i + 1] = mImag[(size_t) i];
+    }
+}
+
+void RealFFT::multiplyAdd (float* destReal, float* destImag,
+                           const float* aReal, const float* aImag,
+                           const float* bReal, const float* bImag, int numBins) noexcept
+{
+    int i = 0;
+
+   #if JUCE_INTEL
+    for (; i + 4 <= numBins; i += 4)
+    {
+        const auto ar = _mm_loadu_ps (aReal + i), ai = _mm_loadu_ps (aImag + i);
+        const auto br = _mm_loadu_ps (bReal + i), bi = _mm_loadu_ps (bImag + i);
+
+        _mm_storeu_ps (destReal + i, _mm_add_ps (_mm_loadu_ps (destReal + i), _mm_sub_ps (_mm_mul_ps (ar, br), _mm_mul_ps (ai, bi))));
+        _mm_storeu_ps (destImag + i, _mm_add_ps (_mm_loadu_ps (destImag + i), _mm_add_ps (_mm_mul_ps (ar, bi), _mm_mul_ps (ai, br))));
+    }
+   #elif SPHERINGER_USE_NEON
+    for (; i + 4 <= numBins; i += 4)
+    {
+        const auto ar = vld1q_f32 (aReal + i), ai = vld1q_f32 (aImag + i);
+        const auto br = vld1q_f32 (bReal + i), bi = vld1q_f32 (bImag + i);
+
+        vst1q_f32 (destReal + i, vmlsq_f32 (vmlaq_f32 (vld1q_f32 (destReal + i), ar, br), ai, bi));
+        vst1q_f32 (destImag + i, vmlaq_f32 (vmlaq_f32 (vld1q_f32 (destImag + i), ar, bi), ai, br));
+    }
+   #endif
+
+    for (; i < numBins; ++i)
+    {
+        destReal[i] += aReal[i] * bReal[i] - aImag[i] * bImag[i];
+        destImag[i] += aReal[i] * bImag[i] + aImag[i] * bReal[i];
+    }
+}
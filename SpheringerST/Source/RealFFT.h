@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    RealFFT.h
+    Created: 18 Oct 2026 9:14:52am
+    Author:  jwmao
+
+    FFT of real signals, for the convolution reverb (the project doesn't use
+    juce_dsp). A real signal of size N goes through a complex radix-2 FFT of
+    size N / 2, with the even samples as the real parts and the odd ones as
+    the imaginary parts, and is then untangled into the N / 2 + 1 bins of the
+    real spectrum. Spectra are kept as separate real and imaginary arrays, so
+    the multiply-accumulate the convolution spends its time in vectorises.
+
+    Neither direction is normalised: forward() then inverse() scales by N / 2.
+    The convolution folds that into the impulse response's spectra.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class RealFFT
+{
+public:
+    // size is a power of two, at least 4
+    explicit RealFFT (int size);
+
+    int getSize() const noexcept { return mSize; }
+    int getNumBins() const noexcept { return mSize / 2 + 1; }
+
+    // getSize() samples in, getNumBins() bins out. Uses the object's scratch, so one thread at a time.
+    void forward (const float* input, float* real, float* imag) noexcept;
+
+    // getNumBins() bins in, getSize() samples out, scaled by getSize() / 2
+    void inverse (const float* real, const float* imag, float* output) noexcept;
+
+    // dest += a * b, bin by bin (the spectra of two convolved signals)
+    static void multiplyAdd (float* destReal, float* destImag,
+                             const float* aReal, const float* aImag,
+                             const float* bReal, const float* bImag, int numBins) noexcept;
+
+private:
+    // in place on mReal / mImag, size mHalf
+    void transform (bool isInverse) noexcept;
+
+    const int mSize;
+    const int mHalf;
+
+    std::vector<int> mBitReversed;
+    std::vector<float> mCos, mSin;          // e^(2 pi i k / mHalf), k < mHalf / 2
+    std::vector<float> mSplitCos, mSplitSin; // e^(2 pi i k / mSize), k < mHalf
+    std::vector<float> mReal, mImag;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealFFT)
+};
@@ -0,0 +1,427 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.cpp
+    Created: 18 Oct 2026 1:07:42pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "RealtimeChecker.h"
+
+const char* RealtimeChecker::getName (Kind kind) noexcept
+{
+    switch (kind)
+    {
+        case Kind::allocation:   return "allocation";
+        case Kind::deallocation: return "deallocation";
+        case Kind::lock:         return "lock";
+        case Kind::wait:         return "wait";
+    }
+
+    return "";
+}
+
+#if ! SPHERINGER_REALTIME_CHECKS
+
+juce::Array<RealtimeChecker::Violation> RealtimeChecker::takeViolations()
+{
+    return {};
+}
+
+#else
+
+#include <new>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <execinfo.h>
+ #define SPHERINGER_HAS_BACKTRACE 1
+#endif
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #define SPHERINGER_INTERPOSE_LIBC 1
+
+ // glibc's own allocator, so the replacements below have something to forward to
+ extern "C"
+ {
+     void* __libc_malloc (size_t) noexcept;
+     void* __libc_calloc (size_t, size_t) noexcept;
+     void* __libc_realloc (void*, size_t) noexcept;
+     void* __libc_memalign (size_t, size_t) noexcept;
+     void __libc_free (void*) noexcept;
+ }
+#endif
+
+// initial-exec: reading these must never allocate, which a lazily created TLS block would
+#if JUCE_GCC || JUCE_CLANG
+ #define SPHERINGER_TLS __attribute__ ((tls_model ("initial-exec"))) thread_local
+#else
+ #define SPHERINGER_TLS thread_local
+#endif
+
+namespace
+{
+    using Kind = RealtimeChecker::Kind;
+
+    // how many ScopedRealtimeThreads the thread is in, and whether it's busy recording (which allocates and locks)
+    SPHERINGER_TLS int realtimeDepth = 0;
+    SPHERINGER_TLS bool isRecording = false;
+
+    constexpr int maxFrames = 32;
+
+    struct Record
+    {
+        Kind kind;
+        void* frames[maxFrames];
+        int numFrames = 0;
+        juce::String stackTrace; // where there's no backtrace(): symbolised straight away
+        int count = 1;
+
+        bool isSameAs (const Record& other) const noexcept
+        {
+            return kind == other.kind && numFrames == other.numFrames && stackTrace == other.stackTrace
+                && std::equal (frames, frames + numFrames, other.frames);
+        }
+    };
+
+    struct Records
+    {
+        juce::CriticalSection lock;
+        juce::Array<Record> list;
+    };
+
+    // never destroyed: a voice worker may still be recording while the statics go at exit
+    Records& getRecords()
+    {
+        static auto* records = new Records();
+        return *records;
+    }
+
+   #if JUCE_GCC || JUCE_CLANG
+    __attribute__ ((noinline))
+   #endif
+    void record (Kind kind)
+    {
+        isRecording = true;
+
+        {
+            Record r;
+            r.kind = kind;
+
+           #if SPHERINGER_HAS_BACKTRACE
+            // the first frame is this function, the next one the hook that called it
+            r.numFrames = juce::jmax (0, backtrace (r.frames, maxFrames) - 1);
+            std::copy (r.frames + 1, r.frames + 1 + r.numFrames, r.frames);
+           #else
+            r.stackTrace = juce::SystemStats::getStackBacktrace();
+           #endif
+
+            auto& records = getRecords();
+            const juce::ScopedLock sl (records.lock);
+            auto existing = std::find_if (records.list.begin(), records.list.end(), [&r] (const Record& x) { return x.isSameAs (r); });
+
+            if (existing != records.list.end())
+                ++existing->count;
+            else
+                records.list.add (r);
+        }
+
+        isRecording = false;
+    }
+
+    inline void check (Kind kind)
+    {
+        if (realtimeDepth > 0 && ! isRecording)
+            record (kind);
+    }
+
+    //==============================================================================
+    void* allocate (size_t size) noexcept
+    {
+       #if SPHERINGER_INTERPOSE_LIBC
+        return __libc_malloc (size);
+       #else
+        return std::malloc (size);
+       #endif
+    }
+
+    void release (void* p) noexcept
+    {
+       #if SPHERINGER_INTERPOSE_LIBC
+        __libc_free (p);
+       #else
+        std::free (p);
+       #endif
+    }
+
+    void* allocateAligned (size_t size, size_t alignment) noexcept
+    {
+       #if SPHERINGER_INTERPOSE_LIBC
+        return __libc_memalign (alignment, size);
+       #elif JUCE_WINDOWS
+        return _aligned_malloc (size, alignment);
+       #else
+        void* p = nullptr;
+        return posix_memalign (&p, juce::jmax (alignment, sizeof (void*)), size) == 0 ? p : nullptr;
+       #endif
+    }
+
+    void releaseAligned (void* p) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free (p);
+       #else
+        release (p);
+       #endif
+    }
+
+    // what the standard operator new does: ask the new handler for memory until there is some, or throw
+    template <typename Allocate>
+    void* newObject (Allocate&& allocateFunction)
+    {
+        check (Kind::allocation);
+
+        for (;;)
+        {
+            if (auto* p = allocateFunction())
+                return p;
+
+            if (auto handler = std::get_new_handler())
+                handler();
+            else
+                throw std::bad_alloc();
+        }
+    }
+
+    void deleteObject (void* p) noexcept
+    {
+        if (p != nullptr)
+            check (Kind::deallocation);
+
+        release (p);
+    }
+
+    void deleteAlignedObject (void* p) noexcept
+    {
+        if (p != nullptr)
+            check (Kind::deallocation);
+
+        releaseAligned (p);
+    }
+
+   #if SPHERINGER_INTERPOSE_LIBC
+    //==============================================================================
+    // the next definition of a libc function: looked up once, at the latest on its first call
+    template <typename Function>
+    Function findNext (std::atomic<void*>& cache, const char* name) noexcept
+    {
+        auto* next = cache.load (std::memory_order_acquire);
+
+        if (next == nullptr)
+        {
+            next = dlsym (RTLD_NEXT, name);
+            cache.store (next, std::memory_order_release);
+        }
+
+        return reinterpret_cast<Function> (next);
+    }
+
+    std::atomic<void*> nextMutexLock, nextReadLock, nextWriteLock, nextConditionWait, nextConditionTimedWait, nextSemaphoreWait;
+
+    int lockMutex (pthread_mutex_t* mutex) noexcept
+    {
+        return findNext<int (*) (pthread_mutex_t*)> (nextMutexLock, "pthread_mutex_lock") (mutex);
+    }
+
+    // before main(), while there's only one thread and nothing is holding a lock
+    const struct LookUpNext
+    {
+        LookUpNext() noexcept
+        {
+            pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+            lockMutex (&mutex);
+            pthread_mutex_unlock (&mutex);
+
+            findNext<void*> (nextReadLock, "pthread_rwlock_rdlock");
+            findNext<void*> (nextWriteLock, "pthread_rwlock_wrlock");
+            findNext<void*> (nextConditionWait, "pthread_cond_wait");
+            findNext<void*> (nextConditionTimedWait, "pthread_cond_timedwait");
+            findNext<void*> (nextSemaphoreWait, "sem_wait");
+        }
+    } lookUpNext;
+   #endif
+}
+
+//==============================================================================
+RealtimeChecker::ScopedRealtimeThread::ScopedRealtimeThread() noexcept   { ++realtimeDepth; }
+RealtimeChecker::ScopedRealtimeThread::~ScopedRealtimeThread() noexcept  { --realtimeDepth; }
+
+juce::Array<RealtimeChecker::Violation> RealtimeChecker::takeViolations()
+{
+    juce::Array<Record> records;
+
+    {
+        auto& all = getRecords();
+        const juce::ScopedLock sl (all.lock);
+        records.swapWith (all.list);
+    }
+
+    juce::Array<Violation> violations;
+
+    for (auto& r : records)
+    {
+        auto stackTrace = r.stackTrace;
+
+       #if SPHERINGER_HAS_BACKTRACE
+        if (auto* symbols = backtrace_symbols (r.frames, r.numFrames))
+        {
+            for (int i = 0; i < r.numFrames; ++i)
+                stackTrace << juce::String (i) << ": " << symbols[i] << juce::newLine;
+
+            std::free (symbols);
+        }
+       #endif
+
+        violations.add ({ r.kind, stackTrace, r.count });
+    }
+
+    return violations;
+}
+
+//==============================================================================
+void* operator new (size_t size)                                              { return newObject ([size] { return allocate (juce::jmax ((size_t) 1, size)); }); }
+void* operator new[] (size_t size)                                            { return operator new (size); }
+void* operator new (size_t size, std::align_val_t alignment)                  { return newObject ([=] { return allocateAligned (juce::jmax ((size_t) 1, size), (size_t) alignment); }); }
+void* operator new[] (size_t size, std::align_val_t alignment)                { return operator new (size, alignment); }
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new (size); } catch (...) { return nullptr; }
+}
+
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new (size); } catch (...) { return nullptr; }
+}
+
+void* operator new (size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    try { return operator new (size, alignment); } catch (...) { return nullptr; }
+}
+
+void* operator new[] (size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    try { return operator new (size, alignment); } catch (...) { return nullptr; }
+}
+
+void operator delete (void* p) noexcept                                           { deleteObject (p); }
+void operator delete[] (void* p) noexcept                                         { deleteObject (p); }
+void operator delete (void* p, size_t) noexcept                                   { deleteObject (p); }
+void operator delete[] (void* p, size_t) noexcept                                 { deleteObject (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept                    { deleteObject (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                  { deleteObject (p); }
+void operator delete (void* p, std::align_val_t) noexcept                         { deleteAlignedObject (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                       { deleteAlignedObject (p); }
+void operator delete (void* p, size_t, std::align_val_t) noexcept                 { deleteAlignedObject (p); }
+void operator delete[] (void* p, size_t, std::align_val_t) noexcept               { deleteAlignedObject (p); }
+void operator delete (void* p, std::align_val_t, const std::nothrow_t&) noexcept  { deleteAlignedObject (p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept{ deleteAlignedObject (p); }
+
+#if SPHERINGER_INTERPOSE_LIBC
+//==============================================================================
+// these replace libc's for the whole process, JUCE's and the standard library's calls included
+extern "C"
+{
+    void* malloc (size_t size) noexcept
+    {
+        check (Kind::allocation);
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        check (Kind::allocation);
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* p, size_t size) noexcept
+    {
+        check (Kind::allocation);
+        return __libc_realloc (p, size);
+    }
+
+    void* memalign (size_t alignment, size_t size) noexcept
+    {
+        check (Kind::allocation);
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        check (Kind::allocation);
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        check (Kind::allocation);
+
+        if (alignment % sizeof (void*) != 0 || ! juce::isPowerOfTwo (alignment))
+            return EINVAL;
+
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free (void* p) noexcept
+    {
+        if (p != nullptr)
+            check (Kind::deallocation);
+
+        __libc_free (p);
+    }
+
+    // trylock never blocks, so it's allowed; unlocking isn't reported either, the lock already was
+    int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+    {
+        check (Kind::lock);
+        return lockMutex (mutex);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* rwlock) noexcept
+    {
+        check (Kind::lock);
+        return findNext<int (*) (pthread_rwlock_t*)> (nextReadLock, "pthread_rwlock_rdlock") (rwlock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* rwlock) noexcept
+    {
+        check (Kind::lock);
+        return findNext<int (*) (pthread_rwlock_t*)> (nextWriteLock, "pthread_rwlock_wrlock") (rwlock);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        check (Kind::wait);
+        return findNext<int (*) (pthread_cond_t*, pthread_mutex_t*)> (nextConditionWait, "pthread_cond_wait") (condition, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        check (Kind::wait);
+        return findNext<int (*) (pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> (nextConditionTimedWait, "pthread_cond_timedwait") (condition, mutex, time);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        check (Kind::wait);
+        return findNext<int (*) (sem_t*)> (nextSemaphoreWait, "sem_wait") (semaphore);
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.h
+    Created: 18 Oct 2026 1:07:42pm
+    Author:  jwmao
+
+    Catches the audio thread doing things it mustn't: allocating or freeing
+    memory, taking a lock or waiting on a condition. It's off unless the build
+    defines SPHERINGER_REALTIME_CHECKS=1 (Tools/RealtimeCheck.cpp is built
+    that way), and then costs one thread-local read per allocation on every
+    other thread.
+
+    A ScopedRealtimeThread marks the code that has to be realtime safe:
+    processBlock() and the voice workers' share of a block. Whatever happens
+    inside one is recorded with its stack, once per distinct stack, and
+    counted.
+
+    operator new and delete are replaced everywhere. On Linux (glibc) malloc,
+    calloc, realloc, free and the aligned variants are interposed as well, so
+    are pthread_mutex_lock, pthread_rwlock_*lock, pthread_cond_wait and
+    sem_wait, which is what CriticalSection, std::mutex and WaitableEvent end
+    up in. Elsewhere only new and delete are caught.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SPHERINGER_REALTIME_CHECKS
+ #define SPHERINGER_REALTIME_CHECKS 0
+#endif
+
+class RealtimeChecker
+{
+public:
+    enum class Kind { allocation, deallocation, lock, wait };
+
+    struct Violation
+    {
+        Kind kind;
+        juce::String stackTrace;
+        int count = 0;
+    };
+
+    // marks the calling thread as realtime until it goes out of scope (they nest). Nothing without the checks
+    class ScopedRealtimeThread
+    {
+    public:
+       #if SPHERINGER_REALTIME_CHECKS
+        ScopedRealtimeThread() noexcept;
+        ~ScopedRealtimeThread() noexcept;
+       #else
+        ScopedRealtimeThread() noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeThread)
+    };
+
+    static constexpr bool isEnabled() noexcept { return SPHERINGER_REALTIME_CHECKS != 0; }
+
+    // everything recorded since the last call, in the order first seen
+    static juce::Array<Violation> takeViolations();
+
+    static const char* getName (Kind kind) noexcept;
+
+private:
+    RealtimeChecker() = delete;
+};
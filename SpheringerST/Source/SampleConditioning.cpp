@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    SampleConditioning.cpp
+    Created: 18 Oct 2026 2:31:05pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleConditioning.h"
+#include "SamplePool.h"
+
+namespace
+{
+    const int magic = (int) juce::ByteOrder::littleEndianInt ("SPCN");
+    constexpr int currentVersion = 2;
+
+    // the envelope's resolution: the peak and energy of every block of this many frames
+    constexpr int framesPerBlock = 64;
+    constexpr int framesPerRead = framesPerBlock * 1024;
+
+    // quieter than this (about -120dB) the file is taken for digital silence and left as it is
+    constexpr float minPeak = 1.0e-6f;
+}
+
+//==============================================================================
+juce::File SampleConditioning::getCacheFile (const juce::File& sampleFile)
+{
+    return sampleFile.getSiblingFile (sampleFile.getFileName() + ".conditioning");
+}
+
+SampleConditioning SampleConditioning::loadOrAnalyse (const juce::File& file, juce::AudioFormatManager& formatManager,
+                                                      const std::function<bool()>& shouldCancel)
+{
+    const auto contentHash = SamplePool::computeContentHash (file);
+    const auto cacheFile = getCacheFile (file);
+
+    SampleConditioning conditioning;
+
+    if (auto cache = cacheFile.createInputStream())
+        if (conditioning.readFrom (*cache, contentHash))
+            return conditioning;
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return {};
+
+    // the whole file once, down to the peak and the energy of each block
+    const auto length = reader->lengthInSamples;
+    const auto numBlocks = (size_t) ((length + framesPerBlock - 1) / framesPerBlock);
+    const auto numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+
+    std::vector<float> blockPeaks (numBlocks, 0.0f);
+    std::vector<double> blockEnergies (numBlocks, 0.0);
+    juce::AudioBuffer<float> chunk (numChannels, framesPerRead);
+
+    for (juce::int64 first = 0; first < length; first += framesPerRead)
+    {
+        if (shouldCancel())
+            return {};
+
+        const auto numFrames = (int) juce::jmin ((juce::int64) framesPerRead, length - first);
+        reader->read (&chunk, 0, numFrames, first, true, true);
+
+        for (int offset = 0; offset < numFrames; offset += framesPerBlock)
+        {
+            const auto num = juce::jmin (framesPerBlock, numFrames - offset);
+            const auto block = (size_t) ((first + offset) / framesPerBlock);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* samples = chunk.getReadPointer (channel, offset);
+                blockPeaks[block] = juce::jmax (blockPeaks[block], juce::FloatVectorOperations::findMaximum (samples, num),
+                                                -juce::FloatVectorOperations::findMinimum (samples, num));
+
+                for (int i = 0; i < num; ++i)
+                    blockEnergies[block] += (double) samples[i] * samples[i];
+            }
+        }
+    }
+
+    conditioning.sampleRate = reader->sampleRate;
+    conditioning.lengthInSamples = length;
+    conditioning.start = 0;
+    conditioning.onset = 0;
+    conditioning.end = length;
+    conditioning.peak = *std::max_element (blockPeaks.begin(), blockPeaks.end());
+
+    if (conditioning.peak >= minPeak)
+    {
+        const auto onsetLevel = conditioning.peak * juce::Decibels::decibelsToGain (onsetDecibels);
+        const auto silenceLevel = conditioning.peak * juce::Decibels::decibelsToGain (silenceDecibels);
+
+        const auto onsetBlock = (size_t) std::distance (blockPeaks.begin(),
+                                                        std::find_if (blockPeaks.begin(), blockPeaks.end(),
+                                                                      [onsetLevel] (float level) { return level >= onsetLevel; }));
+
+        auto endBlock = numBlocks;
+
+        while (endBlock > onsetBlock + 1 && blockPeaks[endBlock - 1] < silenceLevel)
+            --endBlock;
+
+        // the same lead-in before every transient, however quiet, so every zone speaks as long after its note-on
+        conditioning.onset = (juce::int64) onsetBlock * framesPerBlock;
+        conditioning.start = juce::jmax ((juce::int64) 0, conditioning.onset - juce::roundToInt (maxLeadInSeconds * conditioning.sampleRate));
+        conditioning.end = juce::jmin (length, (juce::int64) endBlock * framesPerBlock + (juce::int64) (tailSeconds * conditioning.sampleRate));
+
+        const auto loudnessBlocks = juce::jmax ((size_t) 1, (size_t) (loudnessSeconds * conditioning.sampleRate / framesPerBlock));
+        const auto loudnessEnd = juce::jmin (numBlocks, onsetBlock + loudnessBlocks);
+        const auto energy = std::accumulate (blockEnergies.begin() + (std::ptrdiff_t) onsetBlock,
+                                             blockEnergies.begin() + (std::ptrdiff_t) loudnessEnd, 0.0);
+        const auto numFrames = juce::jmin (length, (juce::int64) loudnessEnd * framesPerBlock) - conditioning.onset;
+
+        conditioning.loudness = (float) std::sqrt (energy / (double) (juce::jmax ((juce::int64) 1, numFrames) * numChannels));
+    }
+
+    // written to a temporary file first, so another instance never reads half a cache. Read-only folders just don't get one.
+    juce::TemporaryFile temporary (cacheFile);
+
+    if (auto output = temporary.getFile().createOutputStream())
+    {
+        conditioning.writeTo (*output, contentHash);
+        output.reset();
+        temporary.overwriteTargetFileWithTemporary();
+    }
+
+    return conditioning;
+}
+
+//==============================================================================
+juce::Range<double> SampleConditioning::getKeptSeconds() const noexcept
+{
+    if (! isValid())
+        return {};
+
+    return { (double) start / sampleRate, (double) end / sampleRate };
+}
+
+float SampleConditioning::getNormalisingGain() const noexcept
+{
+    return getNormalisingGain (loudness, peak);
+}
+
+float SampleConditioning::getNormalisingGain (float rms, float maxPeak) noexcept
+{
+    if (rms <= 0.0f)
+        return 1.0f;
+
+    const auto maxGain = juce::Decibels::decibelsToGain (maxGainDecibels);
+    const auto gain = juce::jlimit (1.0f / maxGain, maxGain, juce::Decibels::decibelsToGain (targetDecibels) / rms);
+
+    // turned down as far as it takes, but never up past full scale
+    return juce::jmin (gain, juce::jmax (1.0f, 1.0f / maxPeak));
+}
+
+float SampleConditioning::getNormalisingGain (const juce::Array<SampleConditioning>& dynamics)
+{
+    if (dynamics.isEmpty() || ! std::all_of (dynamics.begin(), dynamics.end(), [] (const SampleConditioning& c) { return c.isValid(); }))
+        return 1.0f;
+
+    // the loudest one sets the level, the highest peak of any of them the limit
+    float rms = 0.0f, maxPeak = 0.0f;
+
+    for (auto& dynamic : dynamics)
+    {
+        rms = juce::jmax (rms, dynamic.loudness);
+        maxPeak = juce::jmax (maxPeak, dynamic.peak);
+    }
+
+    return getNormalisingGain (rms, maxPeak);
+}
+
+juce::Range<double> SampleConditioning::getKeptSeconds (const juce::Array<SampleConditioning>& layers)
+{
+    if (layers.isEmpty() || ! std::all_of (layers.begin(), layers.end(), [] (const SampleConditioning& c) { return c.isValid(); }))
+        return {};
+
+    auto kept = layers.getReference (0).getKeptSeconds();
+
+    for (auto& layer : layers)
+        kept = kept.getUnionWith (layer.getKeptSeconds());
+
+    return kept;
+}
+
+//==============================================================================
+bool SampleConditioning::readFrom (juce::InputStream& input, const juce::String& contentHash)
+{
+    if (input.readInt() != magic || input.readInt() != currentVersion)
+        return false;
+
+    // a sample that was replaced is analysed again
+    if (input.readString() != contentHash)
+        return false;
+
+    sampleRate = input.readDouble();
+    lengthInSamples = input.readInt64();
+    start = input.readInt64();
+    onset = input.readInt64();
+    end = input.readInt64();
+    peak = input.readFloat();
+    loudness = input.readFloat();
+
+    const auto isConsistent = sampleRate > 0.0 && 0 <= start && start <= onset && onset <= end && end <= lengthInSamples
+                               && start < end && peak >= 0.0f && loudness >= 0.0f;
+
+    if (! isConsistent)
+    {
+        sampleRate = 0.0;
+        return false;
+    }
+
+    return true;
+}
+
+void SampleConditioning::writeTo (juce::OutputStream& output, const juce::String& contentHash) const
+{
+    output.writeInt (magic);
+    output.writeInt (currentVersion);
+    output.writeString (contentHash);
+    output.writeDouble (sampleRate);
+    output.writeInt64 (lengthInSamples);
+    output.writeInt64 (start);
+    output.writeInt64 (onset);
+    output.writeInt64 (end);
+    output.writeFloat (peak);
+    output.writeFloat (loudness);
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SampleConditioning.h
+    Created: 18 Oct 2026 2:31:05pm
+    Author:  jwmao
+
+    What to keep of a sample and how loud it is, worked out when it's first
+    loaded. The note starts 10ms before its transient, the first point within
+    30dB of the peak, so every zone's transient comes as long after its
+    note-on (files with less lead-in than that keep what they have). It ends
+    where it has decayed 60dB below the peak for good, plus 20ms so the tail
+    doesn't stop dead. Its loudness is the RMS of the 200ms from the
+    transient.
+
+    The loader keeps only that part of each file (see SampleData), so the
+    silence around it takes no memory and every note speaks straight away.
+    The mic layers of a note keep the same stretch, so they stay in sync. Each
+    note's loudest dynamic is brought to the same loudness, within 24dB and
+    without taking any peak past full scale, and its softer dynamics get the
+    same gain, so the recorded steps between them stay as they were.
+
+    The analysis reads the whole file once, and is written next to it as
+    "<file name>.conditioning" with the file's content hash, so loading it
+    again only reads that.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SampleConditioning
+{
+public:
+    // relative to the sample's peak
+    static constexpr float silenceDecibels = -60.0f;
+    static constexpr float onsetDecibels = -30.0f;
+
+    static constexpr double maxLeadInSeconds = 0.01;   // kept before the transient
+    static constexpr double tailSeconds = 0.02;
+    static constexpr double loudnessSeconds = 0.2;
+
+    // the RMS level every note's loudest dynamic is brought to, and how far it may be turned up or down for it
+    static constexpr float targetDecibels = -20.0f;
+    static constexpr float maxGainDecibels = 24.0f;
+
+    // loader thread: reads the cache next to the file if it's there and still matches the file, otherwise
+    // analyses the file and writes the cache. Not valid if the file couldn't be read or shouldCancel() stopped it
+    static SampleConditioning loadOrAnalyse (const juce::File& file, juce::AudioFormatManager& formatManager,
+                                             const std::function<bool()>& shouldCancel);
+
+    static juce::File getCacheFile (const juce::File& sampleFile);
+
+    // false for a file that couldn't be analysed, which is kept whole at its own level
+    bool isValid() const noexcept { return sampleRate > 0.0; }
+
+    // the part of the file to keep
+    juce::Range<double> getKeptSeconds() const noexcept;
+
+    // what brings the loudness to targetDecibels, as far as the limits allow. 1 if not valid
+    float getNormalisingGain() const noexcept;
+
+    // the one gain for all the dynamics of a note (any mic): the loudest of them brought to targetDecibels,
+    // no peak of any of them past full scale. 1 if one of them isn't valid
+    static float getNormalisingGain (const juce::Array<SampleConditioning>& dynamics);
+
+    // what a zone keeps of the files of its mic layers: from the earliest start to the latest end of any
+    // of them, so they stay in sync. Empty (the whole files) if one of them isn't valid
+    static juce::Range<double> getKeptSeconds (const juce::Array<SampleConditioning>& layers);
+
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;
+
+    // frames: the first one kept, the transient, and one past the last one kept
+    juce::int64 start = 0, onset = 0, end = 0;
+
+    // over all channels, linear
+    float peak = 0.0f;
+    float loudness = 0.0f;
+
+private:
+    static float getNormalisingGain (float rms, float maxPeak) noexcept;
+
+    bool readFrom (juce::InputStream& input, const juce::String& contentHash);
+    void writeTo (juce::OutputStream& output, const juce::String& contentHash) const;
+};
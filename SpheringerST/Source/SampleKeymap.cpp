@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    SampleKeymap.cpp
+    Created: 17 Oct 2026 10:41:19am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleKeymap.h"
+
+//==============================================================================
+SampleFileInfo SampleFileInfo::fromFile (const juce::File& file)
+{
+    SampleFileInfo info;
+    info.file = file;
+
+    // "Omni AB_S_long_LAHHH_forte_A4_69" -> [Omni AB] [S] [long] [LAHHH] [forte] [A4] [69]
+    auto tokens = juce::StringArray::fromTokens (file.getFileNameWithoutExtension(), "_", {});
+    tokens.removeEmptyStrings();
+
+    // an alternate take: "..._A4_69_rr2"
+    if (tokens.size() > 1)
+    {
+        const auto& rr = tokens[tokens.size() - 1];
+
+        if (rr.startsWithIgnoreCase ("rr") && rr.length() > 2 && rr.substring (2).containsOnly ("0123456789"))
+        {
+            info.alternate = juce::jmax (0, rr.substring (2).getIntValue() - 1);
+            tokens.remove (tokens.size() - 1);
+        }
+    }
+
+    const auto lastToken = tokens[tokens.size() - 1];
+
+    if (lastToken.containsOnly ("0123456789"))
+        info.rootNote = juce::jlimit (0, 127, lastToken.getIntValue());
+
+    // mic, at least one articulation token, dynamic, note name, MIDI number
+    if (tokens.size() >= 5)
+    {
+        info.micPosition = tokens[0];
+        info.dynamic = tokens[tokens.size() - 3];
+
+        juce::StringArray articulationTokens;
+
+        for (int i = 1; i < tokens.size() - 3; ++i)
+            articulationTokens.add (tokens[i]);
+
+        info.articulation = articulationTokens.joinIntoString ("_");
+    }
+
+    return info;
+}
+
+int SampleFileInfo::getDynamicRank (const juce::String& dynamic)
+{
+    static const char* const dynamics[][2] = { { "pianissimo", "pp" },
+                                               { "piano",      "p"  },
+                                               { "mezzopiano", "mp" },
+                                               { "mezzoforte", "mf" },
+                                               { "forte",      "f"  },
+                                               { "fortissimo", "ff" } };
+
+    for (int i = 0; i < (int) juce::numElementsInArray (dynamics); ++i)
+        if (dynamic.equalsIgnoreCase (dynamics[i][0]) || dynamic.equalsIgnoreCase (dynamics[i][1]))
+            return i;
+
+    return 3;
+}
+
+//==============================================================================
+namespace
+{
+    // the zone's takes into its selection tables. The random sequence is deterministic, so renders repeat.
+    void fillAlternates (KeyZone& zone, const juce::Array<int>& soundIndices, int seed)
+    {
+        zone.numAlternates = juce::jmin (soundIndices.size(), KeyZone::maxAlternates);
+
+        for (int i = 0; i < zone.numAlternates; ++i)
+            zone.soundIndices[(size_t) i] = (juce::int16) soundIndices[i];
+
+        for (int channel = 0; channel < (int) zone.channelSounds.size(); ++channel)
+            zone.channelSounds[(size_t) channel] = zone.soundIndices[(size_t) (channel % zone.numAlternates)];
+
+        // shuffled rounds through every take, so none is left out for long. A round never starts
+        // with the take the last one ended on, and the end of the sequence doesn't repeat its start.
+        juce::Random random (seed);
+        std::array<int, KeyZone::maxAlternates> round;
+
+        for (int attempt = 0;; ++attempt)
+        {
+            int previous = -1;
+
+            for (int i = 0; i < KeyZone::randomSequenceLength; ++i)
+            {
+                const auto position = i % zone.numAlternates;
+
+                if (position == 0)
+                {
+                    for (int j = 0; j < zone.numAlternates; ++j)
+                        round[(size_t) j] = j;
+
+                    for (int j = zone.numAlternates; --j > 0;)
+                        std::swap (round[(size_t) j], round[(size_t) random.nextInt (j + 1)]);
+
+                    if (round[0] == previous)
+                        std::swap (round[0], round[(size_t) (zone.numAlternates - 1)]);
+                }
+
+                previous = round[(size_t) position];
+                zone.randomSequence[(size_t) i] = zone.soundIndices[(size_t) previous];
+            }
+
+            if (zone.numAlternates < 2 || attempt > 16
+                 || zone.randomSequence.front() != zone.randomSequence.back())
+                break;
+        }
+    }
+}
+
+std::unique_ptr<SampleKeymap> SampleKeymap::build (const juce::String& articulation,
+                                                   const juce::Array<SampleFileInfo>& samples,
+                                                   const juce::Array<int>& soundIndices,
+                                                   int maxStretchSemitones)
+{
+    jassert (samples.size() == soundIndices.size());
+
+    auto keymap = std::make_unique<SampleKeymap>();
+    keymap->mArticulation = articulation;
+    keymap->mTable.fill (-1);
+
+    // one velocity layer per dynamic, quietest first
+    juce::Array<int> ranks;
+
+    for (auto& sample : samples)
+        if (sample.articulation == articulation)
+            ranks.addIfNotAlreadyThere (SampleFileInfo::getDynamicRank (sample.dynamic));
+
+    ranks.sort();
+
+    const int numLayers = ranks.size();
+
+    if (numLayers == 0)
+        return keymap;
+
+    // zoneAtNote[layer][note] -> index into mZones
+    std::vector<std::array<int, numNotes>> zoneAtNote ((size_t) numLayers);
+
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+        auto& notes = zoneAtNote[(size_t) layer];
+        notes.fill (-1);
+
+        // the samples of this layer by root, the samples that share a root are its alternate takes
+        juce::Array<juce::Array<int>> roots;
+
+        for (int i = 0; i < samples.size(); ++i)
+        {
+            auto& sample = samples.getReference (i);
+
+            if (sample.articulation != articulation || SampleFileInfo::getDynamicRank (sample.dynamic) != ranks[layer])
+                continue;
+
+            auto* takes = std::find_if (roots.begin(), roots.end(), [&] (const juce::Array<int>& other)
+            {
+                return samples.getReference (other.getFirst()).rootNote == sample.rootNote;
+            });
+
+            if (takes == roots.end())
+                roots.add ({ i });
+            else
+                takes->add (i);
+        }
+
+        std::sort (roots.begin(), roots.end(), [&] (const juce::Array<int>& a, const juce::Array<int>& b)
+        {
+            return samples.getReference (a.getFirst()).rootNote < samples.getReference (b.getFirst()).rootNote;
+        });
+
+        // each root's takes by their round-robin number, otherwise in file order
+        for (auto& takes : roots)
+        {
+            std::stable_sort (takes.begin(), takes.end(), [&] (int a, int b)
+            {
+                return samples.getReference (a).alternate < samples.getReference (b).alternate;
+            });
+        }
+
+        const auto rootOf = [&] (int i) { return samples.getReference (roots.getReference (i).getFirst()).rootNote; };
+
+        // velocity range of this layer: split 0..127 evenly between the layers
+        const int lowVelocity  = layer == 0 ? 0 : (layer * numVelocities) / numLayers;
+        const int highVelocity = ((layer + 1) * numVelocities) / numLayers - 1;
+
+        for (int i = 0; i < roots.size(); ++i)
+        {
+            const int root = rootOf (i);
+
+            // split the keyboard half way to the neighbouring roots, so no sample
+            // is stretched further than half the gap to the next one
+            const int low = i == 0 ? root - maxStretchSemitones
+                                   : rootOf (i - 1) + (root - rootOf (i - 1)) / 2 + 1;
+
+            const int high = i == roots.size() - 1 ? root + maxStretchSemitones
+                                                   : root + (rootOf (i + 1) - root) / 2;
+
+            juce::Array<int> zoneSounds;
+
+            for (auto take : roots.getReference (i))
+                zoneSounds.add (soundIndices[take]);
+
+            KeyZone zone;
+            fillAlternates (zone, zoneSounds, keymap->mZones.size() + 1);
+            zone.rootNote     = root;
+            zone.lowNote      = juce::jlimit (0, numNotes - 1, low);
+            zone.highNote     = juce::jlimit (0, numNotes - 1, high);
+            zone.lowVelocity  = lowVelocity;
+            zone.highVelocity = highVelocity;
+
+            for (int note = zone.lowNote; note <= zone.highNote; ++note)
+                notes[(size_t) note] = keymap->mZones.size();
+
+            keymap->mZones.add (zone);
+        }
+    }
+
+    // fill the lookup table; if a layer has nothing on a key, borrow from the nearest layer that does
+    for (int note = 0; note < numNotes; ++note)
+    {
+        for (int velocity = 0; velocity < numVelocities; ++velocity)
+        {
+            const int layer = juce::jmin (numLayers - 1, (velocity * numLayers) / numVelocities);
+
+            for (int distance = 0; distance < numLayers; ++distance)
+            {
+                const int candidates[] = { layer - distance, layer + distance };
+                int zone = -1;
+
+                for (auto candidate : candidates)
+                    if (zone < 0 && juce::isPositiveAndBelow (candidate, numLayers))
+                        zone = zoneAtNote[(size_t) candidate][(size_t) note];
+
+                if (zone >= 0)
+                {
+                    keymap->mTable[(size_t) (note * numVelocities + velocity)] = (juce::int16) zone;
+                    break;
+                }
+            }
+        }
+    }
+
+    return keymap;
+}
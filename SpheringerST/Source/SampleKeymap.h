@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    SampleKeymap.h
+    Created: 17 Oct 2026 10:41:19am
+    Author:  jwmao
+
+    Maps (MIDI note, velocity) to a sample zone.
+
+    Sample files follow the naming convention
+        <mic position>_<articulation>_<dynamic>_<note name>_<MIDI root>.wav
+    e.g. "Omni AB_S_long_LAHHH_forte_A4_69.wav". Alternate takes of the same
+    note add a round-robin token, "..._A4_69_rr2.wav", and share one zone.
+    Zones of the same dynamic split the keyboard half way between neighbouring
+    roots, and the dynamics split the velocity range, so every lookup on the
+    audio thread is a single read from a 128 x 128 table.
+
+    Which take plays is worked out when the keymap is built as well: each
+    zone has its takes in round-robin order, a shuffled sequence and a take
+    per MIDI channel, so a note-on only indexes one of those with the
+    synth's counter for the key (or the channel).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// what we can tell about a sample from its file name
+struct SampleFileInfo
+{
+    juce::File file;
+    juce::String micPosition;   // "Omni AB"
+    juce::String articulation;  // "S_long_LAHHH"
+    juce::String dynamic;       // "forte"
+    int rootNote = 60;          // 69
+    int alternate = 0;          // 1 for "rr2", takes without the token come first
+
+    // parses the naming convention; files that don't follow it still get a root note
+    // from their trailing number and end up in the default articulation/dynamic
+    static SampleFileInfo fromFile (const juce::File& file);
+
+    // pianissimo = 0 ... fortissimo = 5, anything unknown sits in the middle
+    static int getDynamicRank (const juce::String& dynamic);
+};
+
+//==============================================================================
+// how a zone picks between its alternate takes, see SampleKeymap::getSoundIndex()
+enum class AlternateMode
+{
+    roundRobin = 0,     // one after the other, per key
+    random,             // shuffled, never the same take twice in a row
+    midiChannel         // channel 1 plays the first take, channel 2 the second, ...
+};
+
+//==============================================================================
+struct KeyZone
+{
+    static constexpr int maxAlternates = 16;
+    static constexpr int randomSequenceLength = 64;     // a power of two, so the counter wraps with a mask
+
+    int rootNote = 60;
+    int lowNote = 0, highNote = 127;
+    int lowVelocity = 0, highVelocity = 127;
+
+    // indices into SoundSet::sounds: the takes in round-robin order, then the
+    // shuffled sequence and the take for each MIDI channel
+    int numAlternates = 0;
+    std::array<juce::int16, maxAlternates> soundIndices {};
+    std::array<juce::int16, randomSequenceLength> randomSequence {};
+    std::array<juce::int16, 16> channelSounds {};
+};
+
+//==============================================================================
+class SampleKeymap
+{
+public:
+    static constexpr int numNotes = 128;
+    static constexpr int numVelocities = 128;
+
+    SampleKeymap() = default;
+
+    // builds the zones for one articulation. soundIndices[i] is the sound that plays samples[i].
+    // maxStretchSemitones limits how far the lowest and highest roots reach past themselves.
+    static std::unique_ptr<SampleKeymap> build (const juce::String& articulation,
+                                                const juce::Array<SampleFileInfo>& samples,
+                                                const juce::Array<int>& soundIndices,
+                                                int maxStretchSemitones);
+
+    // audio thread: the sound to play for a note/velocity, or -1 if nothing is mapped there.
+    // count is how many times the key was played before, midiChannel is 1..16.
+    int getSoundIndex (int midiNoteNumber, int midiVelocity, AlternateMode mode, juce::uint32 count, int midiChannel) const noexcept
+    {
+        const auto zoneIndex = mTable[(size_t) (midiNoteNumber * numVelocities + midiVelocity)];
+
+        if (zoneIndex < 0)
+            return -1;
+
+        const auto& zone = mZones.getReference (zoneIndex);
+
+        switch (mode)
+        {
+            case AlternateMode::random:      return zone.randomSequence[count & (KeyZone::randomSequenceLength - 1)];
+            case AlternateMode::midiChannel: return zone.channelSounds[(size_t) ((midiChannel - 1) & 15)];
+            case AlternateMode::roundRobin:  break;
+        }
+
+        return zone.soundIndices[count % (juce::uint32) zone.numAlternates];
+    }
+
+    // MIDI velocity from the 0..1 float the Synthesiser hands to noteOn()
+    static int toMidiVelocity (float velocity) noexcept
+    {
+        return juce::jlimit (0, numVelocities - 1, juce::roundToInt (velocity * 127.0f));
+    }
+
+    const juce::String& getArticulation() const noexcept { return mArticulation; }
+    const juce::Array<KeyZone>& getZones() const noexcept { return mZones; }
+
+private:
+    juce::String mArticulation;
+    juce::Array<KeyZone> mZones;
+    std::array<juce::int16, numNotes * numVelocities> mTable;    // index into mZones
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleKeymap)
+};
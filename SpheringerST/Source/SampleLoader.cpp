@@ -0,0 +1,812 @@
+/*
+  ==============================================================================
+
+    SampleLoader.cpp
+    Created: 17 Oct 2026 9:35:02am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+#include "SampleZone.h"
+#include "SampleRateConverter.h"
+#include "SampleConditioning.h"
+
+namespace
+{
+    // the mic layers of a note share a zone: same articulation, dynamic, root and take, another mic
+    bool isSameNote (const SampleFileInfo& a, const SampleFileInfo& b)
+    {
+        return a.articulation == b.articulation && a.dynamic == b.dynamic && a.rootNote == b.rootNote && a.alternate == b.alternate;
+    }
+
+    // and its dynamics are turned up or down together, so the steps between them stay as recorded
+    bool isSamePitch (const SampleFileInfo& a, const SampleFileInfo& b)
+    {
+        return a.articulation == b.articulation && a.rootNote == b.rootNote && a.alternate == b.alternate;
+    }
+}
+
+//==============================================================================
+class SampleLoader::LoadJob : public juce::ThreadPoolJob
+{
+public:
+    LoadJob (SampleLoader& o, const SoundSetSource& s, const NoteUsage& usage, juce::uint32 number)
+        : juce::ThreadPoolJob ("Load " + s.name), owner (o), source (s), noteUsage (usage), loadNumber (number)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        auto set = owner.decodeFiles (source, noteUsage, [this] { return shouldExit(); },
+                                      [this] { return loadNumber <= owner.mLastStoppedLoad.load(); });
+
+        if (set == nullptr || shouldExit())
+            return jobHasFinished;
+
+        if (owner.onSoundSetLoaded != nullptr)
+            owner.onSoundSetLoaded (set);
+
+        // the set plays from the source meanwhile, the voices switch to the levels as they appear
+        owner.buildMipMaps (*set, [this] { return shouldExit(); });
+        owner.findLoops (*set, [this] { return shouldExit(); });
+        owner.loadPeaks (*set, [this] { return shouldExit(); });
+
+        if (! shouldExit())
+            owner.logMemoryUse (*set);
+
+        return jobHasFinished;
+    }
+
+private:
+    SampleLoader& owner;
+    const SoundSetSource source;
+    const NoteUsage noteUsage;
+    const juce::uint32 loadNumber;
+};
+
+//==============================================================================
+// what the decode jobs of one batch hand back to the load job, in the order they finish
+struct SampleLoader::DecodeBatch
+{
+    struct Decoded
+    {
+        int item;
+        SampleData::Ptr data;   // nullptr if the item failed, or was skipped
+        bool skipped;
+    };
+
+    juce::CriticalSection lock;
+    juce::Array<Decoded> decoded;
+    juce::WaitableEvent itemDone;
+
+    // the items still queued are skipped
+    std::atomic<bool> skipRest {false};
+};
+
+class SampleLoader::DecodeJob : public juce::ThreadPoolJob
+{
+public:
+    // load is only called from runJob(), and the load job waits for every item to report back before it goes
+    DecodeJob (std::shared_ptr<DecodeBatch> b, int i, const std::function<SampleData::Ptr (int)>& f)
+        : juce::ThreadPoolJob ("Decode"), batch (std::move (b)), item (i), load (f)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        SampleData::Ptr data;
+        const auto skipped = batch->skipRest.load();
+
+        if (! skipped)
+            data = load (item);
+
+        {
+            const juce::ScopedLock sl (batch->lock);
+            batch->decoded.add ({ item, data, skipped });
+        }
+
+        batch->itemDone.signal();
+        return jobHasFinished;
+    }
+
+private:
+    const std::shared_ptr<DecodeBatch> batch;
+    const int item;
+    const std::function<SampleData::Ptr (int)>& load;
+};
+
+//==============================================================================
+SampleLoader::SampleLoader (SamplePool& samplePool)
+    : mSamplePool (samplePool)
+{
+}
+
+SampleLoader::~SampleLoader()
+{
+    cancelAll();
+}
+
+SoundSetSource SampleLoader::loadFile (const juce::File& file)
+{
+    SoundSetSource source;
+    source.name = file.getFileName();
+    source.files.add (file);
+    source.maxStretchSemitones = 127;
+
+    load (source);
+    return source;
+}
+
+SoundSetSource SampleLoader::loadFolder (const juce::File& folder)
+{
+    SoundSetSource source;
+    source.name = folder.getFileName();
+    source.files = folder.findChildFiles (juce::File::findFiles, false, mSamplePool.getFormatManager().getWildcardForAllFormats());
+    source.files.sort();
+    source.maxStretchSemitones = folderStretchSemitones;
+
+    load (source);
+    return source;
+}
+
+SoundSetSource SampleLoader::loadFiles (const juce::Array<juce::File>& filesAndFolders)
+{
+    SoundSetSource source;
+    source.files = findAudioFiles (filesAndFolders);
+    source.maxStretchSemitones = source.files.size() == 1 ? 127 : folderStretchSemitones;
+
+    // named after what was dropped if it was one thing, otherwise after the folder it came from
+    if (filesAndFolders.size() == 1)
+        source.name = filesAndFolders.getFirst().getFileName();
+    else if (! filesAndFolders.isEmpty())
+        source.name = filesAndFolders.getFirst().getParentDirectory().getFileName() + " (" + juce::String (source.files.size()) + " files)";
+
+    if (! source.isEmpty())
+        load (source);
+
+    return source;
+}
+
+bool SampleLoader::canLoad (const juce::File& fileOrFolder) const
+{
+    return fileOrFolder.isDirectory() || mSamplePool.getFormatManager().findFormatForFileExtension (fileOrFolder.getFileExtension()) != nullptr;
+}
+
+juce::Array<juce::File> SampleLoader::findAudioFiles (const juce::Array<juce::File>& filesAndFolders) const
+{
+    const auto wildcard = mSamplePool.getFormatManager().getWildcardForAllFormats();
+    juce::Array<juce::File> files;
+
+    for (auto& item : filesAndFolders)
+    {
+        // a library's mic positions or articulations are often in folders of their own
+        if (item.isDirectory())
+        {
+            auto children = item.findChildFiles (juce::File::findFiles, true, wildcard);
+            children.sort();
+
+            for (auto& child : children)
+                if (! SampleRateConverter::isCacheFile (child))
+                    files.addIfNotAlreadyThere (child);
+        }
+        else if (canLoad (item))
+        {
+            files.addIfNotAlreadyThere (item);
+        }
+    }
+
+    return files;
+}
+
+void SampleLoader::load (const SoundSetSource& source, const NoteUsage& noteUsage)
+{
+    // the pool has a single thread, so sets are loaded (and published) in the order they were asked for
+    mPool.addJob (new LoadJob (*this, source, noteUsage, ++mNumLoadsQueued), true);
+}
+
+void SampleLoader::stopLoading()
+{
+    // whatever is running sees this between files; the queued ones never start
+    mLastStoppedLoad = mNumLoadsQueued.load();
+    mPool.removeAllJobs (false, 0);
+}
+
+bool SampleLoader::waitUntilIdle (int timeoutMs) const
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+    while (isLoading())
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep (5);
+    }
+
+    return true;
+}
+
+SampleLoader::MemoryUse SampleLoader::getMemoryUse (const SoundSet& set)
+{
+    MemoryUse use;
+    juce::Array<const SampleData*> counted;
+
+    // zones can share a file
+    for (auto* sound : set.sounds)
+    {
+        if (auto* zone = dynamic_cast<SampleZone*> (sound))
+        {
+            for (int i = 0; i < zone->getNumLayers(); ++i)
+            {
+                const auto& data = *zone->getLayer (i).data;
+
+                if (counted.addIfNotAlreadyThere (&data))
+                {
+                    use.storage = data.getStorage();
+                    use.bytes += data.getSizeInMemory();
+                    use.bytesAsFloat += data.getSizeAsFloat();
+                }
+            }
+        }
+    }
+
+    return use;
+}
+
+void SampleLoader::findLoops (const SoundSet& set, const std::function<bool()>& shouldCancel)
+{
+    for (auto* sound : set.sounds)
+    {
+        if (shouldCancel())
+            return;
+
+        // notes pick the loop up from their next start on
+        if (auto* zone = dynamic_cast<SampleZone*> (sound))
+        {
+            auto& leader = zone->getData();
+            leader.findLoop (shouldCancel);
+
+            for (int i = 1; i < zone->getNumLayers() && ! shouldCancel(); ++i)
+                zone->getLayer (i).data->findLoop (shouldCancel, &leader);
+        }
+    }
+}
+
+void SampleLoader::loadPeaks (const SoundSet& set, const std::function<bool()>& shouldCancel)
+{
+    for (auto* sound : set.sounds)
+    {
+        if (shouldCancel())
+            return;
+
+        if (auto* zone = dynamic_cast<SampleZone*> (sound))
+            if (! zone->getData().loadPeaks (shouldCancel) && ! shouldCancel())
+                log ("Could not read peaks: " + zone->getFile().getFullPathName());
+    }
+}
+
+void SampleLoader::logMemoryUse (const SoundSet& set) const
+{
+    const auto use = getMemoryUse (set);
+
+    log ("Sound set " + set.name + ": " + juce::File::descriptionOfSizeInBytes (use.bytes) + " in memory as "
+         + CompactAudioBuffer::getName (use.storage) + ", " + juce::File::descriptionOfSizeInBytes (use.bytesAsFloat) + " as float");
+}
+
+void SampleLoader::log (const juce::String& message) const
+{
+    if (onLogMessage != nullptr)
+        onLogMessage (message);
+    else
+        std::cout << message << std::endl;
+}
+
+void SampleLoader::cancelAll()
+{
+    mPool.removeAllJobs (true, 5000);
+}
+
+juce::Array<int> SampleLoader::getLoadOrder (const SoundSetSource& source, const NoteUsage& noteUsage)
+{
+    juce::Array<int> order;
+    juce::Array<double> scores;
+
+    for (int i = 0; i < source.files.size(); ++i)
+    {
+        // every played note counts towards the zones around it, less the further away their root is
+        const auto root = SampleFileInfo::fromFile (source.files.getReference (i)).rootNote;
+        double score = 0.0;
+
+        for (int note = 0; note < (int) noteUsage.size(); ++note)
+            score += noteUsage[(size_t) note] / (1.0 + std::abs (note - root));
+
+        order.add (i);
+        scores.add (score);
+    }
+
+    // stable, so without any usage the files load in their own order
+    std::stable_sort (order.begin(), order.end(), [&scores] (int a, int b) { return scores[a] > scores[b]; });
+    return order;
+}
+
+SoundSet::Ptr SampleLoader::decodeFiles (const SoundSetSource& source, const NoteUsage& noteUsage, const std::function<bool()>& shouldCancel,
+                                         const std::function<bool()>& shouldStop)
+{
+    auto order = getLoadOrder (source, noteUsage);
+
+    // only the mic positions that are turned up
+    const auto micPositions = source.getMicPositions();
+    const auto numPositions = juce::jmin (micPositions.size(), SampleZone::maxLayers);
+    auto enabledPositions = getMicPositions() & ((1u << numPositions) - 1);
+
+    if (enabledPositions == 0)
+        enabledPositions = 1;
+
+    juce::Array<SampleFileInfo> infoOfFile;
+    juce::Array<int> micPositionOfFile;
+
+    for (auto& file : source.files)
+    {
+        infoOfFile.add (SampleFileInfo::fromFile (file));
+        micPositionOfFile.add (micPositions.indexOf (infoOfFile.getLast().micPosition));
+    }
+
+    if (micPositions.size() > SampleZone::maxLayers)
+        log ("Only the first " + juce::String (SampleZone::maxLayers) + " mic positions are loaded: " + micPositions.joinIntoString (", "));
+
+    order.removeIf ([&] (int fileIndex)
+    {
+        const auto position = micPositionOfFile[fileIndex];
+        return position >= numPositions || (enabledPositions & (1u << position)) == 0;
+    });
+
+    const auto storage = getStorage();
+    const auto hostRate = getHostSampleRate();
+
+    // the files' content hashes, which for a copy at the host rate aren't the copy's own
+    std::vector<juce::String> contentHashes ((size_t) order.size());
+
+    // the mic layers of each file's note that are loaded, in mic position order, and what to keep of them.
+    // Its dynamics share one gain, from the loudest of them
+    std::vector<juce::Array<int>> layersOfFile ((size_t) source.files.size());
+    std::vector<juce::Array<int>> dynamicsOfFile ((size_t) source.files.size());
+    std::vector<SampleConditioning> conditioning ((size_t) source.files.size());
+    std::vector<std::once_flag> analysed ((size_t) source.files.size());
+    std::vector<juce::Range<double>> keptSeconds ((size_t) order.size());
+    std::vector<float> gains ((size_t) order.size(), 1.0f);
+
+    for (auto fileIndex : order)
+    {
+        auto& layers = layersOfFile[(size_t) fileIndex];
+        auto& dynamics = dynamicsOfFile[(size_t) fileIndex];
+
+        for (auto other : order)
+        {
+            if (isSameNote (infoOfFile.getReference (fileIndex), infoOfFile.getReference (other)))
+                layers.add (other);
+
+            if (isSamePitch (infoOfFile.getReference (fileIndex), infoOfFile.getReference (other)))
+                dynamics.add (other);
+        }
+
+        std::sort (layers.begin(), layers.end(), [&micPositionOfFile] (int a, int b) { return micPositionOfFile[a] < micPositionOfFile[b]; });
+    }
+
+    const std::function<SampleData::Ptr (int)> loadFile = [&] (int n) -> SampleData::Ptr
+    {
+        const auto& file = source.files.getReference (order[n]);
+
+        // the note's layers are trimmed alike so they stay in sync, and all its dynamics are turned up or down
+        // by the same gain. Whichever file of them is loaded first analyses them all, the others wait for it
+        const auto analyse = [&] (int fileIndex) -> const SampleConditioning&
+        {
+            std::call_once (analysed[(size_t) fileIndex], [&]
+            {
+                conditioning[(size_t) fileIndex] = SampleConditioning::loadOrAnalyse (source.files.getReference (fileIndex),
+                                                                                      mSamplePool.getFormatManager(), shouldCancel);
+            });
+
+            return conditioning[(size_t) fileIndex];
+        };
+
+        juce::Array<SampleConditioning> layers, dynamics;
+
+        for (auto layer : layersOfFile[(size_t) order[n]])
+            layers.add (analyse (layer));
+
+        for (auto dynamic : dynamicsOfFile[(size_t) order[n]])
+            dynamics.add (analyse (dynamic));
+
+        keptSeconds[(size_t) n] = SampleConditioning::getKeptSeconds (layers);
+        gains[(size_t) n] = SampleConditioning::getNormalisingGain (dynamics);
+
+        // converted to this rate before: the copy is all that needs reading
+        if (hostRate > 0)
+        {
+            const auto hash = SamplePool::computeContentHash (file);
+            const auto cacheFile = SampleRateConverter::getCacheFile (file, hash, hostRate);
+
+            if (cacheFile.existsAsFile())
+            {
+                if (auto data = mSamplePool.getOrLoad (cacheFile, preloadSeconds, storage, keptSeconds[(size_t) n]))
+                {
+                    contentHashes[(size_t) n] = hash;
+                    return data;
+                }
+            }
+        }
+
+        // shared with any other instance that has the same file loaded. The pool only locks to look files up,
+        // so the decoding itself runs in parallel
+        auto data = mSamplePool.getOrLoad (file, preloadSeconds, storage, keptSeconds[(size_t) n]);
+
+        if (data != nullptr)
+            contentHashes[(size_t) n] = data->getContentHash();
+
+        return data;
+    };
+
+    setProgress (0, order.size());
+
+    const auto publishesPartialSets = order.size() >= minFilesForPartialSet && onSoundSetLoaded != nullptr;
+    auto lastPublished = juce::Time::getMillisecondCounter();
+
+    juce::Array<LoadedSample> samples;
+    juce::Array<int> skippedFiles;
+    int numDone = 0;
+    bool cancelled = false, stopped = false;
+
+    const auto shouldSkip = [&]
+    {
+        cancelled = shouldCancel();
+        stopped = ! cancelled && shouldStop();
+        return cancelled || stopped;
+    };
+
+    // queued in load order, so the zones around the most played notes still come in first
+    runOnDecodePool (order.size(), loadFile, shouldSkip, [&] (int n, SampleData::Ptr data, bool skipped)
+    {
+        const auto fileIndex = order[n];
+        const auto& file = source.files.getReference (fileIndex);
+        setProgress (++numDone, order.size());
+
+        if (skipped)
+        {
+            skippedFiles.add (fileIndex);
+            return;
+        }
+
+        if (data == nullptr)
+        {
+            log ("Could not read file: " + file.getFullPathName());
+            return;
+        }
+
+        const auto& contentHash = contentHashes[(size_t) n];
+        const auto& savedHash = source.contentHashes[fileIndex];
+
+        if (savedHash.isNotEmpty() && savedHash != contentHash)
+            log ("File has changed since the session was saved: " + file.getFullPathName());
+
+        const auto& info = infoOfFile.getReference (fileIndex);
+        samples.add ({ fileIndex, data, contentHash, info, micPositionOfFile[fileIndex], keptSeconds[(size_t) n], gains[(size_t) n] });
+
+        // output log
+        log ("File loaded! File name: " + file.getFileName() + ", Base MIDI number: " + juce::String (info.rootNote));
+
+        // stretched across the whole keyboard, so every note plays something until the full set replaces it
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if (publishesPartialSets && ! cancelled && ! stopped && numDone < order.size()
+            && now - lastPublished >= (juce::uint32) publishIntervalMs)
+        {
+            onSoundSetLoaded (buildSet (source, samples, 127, true));
+            lastPublished = now;
+        }
+    });
+
+    setProgress (0, 0);
+
+    if (cancelled)
+        return nullptr;
+
+    if (stopped)
+        log ("Stopped loading " + source.name + " after " + juce::String (samples.size()) + " of " + juce::String (order.size()) + " files");
+
+    if (samples.isEmpty())
+        return nullptr;
+
+    if (! stopped)
+    {
+        if (hostRate > 0 && ! resampleToHostRate (source, samples, hostRate, shouldCancel, shouldStop))
+            return nullptr;
+
+        return buildSet (source, samples, source.maxStretchSemitones, false);
+    }
+
+    // a stopped set is what made it, and is saved as that: the skipped files go from its source. Files of
+    // mic positions that are turned down stay, so turning them up loads them as usual
+    auto loaded = source;
+    loaded.files.clearQuick();
+    loaded.contentHashes.clearQuick();
+
+    juce::Array<int> newIndices;
+
+    for (int i = 0; i < source.files.size(); ++i)
+    {
+        newIndices.add (skippedFiles.contains (i) ? -1 : loaded.files.size());
+
+        if (! skippedFiles.contains (i))
+            loaded.files.add (source.files.getReference (i));
+    }
+
+    if (hostRate > 0)
+        unifyLayerRates (source, samples, hostRate);
+
+    for (auto& sample : samples)
+        sample.fileIndex = newIndices[sample.fileIndex];
+
+    return buildSet (loaded, samples, source.maxStretchSemitones, false);
+}
+
+void SampleLoader::runOnDecodePool (int numItems, const std::function<SampleData::Ptr (int)>& load,
+                                    const std::function<bool()>& shouldSkip,
+                                    const std::function<void (int, SampleData::Ptr, bool)>& onDone)
+{
+    auto batch = std::make_shared<DecodeBatch>();
+
+    for (int i = 0; i < numItems; ++i)
+        mDecodePool.addJob (new DecodeJob (batch, i, load), true);
+
+    // every job reports back, skipped or not, so none of them is still running once this returns
+    for (int numDone = 0; numDone < numItems;)
+    {
+        if (! batch->skipRest.load() && shouldSkip())
+            batch->skipRest = true;
+
+        batch->itemDone.wait (20);
+
+        juce::Array<DecodeBatch::Decoded> decoded;
+
+        {
+            const juce::ScopedLock sl (batch->lock);
+            decoded.addArray (batch->decoded, numDone);
+        }
+
+        for (auto& result : decoded)
+        {
+            ++numDone;
+            onDone (result.item, result.data, result.skipped);
+        }
+    }
+}
+
+bool SampleLoader::resampleToHostRate (const SoundSetSource& source, juce::Array<LoadedSample>& samples, int hostRate,
+                                       const std::function<bool()>& shouldCancel, const std::function<bool()>& shouldStop)
+{
+    juce::Array<int> toConvert;
+    int numReadOnly = 0;
+
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        const auto& data = *samples.getReference (i).data;
+
+        if (juce::roundToInt (data.getSampleRate()) == hostRate)
+            continue;
+
+        // checked up front, so a read-only library doesn't start a conversion for every file only to fail at the end
+        if (SampleRateConverter::canWriteCacheFor (data.getFile()))
+            toConvert.add (i);
+        else
+            ++numReadOnly;
+    }
+
+    if (numReadOnly > 0)
+        log (juce::String (numReadOnly) + " files of " + source.name + " play at their own rate, their folder can't be written to");
+
+    if (toConvert.isEmpty())
+    {
+        unifyLayerRates (source, samples, hostRate);
+        return true;
+    }
+
+    // converting takes a while, the set plays at the files' rates meanwhile (without mip levels, which would be thrown away)
+    if (onSoundSetLoaded != nullptr)
+        onSoundSetLoaded (buildSet (source, samples, source.maxStretchSemitones, false));
+
+    const auto storage = getStorage();
+    const auto shouldGiveUp = [&shouldCancel, &shouldStop] { return shouldCancel() || shouldStop(); };
+
+    const std::function<SampleData::Ptr (int)> convert = [&] (int n) -> SampleData::Ptr
+    {
+        const auto& sample = samples.getReference (toConvert[n]);
+
+        if (! SampleRateConverter::convert (*sample.data, sample.contentHash, hostRate, shouldGiveUp))
+            return nullptr;
+
+        return mSamplePool.getOrLoad (SampleRateConverter::getCacheFile (sample.data->getFile(), sample.contentHash, hostRate),
+                                      preloadSeconds, storage, sample.keptSeconds);
+    };
+
+    juce::Array<SampleData::Ptr> converted;
+    converted.insertMultiple (0, nullptr, toConvert.size());
+
+    int numDone = 0, numFailed = 0;
+    bool cancelled = false, stopped = false;
+
+    setProgress (0, toConvert.size(), true);
+
+    runOnDecodePool (toConvert.size(), convert,
+                     [&]
+                     {
+                         cancelled = shouldCancel();
+                         stopped = ! cancelled && shouldStop();
+                         return cancelled || stopped;
+                     },
+                     [&] (int n, SampleData::Ptr data, bool skipped)
+                     {
+                         converted.set (n, data);
+                         numFailed += data == nullptr && ! skipped && ! shouldGiveUp() ? 1 : 0;
+                         setProgress (++numDone, toConvert.size(), true);
+                     });
+
+    setProgress (0, 0);
+
+    if (cancelled)
+        return false;
+
+    for (int n = 0; n < toConvert.size(); ++n)
+        if (converted[n] != nullptr)
+            samples.getReference (toConvert[n]).data = converted[n];
+
+    unifyLayerRates (source, samples, hostRate);
+
+    if (numFailed > 0)
+        log (juce::String (numFailed) + " files of " + source.name + " play at their own rate, they couldn't be resampled to "
+             + juce::String (hostRate) + " Hz next to the originals");
+
+    return true;
+}
+
+void SampleLoader::unifyLayerRates (const SoundSetSource& source, juce::Array<LoadedSample>& samples, int hostRate)
+{
+    const auto isAtHostRate = [hostRate] (const LoadedSample& sample) { return juce::roundToInt (sample.data->getSampleRate()) == hostRate; };
+
+    for (auto& sample : samples)
+    {
+        if (isAtHostRate (sample))
+            continue;
+
+        for (auto& other : samples)
+        {
+            if (! isSameNote (other.info, sample.info) || ! isAtHostRate (other))
+                continue;
+
+            // the pool still has the file if it was loaded before it was converted
+            if (auto data = mSamplePool.getOrLoad (source.files.getReference (other.fileIndex), preloadSeconds, getStorage(),
+                                                   other.keptSeconds))
+                other.data = data;
+        }
+    }
+}
+
+SoundSet::Ptr SampleLoader::buildSet (const SoundSetSource& source, juce::Array<LoadedSample> samples, int maxStretchSemitones, bool isPartial)
+{
+    // back in file order, whatever order they were loaded in
+    std::sort (samples.begin(), samples.end(), [] (const LoadedSample& a, const LoadedSample& b) { return a.fileIndex < b.fileIndex; });
+
+    SoundSet::Ptr set = new SoundSet();
+    set->name = source.name;
+    set->source = source;
+    set->isPartial = isPartial;
+
+    set->source.contentHashes.clearQuick();
+
+    for (int i = 0; i < source.files.size(); ++i)
+        set->source.contentHashes.add ({});
+
+    // one zone per note, a layer per mic. Named after the file of its first mic, which may be played from its copy at the host rate
+    struct ZoneSamples
+    {
+        SampleFileInfo info;
+        juce::Array<SampleZone::Layer> layers;
+        juce::String name;
+        int nameMicPosition;
+        float gain;
+    };
+
+    std::vector<ZoneSamples> zones;
+
+    for (auto& sample : samples)
+    {
+        set->source.contentHashes.set (sample.fileIndex, sample.contentHash);
+
+        const auto isLayerOf = [&sample] (const ZoneSamples& zone)
+        {
+            return isSameNote (zone.info, sample.info)
+                && zone.layers.getFirst().data->getSampleRate() == sample.data->getSampleRate()
+                && std::none_of (zone.layers.begin(), zone.layers.end(), [&sample] (const SampleZone::Layer& layer)
+                                 {
+                                     return layer.micPosition == sample.micPosition;
+                                 });
+        };
+
+        auto zone = std::find_if (zones.begin(), zones.end(), isLayerOf);
+
+        if (zone == zones.end())
+        {
+            zones.push_back ({ sample.info, {}, {}, std::numeric_limits<int>::max(), 1.0f });
+            zone = std::prev (zones.end());
+        }
+
+        zone->layers.add ({ sample.data, sample.micPosition });
+
+        if (sample.micPosition < zone->nameMicPosition)
+        {
+            zone->name = source.files.getReference (sample.fileIndex).getFileName();
+            zone->nameMicPosition = sample.micPosition;
+            zone->gain = sample.gain;
+        }
+    }
+
+    juce::Array<SampleFileInfo> infos;
+    juce::Array<int> soundIndices;
+    juce::StringArray articulations;
+
+    for (auto& zone : zones)
+    {
+        std::sort (zone.layers.begin(), zone.layers.end(), [] (const SampleZone::Layer& a, const SampleZone::Layer& b)
+        {
+            return a.micPosition < b.micPosition;
+        });
+
+        soundIndices.add (set->sounds.size());
+        set->sounds.add (new SampleZone (zone.name, zone.layers, zone.info.rootNote, zone.gain));
+        infos.add (zone.info);
+        articulations.addIfNotAlreadyThere (zone.info.articulation);
+    }
+
+    set->rootNote = infos.getReference (0).rootNote;
+
+    // by name, so an articulation keeps its index whatever order the files came in
+    articulations.sort (true);
+
+    for (auto& articulation : articulations)
+        set->keymaps.add (SampleKeymap::build (articulation, infos, soundIndices, maxStretchSemitones));
+
+    return set;
+}
+
+void SampleLoader::buildMipMaps (const SoundSet& set, const std::function<bool()>& shouldCancel)
+{
+    // the furthest each sound is played above its root, in semitones
+    juce::Array<int> highestInterval;
+    highestInterval.insertMultiple (0, 0, set.sounds.size());
+
+    for (auto* keymap : set.keymaps)
+        for (auto& zone : keymap->getZones())
+            for (int i = 0; i < zone.numAlternates; ++i)
+                if (juce::isPositiveAndBelow ((int) zone.soundIndices[(size_t) i], set.sounds.size()))
+                    highestInterval.set (zone.soundIndices[(size_t) i], juce::jmax (highestInterval[zone.soundIndices[(size_t) i]],
+                                                                                    zone.highNote - zone.rootNote));
+
+    for (int i = 0; i < set.sounds.size(); ++i)
+    {
+        if (shouldCancel())
+            return;
+
+        auto* zone = dynamic_cast<SampleZone*> (set.sounds.getUnchecked (i));
+
+        if (zone == nullptr)
+            continue;
+
+        const auto maxPitchRatio = std::pow (2.0, highestInterval[i] / 12.0) * zone->getSourceSampleRate() / lowestHostSampleRate;
+
+        // the data is shared, so this is a no-op if another zone or instance already built enough levels.
+        // Every mic layer gets as many, the voices read them all from the same level
+        for (int layer = 0; layer < zone->getNumLayers(); ++layer)
+            zone->getLayer (layer).data->buildMipMap (SampleMipMap::getLevelsNeeded (maxPitchRatio), shouldCancel);
+    }
+}
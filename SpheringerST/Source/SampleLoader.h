@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    SampleLoader.h
+    Created: 17 Oct 2026 9:35:02am
+    Author:  jwmao
+
+    Decodes sample files on a background job queue and builds a SoundSet from
+    them, with one keymap per articulation found in the file names. The finished set is handed to onSoundSetLoaded, which is called on
+    the loader thread (never on the audio or message thread).
+
+    The files of a set are decoded several at a time, on a pool of a few
+    threads, in the order of getLoadOrder(). Big sets are published as they
+    come in, a partial set every publishIntervalMs with what has finished so
+    far, so an import of a few hundred files plays long before it's done.
+
+    Every file is trimmed to its note and the zones are brought to the same
+    loudness, from an analysis cached next to the file (see
+    SampleConditioning).
+
+    With a host rate set, files at other rates play from copies converted to
+    it (see SampleRateConverter). Copies made before are loaded instead of
+    the files; the others are converted once the set is playing, on the same
+    threads, and the set is published again with them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SoundSet.h"
+#include "SamplePool.h"
+
+class SampleLoader
+{
+public:
+    explicit SampleLoader (SamplePool& samplePool);
+    ~SampleLoader();
+
+    // queue a single file for loading, it is mapped across the whole keyboard; returns immediately
+    // with what was queued
+    SoundSetSource loadFile (const juce::File& file);
+
+    // queue every audio file in a folder, mapped by their names (see SampleKeymap.h)
+    SoundSetSource loadFolder (const juce::File& folder);
+
+    // queue files and folders as one set, e.g. dropped on the editor: the audio files among them and
+    // in the folders (and their subfolders), mapped by their names. A single file spans the keyboard
+    SoundSetSource loadFiles (const juce::Array<juce::File>& filesAndFolders);
+
+    // whether loadFiles() would find anything to load in this file or folder, by extension only
+    bool canLoad (const juce::File& fileOrFolder) const;
+
+    // queue a set again, e.g. from a saved session. Zones close to the notes in noteUsage are loaded
+    // first, and for bigger sets they're published on their own before the rest is done.
+    void load (const SoundSetSource& source, const NoteUsage& noteUsage = {});
+
+    // stop any pending jobs, waits for a running one to finish
+    void cancelAll();
+
+    // stops the set that's being decoded where it is, without waiting: the files that have loaded are published
+    // as the whole set (its source only lists those), the ones still to come are skipped. Sets queued after it are dropped
+    void stopLoading();
+
+    bool isLoading() const { return mPool.getNumJobs() > 0; }
+
+    // how far the files of the set being decoded (or resampled) have got; both are 0 when nothing is loading.
+    // Its mip levels, loops and peaks are still being worked out for a while after the last file
+    struct Progress
+    {
+        int filesDone = 0;
+        int numFiles = 0;
+        bool resampling = false;
+    };
+
+    // any thread
+    Progress getProgress() const noexcept
+    {
+        const auto packed = mProgress.load (std::memory_order_relaxed);
+        return { (int) (packed >> 32), (int) (packed & 0x7fffffff), (packed & 0x80000000) != 0 };
+    }
+
+    // the rate the sets loaded after this play at, rounded to whole Hz; 0 plays every file at its own rate
+    void setHostSampleRate (double sampleRate) noexcept { mHostSampleRate = juce::roundToInt (sampleRate); }
+    int getHostSampleRate() const noexcept { return mHostSampleRate.load(); }
+
+    // blocks until every queued set (and its mip levels) is done; false on timeout. Not for the message thread of a plugin.
+    bool waitUntilIdle (int timeoutMs) const;
+
+    // called on the loader thread when a set has been built (see also SoundSet::isPartial)
+    std::function<void (SoundSet::Ptr)> onSoundSetLoaded;
+
+    // how the loaded samples' heads and mip levels are kept in memory, for loads started after this
+    void setStorage (SampleStorage storage) noexcept { mStorage = (int) storage; }
+    SampleStorage getStorage() const noexcept { return (SampleStorage) mStorage.load(); }
+
+    // which mic positions to load, bit i for SoundSetSource::getMicPositions()[i], for loads started after this.
+    // Files of the other positions aren't read at all. If that would leave nothing, the first position is loaded.
+    void setMicPositions (juce::uint32 enabledPositions) noexcept { mMicPositions = enabledPositions; }
+    juce::uint32 getMicPositions() const noexcept { return mMicPositions.load(); }
+
+    // called on the loader thread with each line for the log; without it the lines go to std::cout
+    std::function<void (const juce::String&)> onLogMessage;
+
+    // how far the lowest and highest root of a folder may be stretched past the last sample
+    static constexpr int folderStretchSemitones = 12;
+
+    // how much of each sample is kept in memory, the rest is streamed from disk while playing
+    static constexpr double preloadSeconds = 0.5;
+
+    // mip levels are sized for the highest pitch ratio a zone can reach, which is at the lowest host rate we expect
+    static constexpr double lowestHostSampleRate = 44100.0;
+
+    // sets with at least this many files are published while they load, at most this often
+    static constexpr int minFilesForPartialSet = 8;
+    static constexpr int publishIntervalMs = 250;
+
+    // files decoded at once; one core is left to the audio and message threads
+    static constexpr int maxDecodeThreads = 8;
+
+    // what a set's samples take in memory (heads and mip levels), and what they would take as floats
+    struct MemoryUse
+    {
+        juce::int64 bytes = 0;
+        juce::int64 bytesAsFloat = 0;
+        SampleStorage storage = SampleStorage::float32;
+    };
+
+    static MemoryUse getMemoryUse (const SoundSet& set);
+
+private:
+    class LoadJob;
+    class DecodeJob;
+    struct DecodeBatch;
+
+    struct LoadedSample
+    {
+        int fileIndex;
+        SampleData::Ptr data;       // the file's, or its copy at the host rate
+        juce::String contentHash;   // the file's either way
+        SampleFileInfo info;
+        int micPosition;
+        juce::Range<double> keptSeconds;    // of the file, the same for every layer of the note (see SampleConditioning)
+        float gain;                         // shared by all the note's dynamics, from the loudest
+    };
+
+    // loads the source's files in order of getLoadOrder() on the decode pool, publishing partial sets on the way
+    // if it's worth it. Once shouldStop() is true the files that have loaded make up the set
+    SoundSet::Ptr decodeFiles (const SoundSetSource& source, const NoteUsage& noteUsage, const std::function<bool()>& shouldCancel,
+                               const std::function<bool()>& shouldStop);
+
+    // load(i) for i from 0 to numItems - 1 on the decode pool, onDone (i, data, skipped) on this thread as each finishes.
+    // Once shouldSkip() returns true the items that haven't started are skipped. Returns when every item is done
+    void runOnDecodePool (int numItems, const std::function<SampleData::Ptr (int)>& load, const std::function<bool()>& shouldSkip,
+                          const std::function<void (int, SampleData::Ptr, bool)>& onDone);
+
+    // converts the samples that aren't at hostRate on the decode pool, publishing them as they are first, and swaps
+    // the copies in. False if shouldCancel() stopped it; after shouldStop() the rest stay at their own rate
+    bool resampleToHostRate (const SoundSetSource& source, juce::Array<LoadedSample>& samples, int hostRate,
+                             const std::function<bool()>& shouldCancel, const std::function<bool()>& shouldStop);
+
+    // a zone's mic layers play in sync, so a note whose layers aren't all at the host rate plays all of them from their files
+    void unifyLayerRates (const SoundSetSource& source, juce::Array<LoadedSample>& samples, int hostRate);
+
+    // the audio files of a file or folder list, as loadFiles() finds them
+    juce::Array<juce::File> findAudioFiles (const juce::Array<juce::File>& filesAndFolders) const;
+
+    void setProgress (int filesDone, int numFiles, bool resampling = false) noexcept
+    {
+        mProgress.store (((juce::uint64) (juce::uint32) filesDone << 32) | ((juce::uint32) numFiles & 0x7fffffff)
+                          | (resampling ? 0x80000000 : 0), std::memory_order_relaxed);
+    }
+
+    static int getNumDecodeThreads() { return juce::jlimit (1, maxDecodeThreads, juce::SystemStats::getNumCpus() - 1); }
+
+    // file indices, the ones whose roots are nearest to often played notes first
+    static juce::Array<int> getLoadOrder (const SoundSetSource& source, const NoteUsage& noteUsage);
+
+    static SoundSet::Ptr buildSet (const SoundSetSource& source, juce::Array<LoadedSample> samples, int maxStretchSemitones, bool isPartial);
+
+    // builds the octave levels each zone needs for the highest note its keymaps give it, after the set is playing
+    void buildMipMaps (const SoundSet& set, const std::function<bool()>& shouldCancel);
+
+    // then the sustain loops, baked for each of those levels. A zone's other mic layers loop where its first one does
+    void findLoops (const SoundSet& set, const std::function<bool()>& shouldCancel);
+
+    // and the peaks for the editor's waveform view, from the cache next to each file where there is one
+    void loadPeaks (const SoundSet& set, const std::function<bool()>& shouldCancel);
+
+    void logMemoryUse (const SoundSet& set) const;
+
+    void log (const juce::String& message) const;
+
+    SamplePool& mSamplePool;
+    std::atomic<int> mStorage { (int) SampleStorage::float32 };
+    std::atomic<juce::uint32> mMicPositions {1};
+    std::atomic<juce::uint64> mProgress {0};
+    std::atomic<int> mHostSampleRate {0};
+
+    // every load() gets the next number; loads up to mLastStoppedLoad stop where they are
+    std::atomic<juce::uint32> mNumLoadsQueued {0}, mLastStoppedLoad {0};
+
+    // declared last so the jobs are gone before anything they use: the load jobs first, which wait for their decode jobs
+    juce::ThreadPool mDecodePool { getNumDecodeThreads() };
+    juce::ThreadPool mPool {1};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleLoader)
+};
@@ -0,0 +1,321 @@
+/*
+  ==============================================================================
+
+    SampleLoop.cpp
+    Created: 17 Oct 2026 11:18:05pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleLoop.h"
+#include "SamplePool.h"
+
+namespace
+{
+    constexpr double envelopeWindowSeconds = 0.02;
+    constexpr double attackSeconds = 0.15;          // never loop the onset
+    constexpr double maxAnalysisSeconds = 30.0;     // held vowels settle long before this
+    constexpr double minLoopSeconds = 0.25;
+    constexpr double maxLoopSeconds = 4.0;
+    constexpr double maxCrossfadeSeconds = 0.1;
+    constexpr double searchSeconds = 0.01;          // how far from the ideal ends to look for zero crossings
+    constexpr int maxCandidates = 48;
+    constexpr int matchHalfWindow = 512;
+
+    // steady means within 12 dB of the loudest window, and less than 1.5 dB from one window to the next
+    constexpr float minRelativeLevel = 0.25f;
+    constexpr float maxStepDecibels = 1.5f;
+
+    using FrameReader = std::function<void (juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames)>;
+
+    // the first maxAnalysisSeconds of the source, at its full rate
+    juce::AudioBuffer<float> readSource (const SampleData& data)
+    {
+        const auto numFrames = (int) juce::jmin (data.getLengthInSamples(), (juce::int64) (maxAnalysisSeconds * data.getSampleRate()));
+        juce::AudioBuffer<float> source (data.getNumChannels(), numFrames);
+
+        if (data.isMemoryMapped())
+        {
+            data.readMapped (source, 0, 0, numFrames);
+        }
+        else if (auto reader = data.createReader())
+        {
+            reader->read (&source, 0, numFrames, 0, true, true);
+        }
+        else
+        {
+            source.setSize (0, 0);
+        }
+
+        return source;
+    }
+
+    // the longest run of steady windows past the attack, in frames. Empty if there's nothing steady
+    juce::Range<int> findSteadyRegion (const float* mono, int numFrames, double sampleRate)
+    {
+        const auto window = juce::jmax (1, (int) (envelopeWindowSeconds * sampleRate));
+        const auto numWindows = numFrames / window;
+
+        std::vector<float> levels ((size_t) numWindows);
+        float loudest = 0.0f;
+
+        for (int w = 0; w < numWindows; ++w)
+        {
+            double sum = 0.0;
+
+            for (int i = 0; i < window; ++i)
+                sum += (double) mono[w * window + i] * mono[w * window + i];
+
+            levels[(size_t) w] = (float) std::sqrt (sum / window);
+            loudest = juce::jmax (loudest, levels[(size_t) w]);
+        }
+
+        if (loudest <= 0.0f)
+            return {};
+
+        const auto firstWindow = (int) std::ceil (attackSeconds * sampleRate / window);
+        juce::Range<int> best, run;
+
+        for (int w = firstWindow; w < numWindows; ++w)
+        {
+            const auto level = levels[(size_t) w];
+            const auto isLoudEnough = level >= minRelativeLevel * loudest;
+            const auto isSteady = w > firstWindow && run.getLength() > 0
+                                   && std::abs (juce::Decibels::gainToDecibels (level) - juce::Decibels::gainToDecibels (levels[(size_t) w - 1])) < maxStepDecibels;
+
+            if (! isLoudEnough)
+                run = {};
+            else if (isSteady)
+                run.setEnd (w + 1);
+            else
+                run = { w, w + 1 };
+
+            if (run.getLength() > best.getLength())
+                best = run;
+        }
+
+        return { best.getStart() * window, best.getEnd() * window };
+    }
+
+    juce::Array<int> findUpwardZeroCrossings (const float* mono, int from, int to)
+    {
+        juce::Array<int> crossings;
+
+        for (int i = juce::jmax (1, from); i < to && crossings.size() < maxCandidates; ++i)
+            if (mono[i - 1] < 0.0f && mono[i] >= 0.0f)
+                crossings.add (i);
+
+        return crossings;
+    }
+
+    // how alike the audio around a and b is: normalised correlation of the waveforms plus that of
+    // their first differences, which stresses the upper partials. 2 is a perfect match.
+    double getMatch (const float* mono, int a, int b)
+    {
+        double xy = 0.0, xx = 0.0, yy = 0.0;
+        double dxy = 0.0, dxx = 0.0, dyy = 0.0;
+
+        for (int k = -matchHalfWindow; k < matchHalfWindow; ++k)
+        {
+            const double x = mono[a + k], y = mono[b + k];
+            const double dx = x - mono[a + k - 1], dy = y - mono[b + k - 1];
+
+            xy += x * y;    xx += x * x;    yy += y * y;
+            dxy += dx * dy; dxx += dx * dx; dyy += dy * dy;
+        }
+
+        const auto correlation = xx > 0.0 && yy > 0.0 ? xy / std::sqrt (xx * yy) : 0.0;
+        const auto slopeCorrelation = dxx > 0.0 && dyy > 0.0 ? dxy / std::sqrt (dxx * dyy) : 0.0;
+        return correlation + slopeCorrelation;
+    }
+
+    struct LoopPoints
+    {
+        int start = -1, end = -1, crossfade = 0;
+    };
+
+    // the best loop in the source's steady part, start < 0 if there isn't one
+    LoopPoints findLoopPoints (const juce::AudioBuffer<float>& source, double sampleRate, const std::function<bool()>& shouldCancel)
+    {
+        const auto numFrames = source.getNumSamples();
+
+        // the analysis looks at the mid channel only
+        std::vector<float> mono ((size_t) numFrames);
+
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::addWithMultiply (mono.data(), source.getReadPointer (channel),
+                                                          1.0f / (float) source.getNumChannels(), numFrames);
+
+        const auto steady = findSteadyRegion (mono.data(), numFrames, sampleRate);
+
+        // the ideal ends: as long a loop as fits the steady part, leaving room for the match window and the crossfade
+        const auto maxCrossfade = (int) (maxCrossfadeSeconds * sampleRate);
+        const auto search = (int) (searchSeconds * sampleRate);
+
+        const auto idealEnd = steady.getEnd() - matchHalfWindow - search;
+        const auto idealStart = juce::jmax (steady.getStart() + maxCrossfade + matchHalfWindow + search,
+                                            idealEnd - (int) (maxLoopSeconds * sampleRate));
+
+        if (idealEnd - idealStart < (int) (minLoopSeconds * sampleRate))
+            return {};
+
+        const auto starts = findUpwardZeroCrossings (mono.data(), idealStart - search, idealStart + search);
+        const auto ends = findUpwardZeroCrossings (mono.data(), idealEnd - search, idealEnd + search);
+
+        LoopPoints best;
+        double bestMatch = 0.0;
+
+        for (auto start : starts)
+        {
+            if (shouldCancel())
+                return {};
+
+            for (auto end : ends)
+            {
+                const auto match = getMatch (mono.data(), start, end);
+
+                if (match > bestMatch)
+                {
+                    bestMatch = match;
+                    best.start = start;
+                    best.end = end;
+                }
+            }
+        }
+
+        if (best.start >= 0)
+            best.crossfade = juce::jmin (maxCrossfade, (best.end - best.start) / 4);
+
+        return best;
+    }
+
+    // frames [start - preRoll, end) of a level, the last crossfade frames mixed with the ones before start
+    SampleLoop::Level* bakeLevel (const FrameReader& read, int numChannels, juce::int64 start, juce::int64 end,
+                                  int crossfade, SampleStorage storage)
+    {
+        const auto lead = juce::jmax (crossfade, SampleLoop::preRoll);
+        const auto readStart = start - lead;
+        const auto numFrames = (int) (end - readStart);
+
+        juce::AudioBuffer<float> region (numChannels, numFrames);
+        read (region, readStart, numFrames);
+
+        const auto length = (int) (end - start);
+        const auto fadeStart = numFrames - crossfade;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = region.getWritePointer (channel);
+
+            for (int j = 0; j < crossfade; ++j)
+            {
+                // equal power: the two ends are alike, but not in phase all the way through
+                const auto angle = juce::MathConstants<float>::halfPi * ((float) j + 0.5f) / (float) crossfade;
+                const auto i = fadeStart + j;
+
+                data[i] = data[i] * std::cos (angle) + data[i - length] * std::sin (angle);
+            }
+        }
+
+        // only preRoll frames before the start are needed once the crossfade is baked in
+        juce::AudioBuffer<float> kept (region.getArrayOfWritePointers(), numChannels,
+                                       lead - SampleLoop::preRoll, numFrames - (lead - SampleLoop::preRoll));
+
+        return new SampleLoop::Level { start, end, crossfade, CompactAudioBuffer (kept, storage) };
+    }
+}
+
+//==============================================================================
+std::unique_ptr<SampleLoop> SampleLoop::find (const SampleData& data, const std::function<bool()>& shouldCancel, const SampleLoop* pointsFrom)
+{
+    const auto source = readSource (data);
+    const auto numFrames = source.getNumSamples();
+
+    if (numFrames == 0 || shouldCancel())
+        return nullptr;
+
+    LoopPoints points;
+
+    if (pointsFrom != nullptr)
+    {
+        // another mic of the same note: loop exactly where it does, so the layers stay in sync
+        const auto& leader = pointsFrom->getLevel (0);
+
+        if (leader.start - juce::jmax (leader.crossfade, preRoll) < 0 || leader.end > numFrames)
+            return nullptr;
+
+        points = { (int) leader.start, (int) leader.end, leader.crossfade };
+    }
+    else
+    {
+        points = findLoopPoints (source, data.getSampleRate(), shouldCancel);
+    }
+
+    if (points.start < 0 || shouldCancel())
+        return nullptr;
+
+    const auto bestStart = points.start, bestEnd = points.end, crossfade = points.crossfade;
+
+    std::unique_ptr<SampleLoop> loop (new SampleLoop());
+
+    FrameReader readSourceFrames = [&source] (juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int num)
+    {
+        for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+            dest.copyFrom (channel, 0, source, channel, (int) firstFrame, num);
+    };
+
+    loop->mLevels.add (bakeLevel (readSourceFrames, source.getNumChannels(), bestStart, bestEnd, crossfade, data.getStorage()));
+
+    // the same loop on every mip level there is, at that level's rate. Only the start of a level is in memory,
+    // so the loop is decimated from the file the way the streamed rest of the level is
+    if (auto* mipMap = data.getMipMap())
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader;
+
+        if (mipMap->getNumLevels() > 0 && ! data.isMemoryMapped())
+            if ((reader = data.createReader()) == nullptr)
+                return nullptr;
+
+        const auto readFile = SampleMipMap::readerFor (data, reader.get());
+
+        for (int level = 1; level <= mipMap->getNumLevels(); ++level)
+        {
+            if (shouldCancel())
+                return nullptr;
+
+            FrameReader readLevelFrames = [&readFile, &data, level] (juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int num)
+            {
+                SampleMipMap::readLevel (readFile, data.getLengthInSamples(), level, dest, firstFrame, num);
+            };
+
+            const auto divisor = (double) (1 << level);
+
+            loop->mLevels.add (bakeLevel (readLevelFrames, data.getNumChannels(),
+                                          juce::roundToInt (bestStart / divisor), juce::roundToInt (bestEnd / divisor),
+                                          juce::jmax (1, crossfade >> level), data.getStorage()));
+        }
+    }
+
+    return loop;
+}
+
+juce::int64 SampleLoop::getSizeInBytes() const noexcept
+{
+    juce::int64 bytes = 0;
+
+    for (auto* level : mLevels)
+        bytes += level->audio.getSizeInBytes();
+
+    return bytes;
+}
+
+juce::int64 SampleLoop::getSizeAsFloat() const noexcept
+{
+    juce::int64 bytes = 0;
+
+    for (auto* level : mLevels)
+        bytes += level->audio.getSizeAsFloat();
+
+    return bytes;
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    SampleLoop.h
+    Created: 17 Oct 2026 11:18:05pm
+    Author:  jwmao
+
+    Sustain loops for held notes, found by analysing the sample on the loader
+    thread. The search looks for the longest stretch where the level is steady
+    (the held vowel), then puts the loop ends on upward zero crossings whose
+    surroundings match best, both in waveform and in slope (which weighs the
+    upper partials). That way the spectrum doesn't jump at the seam.
+
+    The loop region is kept in memory with an equal-power crossfade baked
+    into its last part: the end fades into the audio just before the loop
+    start, so jumping from the end back to the start is seamless. There is a
+    copy of the region for every mip level too, so transposed notes loop
+    without reading the source.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompactAudioBuffer.h"
+
+class SampleData;
+
+class SampleLoop
+{
+public:
+    // the loop at one rate: level 0 is the source, level k its mip level k
+    struct Level
+    {
+        juce::int64 start = 0;      // first frame of the loop
+        juce::int64 end = 0;        // one past the last, playback continues at start
+        int crossfade = 0;          // frames before end that fade into the ones before start
+
+        // frames [start - preRoll, end), the crossfade baked in
+        CompactAudioBuffer audio;
+
+        juce::int64 getLength() const noexcept { return end - start; }
+        juce::int64 getFirstFrame() const noexcept { return start - preRoll; }
+    };
+
+    // frames kept before the loop start, so interpolation after the jump back never reads outside the buffer
+    static constexpr int preRoll = 16;
+
+    // loader thread: analyses the sample and bakes the loop for the source and each of its mip levels.
+    // Returns nullptr if the sample has no steady part long enough, or if shouldCancel() stopped it.
+    // With pointsFrom (another mic layer's loop) there's no analysis, the loop goes at the same frames.
+    static std::unique_ptr<SampleLoop> find (const SampleData& data, const std::function<bool()>& shouldCancel,
+                                             const SampleLoop* pointsFrom = nullptr);
+
+    // 0 is the source, up to the number of mip levels there were when the loop was found
+    int getNumLevels() const noexcept { return mLevels.size(); }
+    const Level& getLevel (int level) const noexcept { return *mLevels.getUnchecked (level); }
+
+    juce::int64 getSizeInBytes() const noexcept;
+    juce::int64 getSizeAsFloat() const noexcept;
+
+private:
+    SampleLoop() = default;
+
+    juce::OwnedArray<Level> mLevels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleLoop)
+};
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    SampleMipMap.cpp
+    Created: 17 Oct 2026 5:31:12pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleMipMap.h"
+#include "SamplePool.h"
+
+namespace
+{
+    // linear phase lowpass for halving the rate: passband to ~0.84 of the new Nyquist,
+    // Blackman window for ~-58dB at the new Nyquist
+    constexpr int numTaps = 63;
+    constexpr int centreTap = numTaps / 2;
+    constexpr double cutoff = 0.21; // cycles per source frame
+
+    const std::array<float, numTaps>& getDecimationFilter()
+    {
+        static const auto taps = []
+        {
+            constexpr auto pi = juce::MathConstants<double>::pi;
+
+            std::array<float, numTaps> h {};
+            double sum = 0.0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                const auto n = (double) (i - centreTap);
+                const auto x = 2.0 * cutoff * n;
+                const auto sinc = i == centreTap ? 1.0 : std::sin (pi * x) / (pi * x);
+                const auto w = 0.42 - 0.5 * std::cos (2.0 * pi * i / (numTaps - 1)) + 0.08 * std::cos (4.0 * pi * i / (numTaps - 1));
+
+                h[(size_t) i] = (float) (sinc * w);
+                sum += h[(size_t) i];
+            }
+
+            for (auto& tap : h)
+                tap = (float) (tap / sum);
+
+            return h;
+        }();
+
+        return taps;
+    }
+
+    using SourceReader = SampleMipMap::SourceReader;
+
+    // like the reader, but zeros outside the source
+    void readPadded (const SourceReader& read, juce::int64 sourceLength,
+                     juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames)
+    {
+        dest.clear (0, numFrames);
+
+        const auto start = juce::jmax ((juce::int64) 0, firstFrame);
+        const auto end = juce::jmin (sourceLength, firstFrame + numFrames);
+
+        if (end <= start)
+            return;
+
+        juce::AudioBuffer<float> inside (dest.getArrayOfWritePointers(), dest.getNumChannels(),
+                                         (int) (start - firstFrame), (int) (end - start));
+        read (inside, start, (int) (end - start));
+    }
+
+    // halves the rate: out[i] = sum h[j] * in[2i + j - centre], so output frame i lines up with input frame 2i.
+    // Fills dest[0, numOutputs) with the outputs from firstOutput on
+    void decimate (const SourceReader& read, juce::int64 sourceLength,
+                   juce::AudioBuffer<float>& dest, juce::int64 firstOutput, int numOutputs)
+    {
+        constexpr int outputsPerChunk = 16384;
+
+        if (numOutputs <= 0)
+            return;
+
+        const auto& h = getDecimationFilter();
+        const auto numChannels = dest.getNumChannels();
+
+        juce::AudioBuffer<float> input (numChannels, 2 * (juce::jmin (outputsPerChunk, numOutputs) - 1) + numTaps);
+
+        for (int first = 0; first < numOutputs; first += outputsPerChunk)
+        {
+            const auto num = juce::jmin (outputsPerChunk, numOutputs - first);
+            const auto numInputs = 2 * (num - 1) + numTaps;
+
+            readPadded (read, sourceLength, input, 2 * (firstOutput + first) - centreTap, numInputs);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* in = input.getReadPointer (channel);
+                auto* out = dest.getWritePointer (channel, first);
+
+                for (int i = 0; i < num; ++i)
+                {
+                    const auto* x = in + 2 * i;
+                    float sum = 0.0f;
+
+                    for (int j = 0; j < numTaps; ++j)
+                        sum += h[(size_t) j] * x[j];
+
+                    out[i] = sum;
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+std::unique_ptr<SampleMipMap> SampleMipMap::build (const SampleData& data, int numLevels,
+                                                   const std::function<bool()>& shouldCancel)
+{
+    numLevels = juce::jlimit (0, maxLevels, numLevels);
+
+    std::unique_ptr<SampleMipMap> mipMap (new SampleMipMap());
+
+    if (numLevels == 0)
+        return mipMap;
+
+    // from the file, mapped or through a reader of our own
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    if (! data.isMemoryMapped())
+        if ((reader = data.createReader()) == nullptr)
+            return nullptr;
+
+    const auto readFile = readerFor (data, reader.get());
+
+    for (int level = 1; level <= numLevels; ++level)
+    {
+        if (shouldCancel != nullptr && shouldCancel())
+            return nullptr;
+
+        juce::AudioBuffer<float> resident (data.getNumChannels(), getResidentLength (data, level));
+        readLevel (readFile, data.getLengthInSamples(), level, resident, 0, resident.getNumSamples());
+
+        mipMap->mLevels.add (new CompactAudioBuffer (resident, data.getStorage()));
+    }
+
+    return mipMap;
+}
+
+juce::int64 SampleMipMap::getDecimatedLength (juce::int64 sourceLength, int level) noexcept
+{
+    for (int i = 0; i < level; ++i)
+        sourceLength = (sourceLength + 1) / 2;
+
+    return sourceLength;
+}
+
+int SampleMipMap::getResidentLength (const SampleData& data, int level) noexcept
+{
+    return (int) getDecimatedLength (data.getHead().getNumSamples(), level);
+}
+
+SampleMipMap::SourceReader SampleMipMap::readerFor (const SampleData& data, juce::AudioFormatReader* reader)
+{
+    return [&data, reader] (juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames)
+    {
+        if (reader != nullptr)
+            reader->read (&dest, 0, numFrames, firstFrame, true, true);
+        else
+            data.readMapped (dest, 0, firstFrame, numFrames);
+    };
+}
+
+void SampleMipMap::readLevel (const SourceReader& readSource, juce::int64 sourceLength, int level,
+                              juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames)
+{
+    if (level <= 0)
+    {
+        readPadded (readSource, sourceLength, dest, firstFrame, numFrames);
+        return;
+    }
+
+    // each level from the float version of the one before, so the rounding doesn't add up
+    SourceReader readPrevious = [&readSource, sourceLength, level] (juce::AudioBuffer<float>& previous, juce::int64 first, int num)
+    {
+        readLevel (readSource, sourceLength, level - 1, previous, first, num);
+    };
+
+    decimate (readPrevious, getDecimatedLength (sourceLength, level - 1), dest, firstFrame, numFrames);
+}
+
+juce::int64 SampleMipMap::getSizeInBytes() const noexcept
+{
+    juce::int64 bytes = 0;
+
+    for (auto* level : mLevels)
+        bytes += level->getSizeInBytes();
+
+    return bytes;
+}
+
+juce::int64 SampleMipMap::getSizeAsFloat() const noexcept
+{
+    juce::int64 bytes = 0;
+
+    for (auto* level : mLevels)
+        bytes += level->getSizeAsFloat();
+
+    return bytes;
+}
+
+int SampleMipMap::chooseLevel (double pitchRatio, int numLevels) noexcept
+{
+    if (pitchRatio <= juce::MathConstants<double>::sqrt2)
+        return 0;
+
+    return juce::jlimit (0, numLevels, juce::roundToInt (std::log2 (pitchRatio)));
+}
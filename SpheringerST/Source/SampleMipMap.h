@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    SampleMipMap.h
+    Created: 17 Oct 2026 5:31:12pm
+    Author:  jwmao
+
+    Octave-decimated, band-limited copies of a sample. Level k runs at the
+    source rate / 2^k, so a voice playing far above the root reads the level
+    closest to its pitch ratio and stays between 0.7x and 1.4x: no aliasing
+    from skipping source frames, and a fraction of the memory traffic.
+
+    Only the part of each level that covers the sample's preloaded head is
+    kept in memory. The rest streams like the source does: the DiskStreamer
+    reads the file and decimates it on its I/O thread, the same way the
+    resident part was made, so the two join without a seam.
+
+    The levels are built on the loader thread after the sound set has been
+    published; until then voices simply read the source itself.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompactAudioBuffer.h"
+
+class SampleData;
+
+class SampleMipMap
+{
+public:
+    // 16x, the highest pitch ratio a voice will play at
+    static constexpr int maxLevels = 4;
+
+    // fills dest[0, numFrames) with source frames from firstFrame on
+    using SourceReader = std::function<void (juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames)>;
+
+    // builds the resident part of levels 1 to numLevels from the source (loader thread), stored the same way
+    // as the data's head. Returns nullptr if shouldCancel() returned true along the way.
+    static std::unique_ptr<SampleMipMap> build (const SampleData& data, int numLevels,
+                                                const std::function<bool()>& shouldCancel);
+
+    // not counting level 0, which is the source itself
+    int getNumLevels() const noexcept { return mLevels.size(); }
+
+    // the in-memory start of a level, as long as getResidentLength(). level must be between 1 and getNumLevels()
+    const CompactAudioBuffer& getLevel (int level) const noexcept { return *mLevels.getUnchecked (level - 1); }
+
+    //==============================================================================
+    // frames of a level of a source that is sourceLength frames long
+    static juce::int64 getDecimatedLength (juce::int64 sourceLength, int level) noexcept;
+
+    // how much of a level is kept in memory: what covers the same stretch as the source's head
+    static int getResidentLength (const SampleData& data, int level) noexcept;
+
+    // reads a sample's frames through reader, or straight from the mapping if reader is nullptr
+    static SourceReader readerFor (const SampleData& data, juce::AudioFormatReader* reader);
+
+    // fills dest[0, numFrames) with frames of a level from firstFrame on, decimated from the source on the spot
+    // and matching what build() keeps. Allocates, so not on the audio thread; level 0 is the source itself.
+    static void readLevel (const SourceReader& readSource, juce::int64 sourceLength, int level,
+                           juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames);
+
+    juce::int64 getSizeInBytes() const noexcept;
+    juce::int64 getSizeAsFloat() const noexcept;
+
+    // the level that brings a pitch ratio closest to 1, i.e. into [1/sqrt2, sqrt2] when there are enough levels
+    static int chooseLevel (double pitchRatio, int numLevels) noexcept;
+
+    // the number of levels worth building for a zone that plays up to maxPitchRatio
+    static int getLevelsNeeded (double maxPitchRatio) noexcept { return chooseLevel (maxPitchRatio, maxLevels); }
+
+private:
+    SampleMipMap() = default;
+
+    juce::OwnedArray<CompactAudioBuffer> mLevels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleMipMap)
+};
@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    SamplePool.cpp
+    Created: 17 Oct 2026 2:48:03pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SamplePool.h"
+
+namespace
+{
+    // the frames of the file in keptSeconds, all of them if that's empty
+    juce::Range<juce::int64> getKeptFrames (const juce::AudioFormatReader& reader, juce::Range<double> keptSeconds)
+    {
+        const juce::Range<juce::int64> file (0, reader.lengthInSamples);
+
+        if (keptSeconds.isEmpty())
+            return file;
+
+        return file.getIntersectionWith ({ (juce::int64) std::llround (keptSeconds.getStart() * reader.sampleRate),
+                                           (juce::int64) std::llround (keptSeconds.getEnd() * reader.sampleRate) });
+    }
+
+    juce::AudioBuffer<float> readHead (juce::AudioFormatReader& reader, juce::Range<juce::int64> keptFrames, double preloadSeconds)
+    {
+        const auto headLength = (int) juce::jmin (keptFrames.getLength(), (juce::int64) (preloadSeconds * reader.sampleRate));
+        const auto numChannels = juce::jlimit (1, 2, (int) reader.numChannels);
+
+        juce::AudioBuffer<float> head (numChannels, headLength);
+        reader.read (&head, 0, headLength, keptFrames.getStart(), true, true);
+        return head;
+    }
+
+    std::atomic<juce::uint32> nextSampleId {1};
+}
+
+//==============================================================================
+SampleData::SampleData (const juce::File& file,
+                        const juce::String& contentHash,
+                        juce::AudioFormatManager& formatManager,
+                        juce::AudioFormatReader& reader,
+                        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+                        double preloadSeconds,
+                        SampleStorage storage,
+                        juce::Range<double> keptSeconds)
+    : mFile (file),
+      mContentHash (contentHash),
+      mId (nextSampleId++),
+      mFormatManager (formatManager),
+      mSampleRate (reader.sampleRate),
+      mKeptSeconds (keptSeconds),
+      mKeptFrames (getKeptFrames (reader, keptSeconds)),
+      mMappedReader (std::move (mappedReader)),
+      mHead (readHead (reader, mKeptFrames, preloadSeconds), storage)
+{
+}
+
+void SampleData::readMapped (juce::AudioBuffer<float>& dest, int destStart, juce::int64 sourceStart, int numFrames) const
+{
+    jassert (isMemoryMapped());
+
+    // what's been trimmed off reads as silence, as if the file ended there
+    const auto wanted = juce::Range<juce::int64> (sourceStart, sourceStart + numFrames);
+    const auto available = wanted.getIntersectionWith ({ 0, getLengthInSamples() });
+
+    if (available.isEmpty())
+    {
+        dest.clear (destStart, numFrames);
+        return;
+    }
+
+    const auto before = (int) (available.getStart() - sourceStart);
+    const auto after = (int) (wanted.getEnd() - available.getEnd());
+
+    if (before > 0)
+        dest.clear (destStart, before);
+
+    if (after > 0)
+        dest.clear (destStart + numFrames - after, after);
+
+    mMappedReader->read (&dest, destStart + before, (int) available.getLength(), getStartFrame() + available.getStart(), true, true);
+}
+
+std::unique_ptr<juce::AudioFormatReader> SampleData::createReader() const
+{
+    auto reader = createFileReader();
+
+    if (reader == nullptr || mKeptSeconds.isEmpty())
+        return reader;
+
+    const auto start = getStartFrame();
+    const auto length = getLengthInSamples();
+    return std::make_unique<juce::AudioSubsectionReader> (reader.release(), start, length, true);
+}
+
+std::unique_ptr<juce::AudioFormatReader> SampleData::createFileReader() const
+{
+    return std::unique_ptr<juce::AudioFormatReader> (mFormatManager.createReaderFor (mFile));
+}
+
+bool SampleData::buildMipMap (int numLevels, const std::function<bool()>& shouldCancel)
+{
+    numLevels = juce::jlimit (0, SampleMipMap::maxLevels, numLevels);
+
+    // one build at a time, zones of different instances can ask for the same file
+    const juce::ScopedLock sl (mMipMapLock);
+
+    if (auto* current = getMipMap())
+        if (current->getNumLevels() >= numLevels)
+            return true;
+
+    if (numLevels == 0)
+        return true;
+
+    auto mipMap = SampleMipMap::build (*this, numLevels, shouldCancel);
+
+    if (mipMap == nullptr)
+        return false;
+
+    mMipMap.store (mipMap.get(), std::memory_order_release);
+    mMipMaps.add (mipMap.release());
+    return true;
+}
+
+bool SampleData::findLoop (const std::function<bool()>& shouldCancel, const SampleData* leader)
+{
+    const juce::ScopedLock sl (mMipMapLock);
+
+    auto* mipMap = getMipMap();
+    const auto numLevels = mipMap != nullptr ? mipMap->getNumLevels() : 0;
+
+    if (mNumLevelsSearchedForLoop >= numLevels)
+        return true;
+
+    // frames only line up between layers at the same rate, otherwise this one finds its own
+    const auto follows = leader != nullptr && leader != this && leader->getSampleRate() == mSampleRate;
+    auto* pointsFrom = follows ? leader->getLoop() : nullptr;
+
+    std::unique_ptr<SampleLoop> loop;
+
+    if (! follows || pointsFrom != nullptr)
+        loop = SampleLoop::find (*this, shouldCancel, pointsFrom);
+
+    if (shouldCancel())
+        return false;
+
+    mNumLevelsSearchedForLoop = numLevels;
+
+    // no steady part: the sample simply plays to its end
+    if (loop != nullptr)
+    {
+        mLoop.store (loop.get(), std::memory_order_release);
+        mLoops.add (loop.release());
+    }
+
+    return true;
+}
+
+bool SampleData::loadPeaks (const std::function<bool()>& shouldCancel)
+{
+    const juce::ScopedLock sl (mMipMapLock);
+
+    if (mPeakStore != nullptr)
+        return true;
+
+    mPeakStore = WaveformPeaks::loadOrBuild (*this, shouldCancel);
+    mPeaks.store (mPeakStore.get(), std::memory_order_release);
+    return mPeakStore != nullptr;
+}
+
+juce::int64 SampleData::getSizeInMemory() const
+{
+    auto bytes = mHead.getSizeInBytes();
+
+    if (auto* mipMap = getMipMap())
+        bytes += mipMap->getSizeInBytes();
+
+    if (auto* loop = getLoop())
+        bytes += loop->getSizeInBytes();
+
+    return bytes;
+}
+
+juce::int64 SampleData::getSizeAsFloat() const
+{
+    auto bytes = mHead.getSizeAsFloat();
+
+    if (auto* mipMap = getMipMap())
+        bytes += mipMap->getSizeAsFloat();
+
+    if (auto* loop = getLoop())
+        bytes += loop->getSizeAsFloat();
+
+    return bytes;
+}
+
+//==============================================================================
+SamplePool::SamplePool()
+{
+    // allows plugin to use basic audio formats, e.g. .mp3, .wav, ...
+    mFormatManager.registerBasicFormats();
+}
+
+SampleData::Ptr SamplePool::getOrLoad (const juce::File& file, double preloadSeconds, SampleStorage storage,
+                                       juce::Range<double> keptSeconds)
+{
+    const auto hash = computeContentHash (file);
+
+    auto findEntry = [&]() -> SampleData::Ptr
+    {
+        for (auto* entry : mEntries)
+            if (entry->getFile() == file && entry->getContentHash() == hash && entry->getStorage() == storage
+                 && entry->getKeptSeconds() == keptSeconds)
+                return entry;
+
+        return nullptr;
+    };
+
+    {
+        const juce::ScopedLock sl (mLock);
+
+        if (auto existing = findEntry())
+            return existing;
+    }
+
+    // load without holding the lock, so other files can load in parallel
+    std::unique_ptr<juce::AudioFormatReader> reader (mFormatManager.createReaderFor (file));
+
+    if (reader == nullptr)
+        return nullptr;
+
+    // uncompressed WAV/AIFF can be mapped, the other formats return nullptr here
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+
+    if (auto* format = mFormatManager.findFormatForFileExtension (file.getFileExtension()))
+    {
+        mappedReader.reset (format->createMemoryMappedReader (file));
+
+        // maps the address space only, pages are read in when something touches them
+        if (mappedReader != nullptr && ! mappedReader->mapEntireFile())
+            mappedReader.reset();
+    }
+
+    SampleData::Ptr data = new SampleData (file, hash, mFormatManager, *reader, std::move (mappedReader), preloadSeconds, storage,
+                                           keptSeconds);
+
+    const juce::ScopedLock sl (mLock);
+
+    // another instance may have loaded the same file in the meantime
+    if (auto existing = findEntry())
+        return existing;
+
+    mEntries.add (data);
+    return data;
+}
+
+void SamplePool::purgeUnused()
+{
+    const juce::ScopedLock sl (mLock);
+
+    for (int i = mEntries.size(); --i >= 0;)
+        if (mEntries.getUnchecked (i)->getReferenceCount() == 1)
+            mEntries.remove (i);
+}
+
+int SamplePool::getNumEntries() const
+{
+    const juce::ScopedLock sl (mLock);
+    return mEntries.size();
+}
+
+juce::int64 SamplePool::getPreloadedBytes() const
+{
+    const juce::ScopedLock sl (mLock);
+    juce::int64 bytes = 0;
+
+    for (auto* entry : mEntries)
+        bytes += entry->getSizeInMemory();
+
+    return bytes;
+}
+
+juce::int64 SamplePool::getPreloadedBytesAsFloat() const
+{
+    const juce::ScopedLock sl (mLock);
+    juce::int64 bytes = 0;
+
+    for (auto* entry : mEntries)
+        bytes += entry->getSizeAsFloat();
+
+    return bytes;
+}
+
+juce::String SamplePool::computeContentHash (const juce::File& file)
+{
+    constexpr int chunkSize = 65536;
+    const auto fileSize = file.getSize();
+
+    juce::uint64 hash = 14695981039346656037ull;
+
+    auto addBytes = [&hash] (const void* data, size_t numBytes)
+    {
+        auto* bytes = static_cast<const juce::uint8*> (data);
+
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    addBytes (&fileSize, sizeof (fileSize));
+
+    juce::FileInputStream stream (file);
+
+    if (stream.openedOk())
+    {
+        juce::HeapBlock<char> buffer (chunkSize);
+
+        addBytes (buffer, (size_t) juce::jmax (0, stream.read (buffer, chunkSize)));
+
+        if (fileSize > chunkSize && stream.setPosition (juce::jmax ((juce::int64) chunkSize, fileSize - chunkSize)))
+            addBytes (buffer, (size_t) juce::jmax (0, stream.read (buffer, chunkSize)));
+    }
+
+    return juce::String::toHexString ((juce::int64) hash);
+}
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    SamplePool.h
+    Created: 17 Oct 2026 2:48:03pm
+    Author:  jwmao
+
+    Process-wide pool of sample data, shared by every plugin instance through a
+    juce::SharedResourcePointer.
+
+    Entries are keyed by file path plus a content hash, and the part of the
+    file they keep (see SampleConditioning). Uncompressed WAV/AIFF
+    files are memory-mapped, so the streaming threads of all instances read the
+    same pages and only the parts that actually get played become resident.
+    Formats that can't be mapped fall back to one reader per stream.
+
+    What stays in memory (heads and mip levels) can be kept as 16 or 24-bit
+    integers instead of floats, see CompactAudioBuffer. The storage is part of
+    an entry's key, so instances asking for different storage get their own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleMipMap.h"
+#include "SampleLoop.h"
+#include "WaveformPeaks.h"
+
+//==============================================================================
+class SampleData : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SampleData>;
+
+    // keeps keptSeconds of the file (all of it if that's empty) and reads the first preloadSeconds of that into memory.
+    // mappedReader can be nullptr for formats that can't be mapped.
+    SampleData (const juce::File& file,
+                const juce::String& contentHash,
+                juce::AudioFormatManager& formatManager,
+                juce::AudioFormatReader& reader,
+                std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+                double preloadSeconds,
+                SampleStorage storage,
+                juce::Range<double> keptSeconds);
+
+    const juce::File& getFile() const noexcept { return mFile; }
+    const juce::String& getContentHash() const noexcept { return mContentHash; }
+
+    // unique in the process and never 0, for telling samples apart without holding on to them (e.g. voices' playheads)
+    juce::uint32 getId() const noexcept { return mId; }
+
+    double getSampleRate() const noexcept { return mSampleRate; }
+
+    // frames are counted from the start of the part that's kept, and nothing outside it is ever read
+    juce::int64 getLengthInSamples() const noexcept { return mKeptFrames.getLength(); }
+
+    // where in the file that part is; empty seconds for the whole file
+    juce::Range<double> getKeptSeconds() const noexcept { return mKeptSeconds; }
+    juce::int64 getStartFrame() const noexcept { return mKeptFrames.getStart(); }
+    int getNumChannels() const noexcept { return mHead.getNumChannels(); }
+
+    // how the head and the mip levels are kept in memory
+    SampleStorage getStorage() const noexcept { return mHead.getStorage(); }
+
+    // the start of the sample, kept in memory so notes can begin before the stream catches up
+    const CompactAudioBuffer& getHead() const noexcept { return mHead; }
+
+    bool isMemoryMapped() const noexcept { return mMappedReader != nullptr; }
+
+    // I/O or loader thread only: reads straight out of the mapped file, silence outside the kept part. Touching
+    // a page that isn't resident yet waits for the disk, which is why the audio thread never calls this.
+    // The mapped readers keep no state between reads, so any number of threads can share one.
+    void readMapped (juce::AudioBuffer<float>& dest, int destStart, juce::int64 sourceStart, int numFrames) const;
+
+    // for formats that can't be mapped: every stream needs a reader of its own. It reads the kept part only
+    std::unique_ptr<juce::AudioFormatReader> createReader() const;
+
+    // a reader for all of the file, whatever is kept of it
+    std::unique_ptr<juce::AudioFormatReader> createFileReader() const;
+
+    // loader thread: makes sure at least numLevels octave levels exist, building them if needed.
+    // Returns false if shouldCancel() stopped it.
+    bool buildMipMap (int numLevels, const std::function<bool()>& shouldCancel);
+
+    // any thread, nullptr until the first mip map is built. The result stays valid as long as this SampleData.
+    const SampleMipMap* getMipMap() const noexcept { return mMipMap.load (std::memory_order_acquire); }
+
+    // loader thread, after buildMipMap(): looks for a sustain loop and bakes it for every mip level there is.
+    // Does nothing if that was done before with as many levels. Returns false if shouldCancel() stopped it.
+    // A leader is another mic layer of the same zone whose loop was found first: this one loops at the same
+    // frames (and not at all if the leader doesn't), so the layers of a note stay in sync.
+    bool findLoop (const std::function<bool()>& shouldCancel, const SampleData* leader = nullptr);
+
+    // any thread, nullptr if the sample has no loop (or it hasn't been looked for yet). Valid as long as this SampleData.
+    const SampleLoop* getLoop() const noexcept { return mLoop.load (std::memory_order_acquire); }
+
+    // loader thread: reads or builds the peaks for drawing the waveform, once. Returns false if shouldCancel() stopped it.
+    bool loadPeaks (const std::function<bool()>& shouldCancel);
+
+    // any thread, nullptr until loadPeaks() has finished. Valid as long as this SampleData.
+    const WaveformPeaks* getPeaks() const noexcept { return mPeaks.load (std::memory_order_acquire); }
+
+    // the head plus any mip levels and loops, and what they would take as floats
+    juce::int64 getSizeInMemory() const;
+    juce::int64 getSizeAsFloat() const;
+
+private:
+    const juce::File mFile;
+    const juce::String mContentHash;
+    const juce::uint32 mId;
+    juce::AudioFormatManager& mFormatManager;
+
+    double mSampleRate = 44100.0;
+    const juce::Range<double> mKeptSeconds;
+    const juce::Range<juce::int64> mKeptFrames;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mMappedReader;
+    CompactAudioBuffer mHead;
+
+    // a bigger mip map replaces the current one, but voices may still be reading the
+    // old one so it is only deleted with the SampleData
+    juce::CriticalSection mMipMapLock;
+    juce::OwnedArray<SampleMipMap> mMipMaps;
+    std::atomic<const SampleMipMap*> mMipMap {nullptr};
+
+    // the same for loops, found again when the mip map has grown (under mMipMapLock)
+    juce::OwnedArray<SampleLoop> mLoops;
+    std::atomic<const SampleLoop*> mLoop {nullptr};
+    int mNumLevelsSearchedForLoop = -1;
+
+    std::unique_ptr<WaveformPeaks> mPeakStore;
+    std::atomic<const WaveformPeaks*> mPeaks {nullptr};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleData)
+};
+
+//==============================================================================
+class SamplePool
+{
+public:
+    SamplePool();
+
+    // returns the shared entry for the file, loading it if no instance has it yet (loader thread). An entry keeps
+    // keptSeconds of the file, or all of it if that's empty
+    SampleData::Ptr getOrLoad (const juce::File& file, double preloadSeconds, SampleStorage storage,
+                               juce::Range<double> keptSeconds = {});
+
+    // drops entries nobody refers to any more (background thread)
+    void purgeUnused();
+
+    // shared by all instances, only used to create readers so it's safe from any thread
+    juce::AudioFormatManager& getFormatManager() noexcept { return mFormatManager; }
+
+    int getNumEntries() const;
+
+    // heads and mip levels of every entry, and what they would take as floats
+    juce::int64 getPreloadedBytes() const;
+    juce::int64 getPreloadedBytesAsFloat() const;
+
+    // FNV-1a over the file size and its first and last 64kB: cheap enough to run on every load
+    // and it doesn't pull the whole file into memory, but it notices when a file was replaced
+    static juce::String computeContentHash (const juce::File& file);
+
+private:
+    juce::AudioFormatManager mFormatManager;
+
+    juce::CriticalSection mLock;
+    juce::ReferenceCountedArray<SampleData> mEntries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplePool)
+};
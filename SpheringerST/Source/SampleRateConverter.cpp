@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    SampleRateConverter.cpp
+    Created: 18 Oct 2026 11:48:16am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleRateConverter.h"
+#include "SamplePool.h"
+
+namespace
+{
+    const juce::String cacheFolderName ("Spheringer resampled");
+
+    // the kernel's half width in zero crossings of the sinc, and how finely the table samples it
+    constexpr int zeroCrossings = 48;
+    constexpr int stepsPerCrossing = 512;
+
+    // ~-90dB sidelobes. The cutoff sits low enough that the window's transition band ends at Nyquist:
+    // flat to ~0.44 of the (lower) rate
+    constexpr double kaiserBeta = 9.0;
+    constexpr double rolloff = 0.94;
+
+    constexpr int outputsPerChunk = 16384;
+
+    double besselI0 (double x)
+    {
+        // power series, a few dozen terms at most for the betas used here
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 100 && term > sum * 1.0e-15; ++k)
+        {
+            const auto factor = x / (2.0 * k);
+            term *= factor * factor;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // h(u) for u from 0 to zeroCrossings in steps of 1 / stepsPerCrossing, with a 0 after the end so
+    // interpolating between entries never reads past it. At unit rate its taps add up to 1
+    const std::vector<double>& getKernel()
+    {
+        static const auto kernel = []
+        {
+            constexpr auto pi = juce::MathConstants<double>::pi;
+            constexpr int numEntries = zeroCrossings * stepsPerCrossing + 1;
+
+            std::vector<double> h ((size_t) numEntries + 1, 0.0);
+            const auto windowScale = 1.0 / besselI0 (kaiserBeta);
+
+            for (int i = 0; i < numEntries; ++i)
+            {
+                const auto u = (double) i / stepsPerCrossing;
+                const auto x = pi * rolloff * u;
+                const auto sinc = i == 0 ? 1.0 : std::sin (x) / x;
+                const auto r = u / zeroCrossings;
+
+                h[(size_t) i] = rolloff * sinc * besselI0 (kaiserBeta * std::sqrt (juce::jmax (0.0, 1.0 - r * r))) * windowScale;
+            }
+
+            return h;
+        }();
+
+        return kernel;
+    }
+
+    // output frames first to first + numOutputs - 1, at step input frames each, into output from its frame 0.
+    // input holds the input frames from inputStart on, everything outside it counts as zeros
+    void convolve (const juce::AudioBuffer<float>& input, juce::int64 inputStart, juce::AudioBuffer<float>& output,
+                   juce::int64 first, int numOutputs, double step)
+    {
+        // going down, the kernel stretches to low-pass at the new Nyquist
+        const auto& kernel = getKernel();
+        const auto scale = juce::jmin (1.0, 1.0 / step);
+        const auto halfWidth = zeroCrossings / scale;
+        const auto tableScale = scale * stepsPerCrossing;
+        const auto numInputs = input.getNumSamples();
+        const auto numChannels = juce::jmin (input.getNumChannels(), output.getNumChannels());
+
+        std::vector<double> taps ((size_t) (2.0 * halfWidth) + 2);
+
+        for (int i = 0; i < numOutputs; ++i)
+        {
+            // where the output frame falls in the input, and the taps around it
+            const auto t = (double) (first + i) * step - (double) inputStart;
+            const auto lowest = juce::jmax (0, (int) std::ceil (t - halfWidth));
+            const auto highest = juce::jmin (numInputs - 1, (int) std::floor (t + halfWidth));
+            const auto numTaps = juce::jmin ((int) taps.size(), highest - lowest + 1);
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto position = std::abs (t - (double) (lowest + k)) * tableScale;
+                const auto index = juce::jmin ((int) position, zeroCrossings * stepsPerCrossing);
+                const auto fraction = position - (double) index;
+
+                taps[(size_t) k] = scale * (kernel[(size_t) index] + fraction * (kernel[(size_t) index + 1] - kernel[(size_t) index]));
+            }
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* x = input.getReadPointer (channel, lowest);
+                double sum = 0.0;
+
+                for (int k = 0; k < numTaps; ++k)
+                    sum += taps[(size_t) k] * x[k];
+
+                output.setSample (channel, i, (float) sum);
+            }
+        }
+    }
+}
+
+//==============================================================================
+juce::File SampleRateConverter::getCacheFile (const juce::File& sampleFile, const juce::String& contentHash, int sampleRate)
+{
+    return sampleFile.getSiblingFile (cacheFolderName)
+                     .getChildFile (juce::String (sampleRate) + " Hz")
+                     .getChildFile (sampleFile.getFileNameWithoutExtension() + "." + contentHash + ".wav");
+}
+
+bool SampleRateConverter::isCacheFile (const juce::File& file)
+{
+    return file.getParentDirectory().getParentDirectory().getFileName() == cacheFolderName;
+}
+
+bool SampleRateConverter::canWriteCacheFor (const juce::File& sampleFile)
+{
+    const auto cacheFolder = sampleFile.getSiblingFile (cacheFolderName);
+    return cacheFolder.isDirectory() ? cacheFolder.hasWriteAccess() : sampleFile.getParentDirectory().hasWriteAccess();
+}
+
+bool SampleRateConverter::convert (const SampleData& data, const juce::String& contentHash, int sampleRate,
+                                   const std::function<bool()>& shouldCancel)
+{
+    const auto cacheFile = getCacheFile (data.getFile(), contentHash, sampleRate);
+
+    if (cacheFile.existsAsFile())
+        return true;
+
+    if (sampleRate <= 0 || data.getSampleRate() <= 0.0 || ! cacheFile.getParentDirectory().createDirectory().wasOk())
+        return false;
+
+    // all of the file, whatever data keeps of it: the copy is trimmed the same way when it's loaded
+    std::unique_ptr<juce::AudioFormatReader> reader (data.createFileReader());
+
+    if (reader == nullptr)
+        return false;
+
+    // written to a temporary file first, so another instance never maps half a sample
+    juce::TemporaryFile temporary (cacheFile);
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    if (auto output = temporary.getFile().createOutputStream())
+    {
+        writer.reset (juce::WavAudioFormat().createWriterFor (output.get(), sampleRate, (unsigned int) data.getNumChannels(), 32, {}, 0));
+
+        if (writer != nullptr)
+            output.release();
+    }
+
+    if (writer == nullptr)
+        return false;
+
+    const auto numChannels = data.getNumChannels();
+    const auto inputLength = reader->lengthInSamples;
+
+    // output frame n is at input frame n * step
+    const auto ratio = sampleRate / data.getSampleRate();
+    const auto step = 1.0 / ratio;
+    const auto halfWidth = zeroCrossings / juce::jmin (1.0, ratio);
+    const auto outputLength = (juce::int64) std::ceil ((double) inputLength * ratio);
+
+    juce::AudioBuffer<float> input, output (numChannels, outputsPerChunk);
+
+    for (juce::int64 first = 0; first < outputLength; first += outputsPerChunk)
+    {
+        if (shouldCancel())
+            return false;
+
+        const auto numOutputs = (int) juce::jmin ((juce::int64) outputsPerChunk, outputLength - first);
+
+        // every input frame the chunk's kernels reach, zeros outside the sample
+        const auto inputStart = (juce::int64) std::floor ((double) first * step - halfWidth);
+        const auto inputEnd = (juce::int64) std::ceil ((double) (first + numOutputs - 1) * step + halfWidth) + 1;
+        const auto numInputs = (int) (inputEnd - inputStart);
+
+        input.setSize (numChannels, numInputs, false, false, true);
+        input.clear();
+
+        const auto readStart = juce::jmax ((juce::int64) 0, inputStart);
+        const auto readEnd = juce::jmin (inputLength, inputEnd);
+
+        if (readEnd > readStart)
+            reader->read (&input, (int) (readStart - inputStart), (int) (readEnd - readStart), readStart, true, true);
+
+        convolve (input, inputStart, output, first, numOutputs, step);
+
+        if (! writer->writeFromAudioSampleBuffer (output, 0, numOutputs))
+            return false;
+    }
+
+    // the header is only complete once the writer is gone
+    writer.reset();
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+juce::AudioBuffer<float> SampleRateConverter::resample (const juce::AudioBuffer<float>& input, double inputRate, double outputRate)
+{
+    if (inputRate <= 0.0 || outputRate <= 0.0 || inputRate == outputRate)
+        return input;
+
+    const auto ratio = outputRate / inputRate;
+    juce::AudioBuffer<float> output (input.getNumChannels(), (int) std::ceil (input.getNumSamples() * ratio));
+
+    convolve (input, 0, output, 0, output.getNumSamples(), 1.0 / ratio);
+    return output;
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SampleRateConverter.h
+    Created: 18 Oct 2026 11:48:16am
+    Author:  jwmao
+
+    Converts samples to the host's rate ahead of time, so a voice plays a note
+    at its root with a pitch ratio of exactly 1 (a plain copy, see
+    StreamingVoice) and every other note at just its interval, without a
+    rate mismatch folded into every ratio.
+
+    The conversion is a Kaiser-windowed sinc, 48 zero crossings either side
+    (about -90dB in the stopband), low-passed at the lower of the two Nyquist
+    frequencies and read from a finely sampled table. It runs on the loader's
+    threads a chunk at a time, and writes a 32-bit float WAV (so the filter's
+    overshoot on full-scale samples isn't clipped) into a folder next to the
+    sample, one per rate:
+
+        <folder>/Spheringer resampled/48000 Hz/<name>.<content hash>.wav
+
+    The hash is the original's, so a replaced sample is converted again. From
+    then on the copy is just another sample file: shared through the
+    SamplePool, memory-mapped and streamed, with mip levels, loop and peaks
+    of its own. The whole file is converted, whatever is kept of it: the copy
+    is trimmed the same way when it's loaded (see SampleConditioning).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SampleData;
+
+class SampleRateConverter
+{
+public:
+    // where the copy of a sample at a rate goes, whether or not it's there yet
+    static juce::File getCacheFile (const juce::File& sampleFile, const juce::String& contentHash, int sampleRate);
+
+    // true for the copies in those folders, so loading a folder with its subfolders doesn't pick them up
+    static bool isCacheFile (const juce::File& file);
+
+    // whether a copy of the sample can be written next to it, i.e. its folder can be written to
+    static bool canWriteCacheFor (const juce::File& sampleFile);
+
+    // loader thread: writes data's copy at sampleRate unless it's there already. contentHash is the sample file's.
+    // False if the sample couldn't be read, the folder can't be written to, or shouldCancel() stopped it
+    static bool convert (const SampleData& data, const juce::String& contentHash, int sampleRate,
+                         const std::function<bool()>& shouldCancel);
+
+    // the same conversion of a short buffer in memory, e.g. an impulse response; any thread but the audio thread
+    static juce::AudioBuffer<float> resample (const juce::AudioBuffer<float>& input, double inputRate, double outputRate);
+
+private:
+    SampleRateConverter() = delete;
+};
@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    SampleZone.cpp
+    Created: 17 Oct 2026 12:05:37pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SampleZone.h"
+
+SampleZone::SampleZone (const juce::String& name, juce::Array<Layer> layers, int midiRootNote, float gain)
+    : mName (name),
+      mLayers (std::move (layers)),
+      mData (mLayers.getFirst().data),
+      mMidiRootNote (midiRootNote),
+      mGain (gain)
+{
+    jassert (mData != nullptr && mLayers.size() <= maxLayers);
+}
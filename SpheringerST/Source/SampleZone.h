@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    SampleZone.h
+    Created: 17 Oct 2026 12:05:37pm
+    Author:  jwmao
+
+    The sound for one sample file. Only a short head of the file is kept in
+    memory; the rest is streamed from disk by the DiskStreamer while a voice
+    plays, so there is no cap on sample length. The audio itself lives in the
+    process-wide SamplePool, so instances loading the same file share it.
+
+    A zone recorded from several microphone positions has one layer per
+    position (the same note, take and dynamic in files that differ only in
+    their mic prefix). A voice plays all of them in sync and mixes them with
+    the mic levels; the first layer is the one the zone is known by.
+
+    The layers keep only the part of their files from the note's transient to
+    where it has died away. The zone's gain is shared by all the dynamics of
+    its note and brings the loudest of them to the same level as the other
+    notes, so the steps between dynamics stay (see SampleConditioning).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplePool.h"
+
+class SampleZone : public juce::SynthesiserSound
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SampleZone>;
+
+    static constexpr int maxLayers = 4;
+
+    struct Layer
+    {
+        SampleData::Ptr data;
+        int micPosition = 0;    // which mic level applies, 0 .. maxLayers - 1
+    };
+
+    // layers in mic position order, at least one and at most maxLayers
+    SampleZone (const juce::String& name, juce::Array<Layer> layers, int midiRootNote, float gain = 1.0f);
+
+    // the keymap decides which zone plays, so a zone accepts any note it is given
+    bool appliesToNote (int) override { return true; }
+    bool appliesToChannel (int) override { return true; }
+
+    const juce::String& getName() const noexcept { return mName; }
+    const juce::File& getFile() const noexcept { return mData->getFile(); }
+    int getMidiRootNote() const noexcept { return mMidiRootNote; }
+
+    // applies to every layer, so the mic mix stays as it was recorded
+    float getGain() const noexcept { return mGain; }
+
+    int getNumLayers() const noexcept { return mLayers.size(); }
+    const Layer& getLayer (int index) const noexcept { return mLayers.getReference (index); }
+
+    // the first layer's, shared with every other zone (and instance) playing the same file
+    const SampleData& getData() const noexcept { return *mData; }
+    SampleData& getData() noexcept { return *mData; }
+
+    double getSourceSampleRate() const noexcept { return mData->getSampleRate(); }
+    juce::int64 getLengthInSamples() const noexcept { return mData->getLengthInSamples(); }
+    int getNumChannels() const noexcept { return mData->getNumChannels(); }
+
+    // the preloaded start of the sample, playback begins from here while the stream catches up
+    const CompactAudioBuffer& getHead() const noexcept { return mData->getHead(); }
+    int getHeadLength() const noexcept { return mData->getHead().getNumSamples(); }
+
+    // short samples fit in the head completely and never touch the disk
+    bool isFullyLoaded() const noexcept { return getHeadLength() >= getLengthInSamples(); }
+
+private:
+    const juce::String mName;
+    const juce::Array<Layer> mLayers;
+    const SampleData::Ptr mData;
+    const int mMidiRootNote;
+    const float mGain;
+
+    JUCE_LEAK_DETECTOR (SampleZone)
+};
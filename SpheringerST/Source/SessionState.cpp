@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    SessionState.cpp
+    Created: 17 Oct 2026 7:12:40pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SessionState.h"
+
+namespace
+{
+    const int magic = (int) juce::ByteOrder::littleEndianInt ("SPST");
+
+    // anything past these is a corrupt chunk rather than a real session
+    constexpr int maxParameters = 4096;
+    constexpr int maxFiles = 1 << 20;
+}
+
+void SessionState::writeTo (juce::OutputStream& output) const
+{
+    output.writeInt (magic);
+    output.writeInt (currentVersion);
+
+    output.writeCompressedInt (parameterIDs.size());
+
+    for (int i = 0; i < parameterIDs.size(); ++i)
+    {
+        output.writeString (parameterIDs[i]);
+        output.writeFloat (parameterValues[i]);
+    }
+
+    output.writeString (articulation);
+    output.writeCompressedInt (polyphony);
+    output.writeBool (parallelRendering);
+
+    const auto numUsed = (int) std::count_if (noteUsage.begin(), noteUsage.end(), [] (juce::uint32 count) { return count > 0; });
+    output.writeCompressedInt (numUsed);
+
+    for (size_t note = 0; note < noteUsage.size(); ++note)
+    {
+        if (noteUsage[note] > 0)
+        {
+            output.writeByte ((char) note);
+            output.writeCompressedInt ((int) juce::jmin (noteUsage[note], (juce::uint32) std::numeric_limits<int>::max()));
+        }
+    }
+
+    output.writeString (source.name);
+    output.writeCompressedInt (source.maxStretchSemitones);
+    output.writeCompressedInt (source.files.size());
+
+    for (int i = 0; i < source.files.size(); ++i)
+    {
+        output.writeString (source.files.getReference (i).getFullPathName());
+        output.writeString (source.contentHashes[i]);
+    }
+
+    output.writeString (impulseResponse.getFullPathName());
+}
+
+bool SessionState::readFrom (juce::InputStream& input)
+{
+    if (input.readInt() != magic)
+        return false;
+
+    // a newer plugin wrote this, don't guess at what changed
+    if (input.readInt() != currentVersion)
+        return false;
+
+    const auto numParameters = input.readCompressedInt();
+
+    if (! juce::isPositiveAndNotGreaterThan (numParameters, maxParameters))
+        return false;
+
+    parameterIDs.clearQuick();
+    parameterValues.clearQuick();
+
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (input.isExhausted())
+            return false;
+
+        parameterIDs.add (input.readString());
+        parameterValues.add (input.readFloat());
+    }
+
+    articulation = input.readString();
+    polyphony = input.readCompressedInt();
+    parallelRendering = input.readBool();
+
+    noteUsage.fill (0);
+    const auto numUsed = input.readCompressedInt();
+
+    if (! juce::isPositiveAndNotGreaterThan (numUsed, (int) noteUsage.size()))
+        return false;
+
+    for (int i = 0; i < numUsed; ++i)
+    {
+        const auto note = (int) (juce::uint8) input.readByte();
+        const auto count = input.readCompressedInt();
+
+        if (note < (int) noteUsage.size() && count > 0)
+            noteUsage[(size_t) note] = (juce::uint32) count;
+    }
+
+    source = {};
+    source.name = input.readString();
+    source.maxStretchSemitones = input.readCompressedInt();
+
+    const auto numFiles = input.readCompressedInt();
+
+    if (! juce::isPositiveAndNotGreaterThan (numFiles, maxFiles))
+        return false;
+
+    for (int i = 0; i < numFiles; ++i)
+    {
+        if (input.isExhausted())
+            return false;
+
+        const auto path = input.readString();
+        const auto contentHash = input.readString();
+
+        // juce::File asserts on anything else, and a relative path would depend on the host's working folder
+        if (juce::File::isAbsolutePath (path))
+        {
+            source.files.add (juce::File (path));
+            source.contentHashes.add (contentHash);
+        }
+    }
+
+    const auto impulseResponsePath = input.readString();
+    impulseResponse = juce::File::isAbsolutePath (impulseResponsePath) ? juce::File (impulseResponsePath) : juce::File();
+
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    SessionState.h
+    Created: 17 Oct 2026 7:12:40pm
+    Author:  jwmao
+
+    What the plugin saves with a host session, in a small versioned binary
+    format: parameter values, the files the sound set was loaded from (with
+    their content hashes, to notice files that changed) and how often each
+    note was played, so a reload can start with the zones that matter.
+
+    Layout (version 1), all integers little-endian:
+        int32   magic 'SPST'
+        int32   version
+        cint    number of parameters, then per parameter: string ID, float value
+        string  articulation name
+        cint    polyphony, byte parallel rendering
+        cint    number of used notes, then per note: byte note, cint count
+        string  set name, cint max stretch
+        cint    number of files, then per file: string path, string content hash
+        string  impulse response path, empty for none
+
+    cint is juce::OutputStream::writeCompressedInt(), strings are UTF-8.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SoundSet.h"
+
+struct SessionState
+{
+    static constexpr int currentVersion = 1;
+
+    juce::StringArray parameterIDs;
+    juce::Array<float> parameterValues;
+
+    // by name: its index depends on which files the set has. Empty for the set's first one
+    juce::String articulation;
+    int polyphony = 32;
+    bool parallelRendering = false;
+
+    NoteUsage noteUsage {};
+    SoundSetSource source;
+
+    // the convolution reverb's, none if it's the default File
+    juce::File impulseResponse;
+
+    void writeTo (juce::OutputStream& output) const;
+
+    // false if the data isn't a state this version can read, which leaves this in an unspecified state
+    bool readFrom (juce::InputStream& input);
+};
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    SoundSet.cpp
+    Created: 17 Oct 2026 9:02:11am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SoundSet.h"
+
+juce::StringArray SoundSetSource::getMicPositions() const
+{
+    juce::StringArray positions;
+
+    for (auto& file : files)
+        positions.addIfNotAlreadyThere (SampleFileInfo::fromFile (file).micPosition);
+
+    return positions;
+}
+
+//==============================================================================
+SoundSetExchange::~SoundSetExchange()
+{
+    // audio has stopped by now, so everything can simply be released
+    if (auto* pending = mPending.exchange (nullptr))
+        pending->decReferenceCount();
+
+    if (mCurrent != nullptr)
+        mCurrent->decReferenceCount();
+
+    mRetireFifo.read (mRetireFifo.getNumReady()).forEach ([this] (int index)
+    {
+        mRetired.add (mRetireQueue[(size_t) index]);
+    });
+
+    for (auto* set : mRetired)
+        set->decReferenceCount();
+}
+
+void SoundSetExchange::publish (SoundSet::Ptr newSet)
+{
+    // publish an empty set rather than nullptr to unload everything
+    jassert (newSet != nullptr);
+
+    mNumPublishedSounds = newSet->sounds.size();
+
+    // the exchange keeps its own reference until the set is retired
+    auto* set = newSet.get();
+    set->incReferenceCount();
+
+    // a set that is still pending was never seen by the audio thread, so it can go straight away
+    if (auto* stale = mPending.exchange (set, std::memory_order_acq_rel))
+        stale->decReferenceCount();
+}
+
+SoundSet* SoundSetExchange::acquire() noexcept
+{
+    // if the retire queue is full, keep playing the current set and try again next block
+    if (mPending.load (std::memory_order_relaxed) == nullptr || mRetireFifo.getFreeSpace() == 0)
+        return mCurrent;
+
+    if (auto* next = mPending.exchange (nullptr, std::memory_order_acq_rel))
+    {
+        if (mCurrent != nullptr)
+        {
+            mRetireFifo.write (1).forEach ([this] (int index)
+            {
+                mRetireQueue[(size_t) index] = mCurrent;
+            });
+        }
+
+        mCurrent = next;
+    }
+
+    return mCurrent;
+}
+
+int SoundSetExchange::useTimeSlice()
+{
+    mRetireFifo.read (mRetireFifo.getNumReady()).forEach ([this] (int index)
+    {
+        mRetired.add (mRetireQueue[(size_t) index]);
+    });
+
+    // a retired set is never played from again, so once its sounds are only referenced
+    // by the set itself no voice can pick them up and it is safe to delete it here
+    bool anyFreed = false;
+
+    for (int i = mRetired.size(); --i >= 0;)
+    {
+        auto* set = mRetired.getUnchecked (i);
+
+        if (set->isUnused())
+        {
+            mRetired.remove (i);
+            set->decReferenceCount();
+            anyFreed = true;
+        }
+    }
+
+    if (anyFreed && onSetsFreed != nullptr)
+        onSetsFreed();
+
+    return mRetired.isEmpty() ? 100 : 20; // ms until we want to be called again
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SoundSet.h
+    Created: 17 Oct 2026 9:02:11am
+    Author:  jwmao
+
+    A SoundSet is everything the sampler plays from: the sounds built by the
+    loader for one file (or one folder) and the keymaps that say which sound
+    plays for a note and velocity. Sets are built on a background thread
+    and handed over to the audio thread through a SoundSetExchange, which never
+    locks and never frees memory on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleKeymap.h"
+
+//==============================================================================
+// what a set is loaded from: enough to load it again, so it's what gets saved with a session
+struct SoundSetSource
+{
+    juce::String name;
+    juce::Array<juce::File> files;
+
+    // one per file once it has been loaded, empty where it isn't known (yet)
+    juce::StringArray contentHashes;
+
+    // how far the outermost roots are stretched across the keyboard, see SampleKeymap::build()
+    int maxStretchSemitones = 127;
+
+    bool isEmpty() const noexcept { return files.isEmpty(); }
+
+    // the mic prefixes of the files (see SampleKeymap.h), each once, in the order they first appear.
+    // Mic level i applies to the i-th; files without a prefix count as one position of their own.
+    juce::StringArray getMicPositions() const;
+};
+
+// how often each MIDI note has been played, used to load the zones that matter most first
+using NoteUsage = std::array<juce::uint32, 128>;
+
+//==============================================================================
+class SoundSet : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SoundSet>;
+
+    juce::String name;
+    int rootNote = 60; // MIDI root of the first loaded sample
+
+    // what the set was loaded from, with the content hashes of the files that loaded
+    SoundSetSource source;
+
+    // true for the stand-in the loader publishes while the rest of a big set is still loading
+    bool isPartial = false;
+    juce::ReferenceCountedArray<juce::SynthesiserSound> sounds;
+
+    // one keymap per articulation, sorted by name, all pointing into sounds
+    juce::OwnedArray<SampleKeymap> keymaps;
+
+    // the keymaps' articulation names, in their order
+    juce::StringArray getArticulations() const
+    {
+        juce::StringArray names;
+
+        for (auto* keymap : keymaps)
+            names.add (keymap->getArticulation());
+
+        return names;
+    }
+
+    const SampleKeymap* getKeymap (int articulationIndex) const noexcept
+    {
+        if (keymaps.isEmpty())
+            return nullptr;
+
+        return keymaps.getUnchecked (juce::jlimit (0, keymaps.size() - 1, articulationIndex));
+    }
+
+    // true once only this set is holding on to its sounds,
+    // i.e. no voice is still playing any of them
+    bool isUnused() const noexcept
+    {
+        for (auto* sound : sounds)
+            if (sound->getReferenceCount() > 1)
+                return false;
+
+        return true;
+    }
+};
+
+//==============================================================================
+/*
+    Hands SoundSets from the loader to the audio thread.
+
+    publish() can be called from any non-audio thread, acquire() is called once per
+    block by the audio thread. The set that gets replaced is pushed onto a retire
+    queue, and useTimeSlice() (on a background TimeSliceThread) deletes it once no
+    voice refers to any of its sounds any more.
+*/
+class SoundSetExchange : public juce::TimeSliceClient
+{
+public:
+    SoundSetExchange() = default;
+    ~SoundSetExchange() override;
+
+    // loader / message thread: queue a new set for the audio thread
+    void publish (SoundSet::Ptr newSet);
+
+    // audio thread: swap in a newly published set if there is one and return the
+    // set to play from in this block (can be nullptr before anything was loaded)
+    SoundSet* acquire() noexcept;
+
+    // audio thread only
+    SoundSet* getCurrent() const noexcept { return mCurrent; }
+
+    // safe from any thread
+    int getNumPublishedSounds() const noexcept { return mNumPublishedSounds.load(); }
+
+    // background thread: free retired sets that are no longer in use
+    int useTimeSlice() override;
+
+    // called on the background thread after sets have been freed
+    std::function<void()> onSetsFreed;
+
+private:
+    std::atomic<SoundSet*> mPending {nullptr};
+    SoundSet* mCurrent {nullptr};
+    std::atomic<int> mNumPublishedSounds {0};
+
+    // sets retired by the audio thread, waiting for the background thread to pick them up
+    static constexpr int retireQueueSize = 32;
+    juce::AbstractFifo mRetireFifo {retireQueueSize};
+    std::array<SoundSet*, retireQueueSize> mRetireQueue {};
+
+    // sets that the background thread is waiting on (background thread only)
+    juce::Array<SoundSet*> mRetired;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SoundSetExchange)
+};
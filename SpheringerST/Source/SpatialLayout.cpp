@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    SpatialLayout.cpp
+    Created: 18 Oct 2026 10:31:07am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SpatialLayout.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define SPHERINGER_USE_NEON 1
+#endif
+
+namespace
+{
+    using ChannelType = juce::AudioChannelSet::ChannelType;
+
+    struct Direction
+    {
+        ChannelType type;
+        float azimuth, elevation;
+    };
+
+    // the usual placements (ITU-R BS.775 and Dolby's for the height speakers), counterclockwise from the front
+    const Direction speakerDirections[] =
+    {
+        { juce::AudioChannelSet::left,                30.0f,  0.0f },
+        { juce::AudioChannelSet::right,              -30.0f,  0.0f },
+        { juce::AudioChannelSet::centre,               0.0f,  0.0f },
+        { juce::AudioChannelSet::leftSurround,       110.0f,  0.0f },
+        { juce::AudioChannelSet::rightSurround,     -110.0f,  0.0f },
+        { juce::AudioChannelSet::leftSurroundSide,    90.0f,  0.0f },
+        { juce::AudioChannelSet::rightSurroundSide,  -90.0f,  0.0f },
+        { juce::AudioChannelSet::leftSurroundRear,   150.0f,  0.0f },
+        { juce::AudioChannelSet::rightSurroundRear, -150.0f,  0.0f },
+        { juce::AudioChannelSet::topFrontLeft,        45.0f, 45.0f },
+        { juce::AudioChannelSet::topFrontRight,      -45.0f, 45.0f },
+        { juce::AudioChannelSet::topRearLeft,        135.0f, 45.0f },
+        { juce::AudioChannelSet::topRearRight,      -135.0f, 45.0f }
+    };
+
+    // elevation at which a source has moved completely into the height ring; above it, the source
+    // spreads over the whole ring until it's on all of it equally, straight overhead
+    constexpr float heightElevation = 45.0f;
+
+    // dest += left * (leftGain + leftStep * i) + right * (rightGain + rightStep * i)
+    void addRamped (float* dest, const float* left, const float* right, float leftGain, float leftStep,
+                    float rightGain, float rightStep, int numSamples) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_INTEL
+        const auto offsets = _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f);
+        const auto leftSteps = _mm_set1_ps (leftStep);
+        const auto rightSteps = _mm_set1_ps (rightStep);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const auto index = _mm_add_ps (_mm_set1_ps ((float) i), offsets);
+            const auto l = _mm_add_ps (_mm_set1_ps (leftGain), _mm_mul_ps (leftSteps, index));
+            const auto r = _mm_add_ps (_mm_set1_ps (rightGain), _mm_mul_ps (rightSteps, index));
+
+            auto sum = _mm_add_ps (_mm_loadu_ps (dest + i), _mm_mul_ps (_mm_loadu_ps (left + i), l));
+            sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (right + i), r));
+            _mm_storeu_ps (dest + i, sum);
+        }
+       #elif SPHERINGER_USE_NEON
+        const float offsetValues[] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const auto offsets = vld1q_f32 (offsetValues);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const auto index = vaddq_f32 (vdupq_n_f32 ((float) i), offsets);
+            const auto l = vmlaq_f32 (vdupq_n_f32 (leftGain), vdupq_n_f32 (leftStep), index);
+            const auto r = vmlaq_f32 (vdupq_n_f32 (rightGain), vdupq_n_f32 (rightStep), index);
+
+            auto sum = vmlaq_f32 (vld1q_f32 (dest + i), vld1q_f32 (left + i), l);
+            sum = vmlaq_f32 (sum, vld1q_f32 (right + i), r);
+            vst1q_f32 (dest + i, sum);
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+            dest[i] += left[i] * (leftGain + leftStep * (float) i) + right[i] * (rightGain + rightStep * (float) i);
+    }
+}
+
+//==============================================================================
+void SpatialLayout::Gains::interpolate (const Gains& a, const Gains& b, float proportion, Gains& result) noexcept
+{
+    for (size_t channel = 0; channel < (size_t) maxChannels; ++channel)
+    {
+        result.left[channel] = a.left[channel] + (b.left[channel] - a.left[channel]) * proportion;
+        result.right[channel] = a.right[channel] + (b.right[channel] - a.right[channel]) * proportion;
+    }
+}
+
+//==============================================================================
+SpatialLayout::SpatialLayout (const juce::AudioChannelSet& channels)
+{
+    if (! isSupported (channels) || channels.size() <= 2)
+        return;
+
+    mNumChannels = channels.size();
+
+    if (const auto order = channels.getAmbisonicOrder(); order > 0)
+    {
+        mKind = Kind::ambisonic;
+        mAmbisonicOrder = order;
+
+        // cardioids to the left and right: half the omni plus or minus half the left-right figure of eight
+        mToLeft[0] = mToRight[0] = 0.5f;
+        mToLeft[1] = 0.5f;
+        mToRight[1] = -0.5f;
+        return;
+    }
+
+    mKind = Kind::speakers;
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+    {
+        const auto type = channels.getTypeOfChannel (channel);
+        const auto* direction = std::find_if (std::begin (speakerDirections), std::end (speakerDirections),
+                                              [type] (const Direction& d) { return d.type == type; });
+
+        // the LFE channel gets nothing
+        if (direction == std::end (speakerDirections))
+            continue;
+
+        if (direction->elevation > 0.0f)
+            mHeight[(size_t) mNumHeight++] = { direction->azimuth, channel };
+        else
+            mEarLevel[(size_t) mNumEarLevel++] = { direction->azimuth, channel };
+
+        const auto side = std::sin (juce::degreesToRadians (direction->azimuth));
+        mToLeft[(size_t) channel] = 0.5f * (1.0f + side);
+        mToRight[(size_t) channel] = 0.5f * (1.0f - side);
+    }
+
+    const auto byAzimuth = [] (const Speaker& a, const Speaker& b) { return a.azimuth < b.azimuth; };
+    std::sort (mEarLevel.begin(), mEarLevel.begin() + mNumEarLevel, byAzimuth);
+    std::sort (mHeight.begin(), mHeight.begin() + mNumHeight, byAzimuth);
+}
+
+bool SpatialLayout::isSupported (const juce::AudioChannelSet& channels)
+{
+    if (channels == juce::AudioChannelSet::mono() || channels == juce::AudioChannelSet::stereo())
+        return true;
+
+    if (const auto order = channels.getAmbisonicOrder(); order > 0)
+        return order <= maxAmbisonicOrder;
+
+    return channels == juce::AudioChannelSet::quadraphonic()
+        || channels == juce::AudioChannelSet::create5point1()
+        || channels == juce::AudioChannelSet::create7point1()
+        || channels == juce::AudioChannelSet::create7point1point4();
+}
+
+//==============================================================================
+void SpatialLayout::computeGains (float azimuth, float elevation, float width, Gains& gains) const noexcept
+{
+    gains.left.fill (0.0f);
+    gains.right.fill (0.0f);
+
+    if (! isSpatial())
+        return;
+
+    addPointGains (azimuth + 0.5f * width, elevation, gains.left.data());
+    addPointGains (azimuth - 0.5f * width, elevation, gains.right.data());
+}
+
+void SpatialLayout::addPointGains (float azimuth, float elevation, float* gains) const noexcept
+{
+    if (mKind == Kind::ambisonic)
+    {
+        const auto a = juce::degreesToRadians (azimuth);
+        const auto e = juce::degreesToRadians (juce::jlimit (-90.0f, 90.0f, elevation));
+
+        const auto x = std::cos (e) * std::cos (a);
+        const auto y = std::cos (e) * std::sin (a);
+        const auto z = std::sin (e);
+
+        // real spherical harmonics in ACN order, SN3D normalised, written out in x / y / z
+        gains[0] += 1.0f;
+
+        gains[1] += y;
+        gains[2] += z;
+        gains[3] += x;
+
+        if (mAmbisonicOrder >= 2)
+        {
+            const auto sqrt3 = std::sqrt (3.0f);
+
+            gains[4] += sqrt3 * x * y;
+            gains[5] += sqrt3 * y * z;
+            gains[6] += 0.5f * (3.0f * z * z - 1.0f);
+            gains[7] += sqrt3 * x * z;
+            gains[8] += 0.5f * sqrt3 * (x * x - y * y);
+        }
+
+        if (mAmbisonicOrder >= 3)
+        {
+            const auto sqrt15 = std::sqrt (15.0f);
+            const auto sqrt5over8 = std::sqrt (5.0f / 8.0f);
+            const auto sqrt3over8 = std::sqrt (3.0f / 8.0f);
+
+            gains[9]  += sqrt5over8 * y * (3.0f * x * x - y * y);
+            gains[10] += sqrt15 * x * y * z;
+            gains[11] += sqrt3over8 * y * (5.0f * z * z - 1.0f);
+            gains[12] += 0.5f * z * (5.0f * z * z - 3.0f);
+            gains[13] += sqrt3over8 * x * (5.0f * z * z - 1.0f);
+            gains[14] += 0.5f * sqrt15 * z * (x * x - y * y);
+            gains[15] += sqrt5over8 * x * (x * x - 3.0f * y * y);
+        }
+
+        return;
+    }
+
+    // up into the height ring if there is one, the two rings crossfaded at constant power
+    const auto height = mNumHeight > 0 ? juce::jlimit (0.0f, 1.0f, elevation / heightElevation) : 0.0f;
+    const auto angle = height * juce::MathConstants<float>::halfPi;
+
+    panAroundRing (mEarLevel.data(), mNumEarLevel, azimuth, std::cos (angle), gains);
+
+    if (height <= 0.0f)
+        return;
+
+    std::array<float, maxChannels> ring {};
+    panAroundRing (mHeight.data(), mNumHeight, azimuth, 1.0f, ring.data());
+
+    const auto overhead = juce::jlimit (0.0f, 1.0f, (elevation - heightElevation) / (90.0f - heightElevation));
+
+    if (overhead > 0.0f)
+    {
+        float power = 0.0f;
+
+        for (int i = 0; i < mNumHeight; ++i)
+        {
+            auto& gain = ring[(size_t) mHeight[(size_t) i].channel];
+            gain += (1.0f - gain) * overhead;
+            power += gain * gain;
+        }
+
+        for (auto& gain : ring)
+            gain /= std::sqrt (power);
+    }
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+        gains[channel] += ring[(size_t) channel] * std::sin (angle);
+}
+
+void SpatialLayout::panAroundRing (const Speaker* ring, int numSpeakers, float azimuth, float gain, float* gains) noexcept
+{
+    if (numSpeakers == 0)
+        return;
+
+    if (numSpeakers == 1)
+    {
+        gains[ring[0].channel] += gain;
+        return;
+    }
+
+    // 0 .. 360
+    const auto wrap = [] (float degrees) { return degrees - 360.0f * std::floor (degrees / 360.0f); };
+
+    // the pair the source falls between, counterclockwise from the first to the second
+    for (int i = 0; i < numSpeakers; ++i)
+    {
+        const auto& from = ring[i];
+        const auto& to = ring[(i + 1) % numSpeakers];
+        const auto span = wrap (to.azimuth - from.azimuth);
+        const auto offset = wrap (azimuth - from.azimuth);
+
+        if (offset <= span || i == numSpeakers - 1)
+        {
+            const auto proportion = span > 0.0f ? juce::jlimit (0.0f, 1.0f, offset / span) : 0.0f;
+            const auto angle = proportion * juce::MathConstants<float>::halfPi;
+
+            gains[from.channel] += gain * std::cos (angle);
+            gains[to.channel] += gain * std::sin (angle);
+            return;
+        }
+    }
+}
+
+//==============================================================================
+void SpatialLayout::encode (juce::AudioBuffer<float>& dest, int destStart, const float* left, const float* right, int numSamples,
+                            const Gains& from, const Gains& to, float gain) const noexcept
+{
+    jassert (dest.getNumChannels() >= mNumChannels);
+
+    if (numSamples <= 0)
+        return;
+
+    const auto stepScale = gain / (float) numSamples;
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+    {
+        const auto c = (size_t) channel;
+        const auto leftGain = from.left[c] * gain;
+        const auto rightGain = from.right[c] * gain;
+        const auto leftStep = (to.left[c] - from.left[c]) * stepScale;
+        const auto rightStep = (to.right[c] - from.right[c]) * stepScale;
+
+        // the LFE, speakers away from the source, harmonics that are zero in its direction
+        if (leftGain == 0.0f && rightGain == 0.0f && leftStep == 0.0f && rightStep == 0.0f)
+            continue;
+
+        addRamped (dest.getWritePointer (channel, destStart), left, right, leftGain, leftStep, rightGain, rightStep, numSamples);
+    }
+}
+
+void SpatialLayout::downmixToStereo (const juce::AudioBuffer<float>& source, int sourceStart,
+                                     juce::AudioBuffer<float>& stereo, int stereoStart, int numSamples) const noexcept
+{
+    jassert (stereo.getNumChannels() >= 2);
+
+    stereo.clear (0, stereoStart, numSamples);
+    stereo.clear (1, stereoStart, numSamples);
+
+    for (int channel = 0; channel < juce::jmin (mNumChannels, source.getNumChannels()); ++channel)
+    {
+        const auto* input = source.getReadPointer (channel, sourceStart);
+
+        if (mToLeft[(size_t) channel] != 0.0f)
+            juce::FloatVectorOperations::addWithMultiply (stereo.getWritePointer (0, stereoStart), input, mToLeft[(size_t) channel], numSamples);
+
+        if (mToRight[(size_t) channel] != 0.0f)
+            juce::FloatVectorOperations::addWithMultiply (stereo.getWritePointer (1, stereoStart), input, mToRight[(size_t) channel], numSamples);
+    }
+}
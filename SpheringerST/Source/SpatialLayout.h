@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    SpatialLayout.h
+    Created: 18 Oct 2026 10:31:07am
+    Author:  jwmao
+
+    Where the voices go on output buses wider than stereo. Every voice sits
+    at an azimuth and elevation, and its two channels are encoded into the
+    bus with a gain per output channel and side:
+
+        Ambisonics, order 1 to 3    ACN channel order, SN3D (AmbiX), so a
+                                    third-order bus has 16 channels
+        quad, 5.1, 7.1, 7.1.4       pair-wise constant-power panning around
+                                    the ear-level ring, crossfaded into the
+                                    height ring with elevation; LFE is left
+                                    to the host's bass management
+
+    The gains only depend on the position, so voices work them out when
+    their position changes and otherwise just apply them: one pass over each
+    output channel, ramping when the position moved this block.
+
+    Mono and stereo buses aren't spatial, the samples play as they are.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SpatialLayout
+{
+public:
+    static constexpr int maxChannels = 16;  // third-order Ambisonics
+    static constexpr int maxAmbisonicOrder = 3;
+
+    // what a stereo source adds to the bus: channel c gets left * left[c] + right * right[c]
+    struct Gains
+    {
+        std::array<float, maxChannels> left {}, right {};
+
+        // a + (b - a) * proportion, for ramps that span several chunks
+        static void interpolate (const Gains& a, const Gains& b, float proportion, Gains& result) noexcept;
+    };
+
+    // stereo
+    SpatialLayout() = default;
+
+    // anything isSupported() turns down ends up as stereo
+    explicit SpatialLayout (const juce::AudioChannelSet& channels);
+
+    // mono, stereo, Ambisonics up to maxAmbisonicOrder, quad, 5.1, 7.1 and 7.1.4
+    static bool isSupported (const juce::AudioChannelSet& channels);
+
+    bool isSpatial() const noexcept { return mKind != Kind::stereo; }
+    int getNumChannels() const noexcept { return mNumChannels; }
+
+    // a stereo source centred on azimuth / elevation, its two sides width apart. Degrees; azimuth
+    // counterclockwise from the front (positive is left), elevation positive upwards
+    void computeGains (float azimuth, float elevation, float width, Gains& gains) const noexcept;
+
+    // audio thread: adds left / right times gain to dest's channels, the encoding gains ramping from `from`
+    // to `to` across numSamples. dest must have getNumChannels() channels
+    void encode (juce::AudioBuffer<float>& dest, int destStart, const float* left, const float* right, int numSamples,
+                 const Gains& from, const Gains& to, float gain) const noexcept;
+
+    // audio thread: a stereo picture of a spatial bus (virtual cardioids to the sides for Ambisonics,
+    // speakers weighted by how far left or right they are), e.g. to feed a stereo effect
+    void downmixToStereo (const juce::AudioBuffer<float>& source, int sourceStart,
+                          juce::AudioBuffer<float>& stereo, int stereoStart, int numSamples) const noexcept;
+
+private:
+    enum class Kind
+    {
+        stereo,
+        ambisonic,
+        speakers
+    };
+
+    struct Speaker
+    {
+        float azimuth;  // degrees
+        int channel;
+    };
+
+    // gains of a point source, added into gains (one per channel)
+    void addPointGains (float azimuth, float elevation, float* gains) const noexcept;
+
+    // constant-power pair panning around a ring of speakers sorted by azimuth
+    static void panAroundRing (const Speaker* ring, int numSpeakers, float azimuth, float gain, float* gains) noexcept;
+
+    Kind mKind = Kind::stereo;
+    int mNumChannels = 2;
+    int mAmbisonicOrder = 0;
+
+    // speakers only; LFE is in neither ring. Fixed size, so voices can keep a copy without allocating
+    std::array<Speaker, maxChannels> mEarLevel {}, mHeight {};
+    int mNumEarLevel = 0, mNumHeight = 0;
+
+    // per channel, for downmixToStereo()
+    std::array<float, maxChannels> mToLeft {}, mToRight {};
+};
@@ -0,0 +1,450 @@
+/*
+  ==============================================================================
+
+    SpheringerSynth.cpp
+    Created: 17 Oct 2026 9:20:45am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "SpheringerSynth.h"
+
+SpheringerSynth::SpheringerSynth()
+{
+    // the audio thread reads the voices through this storage while the pool grows, so it has to be all there now
+    voices.ensureStorageAllocated (maxPolyphony);
+    mActiveVoices.ensureStorageAllocated (maxPolyphony);
+}
+
+SpheringerSynth::~SpheringerSynth()
+{
+    // stop the workers before the voices they render go away
+    mRenderPool.reset();
+}
+
+void SpheringerSynth::updateVoiceSettings (const juce::ADSR::Parameters& envelope, InterpolationQuality quality) noexcept
+{
+    auto& current = mVoiceSettings.envelope;
+
+    if (quality == mVoiceSettings.quality
+         && envelope.attack == current.attack && envelope.decay == current.decay
+         && envelope.sustain == current.sustain && envelope.release == current.release)
+        return;
+
+    mVoiceSettings.envelope = envelope;
+    mVoiceSettings.quality = quality;
+    ++mVoiceSettings.version;
+}
+
+void SpheringerSynth::setPolyphony (int numVoices, const std::function<juce::SynthesiserVoice*()>& createVoice)
+{
+    numVoices = juce::jlimit (1, maxPolyphony, numVoices);
+
+    // the storage is already there, so adding doesn't move the voices the audio thread is looking at;
+    // it only sees the new ones once they're published
+    // stealing reads the voices' levels, through the typed pointers kept here so it never has to cast
+    for (int i = getNumVoices(); i < numVoices; ++i)
+        mStreamingVoices[(size_t) i] = dynamic_cast<StreamingVoice*> (addVoice (createVoice()));
+
+    mNumVoices.store (getNumVoices(), std::memory_order_release);
+    mPolyphony = numVoices;
+}
+
+void SpheringerSynth::setMaximumBlockSize (int maxBlockSize)
+{
+    mMaxBlockSize = juce::jmax (1, maxBlockSize);
+
+    if (mRenderPool != nullptr && mRenderPool->getMaxBlockSize() != mMaxBlockSize)
+        mRenderPool->prepare (maxPolyphony, mMaxBlockSize, mNumOutputChannels);
+}
+
+void SpheringerSynth::setOutputLayout (const SpatialLayout& layout)
+{
+    mVoiceSettings.spatial = layout;
+    ++mVoiceSettings.version;
+
+    // stereo voices render two channels on a mono bus too
+    mNumOutputChannels = juce::jmax (2, layout.getNumChannels());
+
+    if (mRenderPool != nullptr && mRenderPool->getMaxChannels() != mNumOutputChannels)
+        mRenderPool->prepare (maxPolyphony, mMaxBlockSize, mNumOutputChannels);
+}
+
+void SpheringerSynth::setSpatialPosition (float azimuth, float elevation, float spread) noexcept
+{
+    mVoiceSettings.azimuth = azimuth;
+    mVoiceSettings.elevation = elevation;
+    mVoiceSettings.spread = spread;
+}
+
+void SpheringerSynth::handleController (int midiChannel, int controllerNumber, int controllerValue)
+{
+    // 0 is hard left, which is +90 degrees; 64 is the centre
+    if (controllerNumber == 10 && juce::isPositiveAndBelow (midiChannel - 1, (int) mVoiceSettings.channelAzimuths.size()))
+        mVoiceSettings.channelAzimuths[(size_t) (midiChannel - 1)] = (64.0f - (float) controllerValue) / 64.0f * 90.0f;
+
+    // the pedals as juce::Synthesiser::handleController() has them, then the rest of it without its lock
+    switch (controllerNumber)
+    {
+        case 0x40:  handleSustainPedal   (midiChannel, controllerValue >= 64); break;
+        case 0x42:  handleSostenutoPedal (midiChannel, controllerValue >= 64); break;
+        case 0x43:  handleSoftPedal      (midiChannel, controllerValue >= 64); break;
+        default:    break;
+    }
+
+    for (auto* voice : getPublishedVoices())
+        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+            voice->controllerMoved (controllerNumber, controllerValue);
+}
+
+void SpheringerSynth::setParallelRendering (bool shouldRenderInParallel)
+{
+    if (shouldRenderInParallel && mRenderPool == nullptr)
+    {
+        mRenderPool = std::make_unique<VoiceRenderPool> (VoiceRenderPool::getDefaultNumWorkers());
+        mRenderPool->prepare (maxPolyphony, mMaxBlockSize, mNumOutputChannels);
+    }
+
+    // the audio thread only looks at the pool after seeing this
+    mParallelRendering.store (shouldRenderInParallel, std::memory_order_release);
+}
+
+void SpheringerSynth::renderNextBlock (juce::AudioBuffer<float>& outputAudio, const juce::MidiBuffer& inputMidi,
+                                       int startSample, int numSamples)
+{
+    // must set the sample rate before using this!
+    jassert (getSampleRate() != 0);
+
+    const auto targetChannels = outputAudio.getNumChannels();
+    auto midiIterator = inputMidi.findNextSamplePosition (startSample);
+    bool firstEvent = true;
+
+    for (; numSamples > 0; ++midiIterator)
+    {
+        if (midiIterator == inputMidi.cend())
+        {
+            if (targetChannels > 0)
+                renderVoices (outputAudio, startSample, numSamples);
+
+            return;
+        }
+
+        const auto metadata = *midiIterator;
+        const auto samplesToNextMidiMessage = metadata.samplePosition - startSample;
+
+        if (samplesToNextMidiMessage >= numSamples)
+        {
+            if (targetChannels > 0)
+                renderVoices (outputAudio, startSample, numSamples);
+
+            handleMidiEvent (metadata);
+            ++midiIterator;
+            break;
+        }
+
+        if (samplesToNextMidiMessage < (firstEvent ? 1 : minimumSubBlockSize))
+        {
+            handleMidiEvent (metadata);
+            continue;
+        }
+
+        firstEvent = false;
+
+        if (targetChannels > 0)
+            renderVoices (outputAudio, startSample, samplesToNextMidiMessage);
+
+        handleMidiEvent (metadata);
+        startSample += samplesToNextMidiMessage;
+        numSamples -= samplesToNextMidiMessage;
+    }
+
+    for (; midiIterator != inputMidi.cend(); ++midiIterator)
+        handleMidiEvent (*midiIterator);
+}
+
+void SpheringerSynth::handleMidiEvent (const juce::MidiMessageMetadata& metadata)
+{
+    // longer ones are sysex, which nothing here plays (and which would allocate as a MidiMessage)
+    if (metadata.numBytes <= 3)
+        handleMidiEvent (metadata.getMessage());
+}
+
+void SpheringerSynth::handleMidiEvent (const juce::MidiMessage& message)
+{
+    // only dispatches, to the handlers below
+    juce::Synthesiser::handleMidiEvent (message);
+}
+
+void SpheringerSynth::renderVoices (juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    const auto published = getPublishedVoices();
+    mActiveVoices.clearQuick();
+
+    for (auto* voice : published)
+        if (voice->isVoiceActive())
+            mActiveVoices.add (voice);
+
+    mBlockStats.activeVoices = juce::jmax (mBlockStats.activeVoices, mActiveVoices.size());
+
+    // serially unless it's on and there's enough to share out: a few voices, or a short block (e.g. between
+    // two MIDI events), aren't worth waking anybody
+    if (! mParallelRendering.load (std::memory_order_acquire)
+         || numSamples > mRenderPool->getMaxBlockSize()
+         || ! VoiceRenderPool::isWorthIt (mActiveVoices.size(), numSamples))
+    {
+        for (auto* voice : published)
+            voice->renderNextBlock (outputAudio, startSample, numSamples);
+
+        return;
+    }
+
+    // idle voices may still be playing out the fade of a stolen note, which is cheap enough to do here
+    for (auto* voice : published)
+        if (! voice->isVoiceActive())
+            voice->renderNextBlock (outputAudio, startSample, numSamples);
+
+    mRenderPool->render (mActiveVoices.getRawDataPointer(), mActiveVoices.size(), outputAudio, startSample, numSamples);
+}
+
+juce::SynthesiserVoice* SpheringerSynth::findFreeVoice (juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                                        int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    const auto published = getPublishedVoices();
+    const auto limit = juce::jmin (mPolyphony.load (std::memory_order_relaxed), published.size);
+
+    for (int i = 0; i < limit; ++i)
+    {
+        auto* voice = published.first[i];
+
+        if (! voice->isVoiceActive() && voice->canPlaySound (soundToPlay))
+            return voice;
+    }
+
+    if (stealIfNoneAvailable)
+        return findVoiceToSteal (soundToPlay, midiChannel, midiNoteNumber);
+
+    return nullptr;
+}
+
+juce::SynthesiserVoice* SpheringerSynth::findVoiceToSteal (juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                                           int midiNoteNumber) const
+{
+    const auto published = getPublishedVoices();
+    const auto limit = juce::jmin (mPolyphony.load (std::memory_order_relaxed), published.size);
+    const auto policy = getStealPolicy();
+
+    juce::SynthesiserVoice* oldest = nullptr;
+    juce::SynthesiserVoice* quietest = nullptr;
+    float quietestLevel = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < limit; ++i)
+    {
+        auto* voice = published.first[i];
+
+        if (! voice->canPlaySound (soundToPlay))
+            continue;
+
+        if (policy == StealPolicy::sameNote && voice->getCurrentlyPlayingNote() == midiNoteNumber
+             && voice->isPlayingChannel (midiChannel))
+            return voice;
+
+        if (oldest == nullptr || voice->wasStartedBefore (*oldest))
+            oldest = voice;
+
+        if (auto* streamingVoice = mStreamingVoices[(size_t) i])
+        {
+            const auto level = streamingVoice->getCurrentLevel();
+
+            if (level < quietestLevel)
+            {
+                quietestLevel = level;
+                quietest = voice;
+            }
+        }
+    }
+
+    if (policy == StealPolicy::quietest && quietest != nullptr)
+        return quietest;
+
+    return oldest;
+}
+
+NoteUsage SpheringerSynth::getNoteUsage() const noexcept
+{
+    NoteUsage usage;
+
+    for (size_t note = 0; note < usage.size(); ++note)
+        usage[note] = mNoteUsage[note].load (std::memory_order_relaxed);
+
+    return usage;
+}
+
+void SpheringerSynth::setNoteUsage (const NoteUsage& usage) noexcept
+{
+    for (size_t note = 0; note < usage.size(); ++note)
+        mNoteUsage[note].store (usage[note], std::memory_order_relaxed);
+}
+
+// same as juce::Synthesiser::noteOn(), but the sound comes from the current SoundSet's keymap
+// (a table read) rather than from scanning every sound's appliesToNote()
+void SpheringerSynth::noteOn (int midiChannel, int midiNoteNumber, float velocity)
+{
+    if (juce::isPositiveAndBelow (midiNoteNumber, (int) mNoteUsage.size()))
+        mNoteUsage[(size_t) midiNoteNumber].fetch_add (1, std::memory_order_relaxed);
+
+    auto* set = mSoundSets.getCurrent();
+
+    if (set == nullptr)
+        return;
+
+    auto* keymap = set->getKeymap (mArticulation.load (std::memory_order_relaxed));
+
+    if (keymap == nullptr)
+        return;
+
+    // keys are 0..127 in practice, the mask only keeps the counter lookup in range
+    const auto count = mAlternateCounters[(size_t) (midiNoteNumber & 127)].fetch_add (1, std::memory_order_relaxed);
+    const int soundIndex = keymap->getSoundIndex (midiNoteNumber, SampleKeymap::toMidiVelocity (velocity),
+                                                  getAlternateMode(), count, midiChannel);
+
+    if (! juce::isPositiveAndBelow (soundIndex, set->sounds.size()))
+        return;
+
+    auto* sound = set->sounds.getUnchecked (soundIndex);
+
+    if (! sound->appliesToChannel (midiChannel))
+        return;
+
+    // if the note is still ringing (sustain pedal), stop it first, or with same-note retrigger
+    // restart it on the same voice (which fades the old note out)
+    const auto retrigger = getStealPolicy() == StealPolicy::sameNote;
+
+    for (auto* voice : getPublishedVoices())
+    {
+        if (voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel (midiChannel))
+        {
+            if (retrigger && voice->canPlaySound (sound))
+            {
+                startNote (voice, sound, midiChannel, midiNoteNumber, velocity);
+                return;
+            }
+
+            voice->stopNote (1.0f, true);
+        }
+    }
+
+    auto* voice = findFreeVoice (sound, midiChannel, midiNoteNumber, isNoteStealingEnabled());
+
+    if (voice == nullptr)
+        ++mBlockStats.notesDropped;
+    else if (voice->isVoiceActive())
+        ++mBlockStats.notesStolen;
+
+    startNote (voice, sound, midiChannel, midiNoteNumber, velocity);
+}
+
+void SpheringerSynth::startNote (juce::SynthesiserVoice* voice, juce::SynthesiserSound* sound, int midiChannel,
+                                 int midiNoteNumber, float velocity)
+{
+    startVoice (voice, sound, midiChannel, midiNoteNumber, velocity);
+
+    if (voice != nullptr && sound != nullptr)
+        voice->setSustainPedalDown ((mSustainPedalsDown & (1u << (midiChannel & 31))) != 0);
+}
+
+// the rest are juce::Synthesiser's, without the lock and over the published voices only
+void SpheringerSynth::noteOff (int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
+    for (auto* voice : getPublishedVoices())
+    {
+        if (voice->getCurrentlyPlayingNote() != midiNoteNumber || ! voice->isPlayingChannel (midiChannel))
+            continue;
+
+        // a raw pointer: a reference held across stopVoice() could end up the last one, and free the sound here
+        if (auto* sound = voice->getCurrentlyPlayingSound().get())
+        {
+            if (sound->appliesToNote (midiNoteNumber) && sound->appliesToChannel (midiChannel))
+            {
+                voice->setKeyDown (false);
+
+                if (! (voice->isSustainPedalDown() || voice->isSostenutoPedalDown()))
+                    stopVoice (voice, velocity, allowTailOff);
+            }
+        }
+    }
+}
+
+void SpheringerSynth::allNotesOff (int midiChannel, bool allowTailOff)
+{
+    for (auto* voice : getPublishedVoices())
+        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+            voice->stopNote (1.0f, allowTailOff);
+
+    mSustainPedalsDown = 0;
+}
+
+void SpheringerSynth::handlePitchWheel (int midiChannel, int wheelValue)
+{
+    for (auto* voice : getPublishedVoices())
+        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+            voice->pitchWheelMoved (wheelValue);
+}
+
+void SpheringerSynth::handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
+{
+    for (auto* voice : getPublishedVoices())
+        if (voice->getCurrentlyPlayingNote() == midiNoteNumber && (midiChannel <= 0 || voice->isPlayingChannel (midiChannel)))
+            voice->aftertouchChanged (aftertouchValue);
+}
+
+void SpheringerSynth::handleChannelPressure (int midiChannel, int channelPressureValue)
+{
+    for (auto* voice : getPublishedVoices())
+        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+            voice->channelPressureChanged (channelPressureValue);
+}
+
+void SpheringerSynth::handleSustainPedal (int midiChannel, bool isDown)
+{
+    jassert (midiChannel > 0 && midiChannel <= 16);
+    const auto bit = 1u << (midiChannel & 31);
+
+    if (isDown)
+    {
+        mSustainPedalsDown |= bit;
+
+        for (auto* voice : getPublishedVoices())
+            if (voice->isPlayingChannel (midiChannel) && voice->isKeyDown())
+                voice->setSustainPedalDown (true);
+
+        return;
+    }
+
+    for (auto* voice : getPublishedVoices())
+    {
+        if (voice->isPlayingChannel (midiChannel))
+        {
+            voice->setSustainPedalDown (false);
+
+            if (! (voice->isKeyDown() || voice->isSostenutoPedalDown()))
+                stopVoice (voice, 1.0f, true);
+        }
+    }
+
+    mSustainPedalsDown &= ~bit;
+}
+
+void SpheringerSynth::handleSostenutoPedal (int midiChannel, bool isDown)
+{
+    for (auto* voice : getPublishedVoices())
+    {
+        if (voice->isPlayingChannel (midiChannel))
+        {
+            if (isDown)
+                voice->setSostenutoPedalDown (true);
+            else if (voice->isSostenutoPedalDown())
+                stopVoice (voice, 1.0f, true);
+        }
+    }
+}
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    SpheringerSynth.h
+    Created: 17 Oct 2026 9:20:45am
+    Author:  jwmao
+
+    juce::Synthesiser that plays from a SoundSet published by the loader instead
+    of its own sound list, so loading a new sample never has to take the
+    Synthesiser lock from the message thread. The audio thread doesn't take it
+    either: the block and every MIDI handler that would are replaced here with
+    versions that go without it. Note-ons look their sound up in
+    the set's keymap instead of asking every sound appliesToNote(); which of a
+    zone's alternate takes plays comes from the keymap's tables too, indexed
+    by a counter per key.
+
+    Voices come from a pool that only ever grows, on the message thread, so
+    changing the polyphony never allocates or frees anything on the audio
+    thread. Its storage is allocated for maxPolyphony up front and never
+    moves, and a new voice is only published to the audio thread once it's
+    in, which is all the locking the pool needs. Which voice gets stolen when all of them are busy is up to the
+    StealPolicy; stolen voices fade out over a few ms rather than clicking.
+
+    With parallel rendering on, big enough blocks are spread across a
+    VoiceRenderPool; small ones are still rendered in place.
+
+    On a spatial output bus every voice encodes itself at its own position;
+    pan (CC 10) moves the notes of its MIDI channel around the centre.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SoundSet.h"
+#include "Interpolators.h"
+#include "VoiceRenderPool.h"
+#include "StreamingVoice.h"
+
+class SpheringerSynth : public juce::Synthesiser
+{
+public:
+    enum class StealPolicy
+    {
+        oldest = 0,     // the note that started longest ago
+        quietest,       // the lowest envelope level times velocity
+        sameNote        // a repeated note reuses its own voice, otherwise the oldest
+    };
+
+    static constexpr int maxPolyphony = 256;
+
+    SpheringerSynth();
+    ~SpheringerSynth() override;
+
+    // the exchange has to be registered with a TimeSliceThread so retired sets get freed
+    SoundSetExchange& getSoundSetExchange() noexcept { return mSoundSets; }
+
+    // call on the audio thread once per block, before renderNextBlock()
+    void updateSoundSet() noexcept { mSoundSets.acquire(); }
+
+    // which of the set's keymaps to play from, safe to call from any thread
+    void setArticulation (int index) noexcept { mArticulation = index; }
+    int getArticulation() const noexcept { return mArticulation.load(); }
+
+    // how zones with alternate takes pick one, safe to call from any thread
+    void setAlternateMode (AlternateMode mode) noexcept { mAlternateMode = (int) mode; }
+    AlternateMode getAlternateMode() const noexcept { return (AlternateMode) mAlternateMode.load(); }
+
+    // what StreamingVoices created for this synth should read their envelope etc. from
+    const VoiceSettings& getVoiceSettings() const noexcept { return mVoiceSettings; }
+
+    // audio thread, once per block before rendering: playing voices pick up envelope changes,
+    // the interpolation quality applies from the next note on
+    void updateVoiceSettings (const juce::ADSR::Parameters& envelope, InterpolationQuality quality) noexcept;
+
+    // audio thread, once per block: whether the host is rendering offline
+    void setNonRealtime (bool isNonRealtime) noexcept { mVoiceSettings.nonRealtime = isNonRealtime; }
+
+    // audio thread, once per block before rendering: the level of each mic position, which playing notes follow
+    void setMicLevels (const std::array<float, SampleZone::maxLayers>& levels) noexcept { mVoiceSettings.micLevels = levels; }
+
+    // message thread, from prepareToPlay(): what the voices render into. Spatial layouts get the voices encoding
+    // themselves, and the parallel renderer as many channels per voice
+    void setOutputLayout (const SpatialLayout& layout);
+
+    // audio thread, once per block before rendering: where notes go on a spatial bus (see VoiceSettings), in degrees
+    void setSpatialPosition (float azimuth, float elevation, float spread) noexcept;
+
+    // message thread: grows the pool with createVoice() if it's smaller than numVoices, then lets that
+    // many voices play. Voices above a lowered limit finish their notes but don't start new ones.
+    void setPolyphony (int numVoices, const std::function<juce::SynthesiserVoice*()>& createVoice);
+    int getPolyphony() const noexcept { return mPolyphony.load(); }
+
+    // any thread
+    void setStealPolicy (StealPolicy policy) noexcept { mStealPolicy = (int) policy; }
+    StealPolicy getStealPolicy() const noexcept { return (StealPolicy) mStealPolicy.load(); }
+
+    // message thread, from prepareToPlay(): the largest block the host will ask for
+    void setMaximumBlockSize (int maxBlockSize);
+
+    // message thread: renders voices on worker threads when a block has enough work for it.
+    // The workers are started the first time it's turned on and stay around until the synth is deleted.
+    void setParallelRendering (bool shouldRenderInParallel);
+    bool isRenderingInParallel() const noexcept { return mParallelRendering.load(); }
+
+    // how many times each note has been played, saved with the session so a reload can start with those zones
+    NoteUsage getNoteUsage() const noexcept;
+    void setNoteUsage (const NoteUsage& usage) noexcept;
+
+    // what happened on the audio thread since the last call
+    struct BlockStats
+    {
+        int activeVoices = 0;   // the most that were playing at once
+        int notesStolen = 0;
+        int notesDropped = 0;   // no free voice and stealing is off
+    };
+
+    // audio thread, once per block after rendering: returns the stats and starts counting afresh
+    BlockStats takeBlockStats() noexcept { return std::exchange (mBlockStats, {}); }
+
+    // audio thread: same as juce::Synthesiser::renderNextBlock(), without its lock. Hides the base class's,
+    // which isn't virtual, so call it on a SpheringerSynth
+    void renderNextBlock (juce::AudioBuffer<float>& outputAudio, const juce::MidiBuffer& inputMidi, int startSample, int numSamples);
+
+    // audio thread: one event straight to the voices, e.g. from the on-screen keyboard; renderNextBlock() does this
+    // for the events in its buffer
+    void handleMidiEvent (const juce::MidiMessage& message) override;
+
+    // the juce::Synthesiser handlers that take its lock, here without it (all of them audio thread only)
+    void noteOn (int midiChannel, int midiNoteNumber, float velocity) override;
+    void noteOff (int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+    void allNotesOff (int midiChannel, bool allowTailOff) override;
+    void handlePitchWheel (int midiChannel, int wheelValue) override;
+    void handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue) override;
+    void handleChannelPressure (int midiChannel, int channelPressureValue) override;
+    void handleSustainPedal (int midiChannel, bool isDown) override;
+    void handleSostenutoPedal (int midiChannel, bool isDown) override;
+
+    // pan (CC 10) is kept per channel for the voices, everything goes on to them as well
+    void handleController (int midiChannel, int controllerNumber, int controllerValue) override;
+
+protected:
+    void renderVoices (juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+    juce::SynthesiserVoice* findFreeVoice (juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                           int midiNoteNumber, bool stealIfNoneAvailable) const override;
+
+    juce::SynthesiserVoice* findVoiceToSteal (juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                              int midiNoteNumber) const override;
+
+private:
+    // the voices the audio thread can see: the pool's storage doesn't move, new voices count once published
+    struct VoiceRange
+    {
+        juce::SynthesiserVoice* const* first;
+        int size;
+
+        juce::SynthesiserVoice* const* begin() const noexcept { return first; }
+        juce::SynthesiserVoice* const* end() const noexcept   { return first + size; }
+    };
+
+    VoiceRange getPublishedVoices() const noexcept { return { voices.begin(), mNumVoices.load (std::memory_order_acquire) }; }
+
+    void handleMidiEvent (const juce::MidiMessageMetadata& metadata);
+
+    // startVoice(), with the channel's sustain pedal (which juce::Synthesiser keeps privately)
+    void startNote (juce::SynthesiserVoice* voice, juce::SynthesiserSound* sound, int midiChannel, int midiNoteNumber, float velocity);
+
+    // what juce::Synthesiser uses by default: events closer together than this are handled between two renders
+    static constexpr int minimumSubBlockSize = 32;
+
+    SoundSetExchange mSoundSets;
+    std::atomic<int> mNumVoices {0};
+
+    // voices[i] as a StreamingVoice, or nullptr if it isn't one; published with them
+    std::array<StreamingVoice*, maxPolyphony> mStreamingVoices {};
+    std::atomic<int> mArticulation {0};
+    std::atomic<int> mPolyphony {0};
+    std::atomic<int> mStealPolicy { (int) StealPolicy::oldest };
+
+    VoiceSettings mVoiceSettings;
+
+    std::array<std::atomic<juce::uint32>, 128> mNoteUsage {};
+
+    // note-ons per key since the synth was created, for picking the next take
+    std::array<std::atomic<juce::uint32>, 128> mAlternateCounters {};
+    std::atomic<int> mAlternateMode { (int) AlternateMode::roundRobin };
+
+    // bit n for MIDI channel n, audio thread only
+    juce::uint32 mSustainPedalsDown = 0;
+
+    std::unique_ptr<VoiceRenderPool> mRenderPool;
+    std::atomic<bool> mParallelRendering {false};
+    int mMaxBlockSize = 512;
+    int mNumOutputChannels = 2;
+
+    // the voices handed to the pool this block, preallocated for every voice there can be
+    juce::Array<juce::SynthesiserVoice*> mActiveVoices;
+
+    BlockStats mBlockStats; // audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpheringerSynth)
+};
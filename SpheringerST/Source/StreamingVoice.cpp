@@ -0,0 +1,620 @@
+/*
+  ==============================================================================
+
+    StreamingVoice.cpp
+    Created: 17 Oct 2026 1:14:22pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "StreamingVoice.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define SPHERINGER_USE_NEON 1
+#endif
+
+StreamingVoice::StreamingVoice (DiskStreamer& streamer, const VoiceSettings& settings)
+    : mStreamer (streamer),
+      mSettings (settings),
+      mKernels (Interpolators::getKernels()),
+      mScratch (2, scratchFrames),
+      mRendered (2, scratchFrames),
+      mEnvelopeGains (scratchFrames),
+      mFadeOut (2, maxFadeOutFrames)
+{
+    // builds the sinc table here rather than on the audio thread at the first note
+    SincTable::getInstance();
+
+    prepareLayers (1);
+
+    for (auto& stream : mStreams)
+        mStreamer.addStream (&stream);
+}
+
+StreamingVoice::~StreamingVoice()
+{
+    for (auto& stream : mStreams)
+        mStreamer.removeStream (&stream);
+}
+
+void StreamingVoice::prepareLayers (int numLayers)
+{
+    numLayers = juce::jmin (numLayers, SampleZone::maxLayers);
+
+    if (numLayers <= mNumPreparedLayers.load (std::memory_order_relaxed))
+        return;
+
+    // the audio thread only touches layers below mNumPreparedLayers, and those are never resized
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+        mStreams[(size_t) layer].prepare();
+
+        // a single layer is fetched straight into mScratch, more are mixed from these
+        if (numLayers > 1 && mLayerScratch[(size_t) layer].getNumSamples() == 0)
+            mLayerScratch[(size_t) layer].setSize (2, scratchFrames);
+    }
+
+    mNumPreparedLayers.store (numLayers, std::memory_order_release);
+}
+
+bool StreamingVoice::canPlaySound (juce::SynthesiserSound* sound)
+{
+    return dynamic_cast<const SampleZone*> (sound) != nullptr;
+}
+
+void StreamingVoice::startNote (int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int)
+{
+    auto* zone = dynamic_cast<SampleZone*> (sound);
+
+    if (zone == nullptr)
+    {
+        jassertfalse; // this voice only plays SampleZones
+        return;
+    }
+
+    mZone = zone;
+    mSourcePosition = 0.0;
+    mGain = velocity * zone->getGain();
+
+    mPitchRatio = std::pow (2.0, (midiNoteNumber - zone->getMidiRootNote()) / 12.0)
+                    * zone->getSourceSampleRate() / getSampleRate();
+    mPitchRatio = juce::jmin (mPitchRatio, maxPitchRatio);
+
+    // the layers that are turned up; the others aren't read by this note at all
+    mNumLayers = 0;
+    auto numLevels = std::numeric_limits<int>::max();
+
+    const auto numPreparedLayers = mNumPreparedLayers.load (std::memory_order_acquire);
+
+    for (int i = 0; i < juce::jmin (zone->getNumLayers(), numPreparedLayers); ++i)
+    {
+        const auto& zoneLayer = zone->getLayer (i);
+        const auto level = mSettings.micLevels[(size_t) zoneLayer.micPosition];
+
+        if (level <= 0.0f)
+            continue;
+
+        auto& layer = mLayers[(size_t) mNumLayers++];
+        layer.data = zoneLayer.data.get();
+        layer.micPosition = zoneLayer.micPosition;
+        layer.gain = level;
+
+        auto* mipMap = layer.data->getMipMap();
+        numLevels = juce::jmin (numLevels, mipMap != nullptr ? mipMap->getNumLevels() : 0);
+    }
+
+    // far above the root, read the decimated copies that bring the ratio back near 1 (once the loader has built
+    // them). The layers have to play from the same level, so it's the highest all of them have
+    const auto level = mNumLayers > 0 ? SampleMipMap::chooseLevel (mPitchRatio, numLevels) : 0;
+
+    if (level > 0)
+        mPitchRatio /= (double) (1 << level);
+
+    mMipLevelIndex = level;
+    mLength = 0;
+
+    // the loop baked at the same level, once the loader has found it, but only if every layer loops
+    // at the same frames: anything else would pull them apart
+    mLoop = nullptr;
+    mReleased = false;
+    mLooping = false;
+
+    for (int i = 0; i < mNumLayers; ++i)
+    {
+        auto& layer = mLayers[(size_t) i];
+        layer.mipLevel = level > 0 ? &layer.data->getMipMap()->getLevel (level) : nullptr;
+        layer.length = SampleMipMap::getDecimatedLength (layer.data->getLengthInSamples(), level);
+        layer.loop = nullptr;
+        mLength = juce::jmax (mLength, layer.length);
+
+        if (auto* loop = layer.data->getLoop())
+            if (level < loop->getNumLevels())
+                layer.loop = &loop->getLevel (level);
+    }
+
+    if (mNumLayers > 0 && mLayers[0].loop != nullptr)
+    {
+        const auto& first = *mLayers[0].loop;
+
+        const auto inSync = std::all_of (mLayers.begin(), mLayers.begin() + mNumLayers, [&first] (const Layer& layer)
+        {
+            return layer.loop != nullptr && layer.loop->start == first.start && layer.loop->end == first.end
+                    && layer.loop->crossfade == first.crossfade;
+        });
+
+        if (inSync)
+            mLoop = &first;
+    }
+
+    mQuality = mSettings.quality;
+    mFootprint = Interpolators::getFootprint (mQuality);
+
+    const auto& sincTable = SincTable::getInstance();
+    mSincBand = sincTable.getBand (sincTable.getBandForRatio (mPitchRatio));
+
+    mEnvelope.setSampleRate (getSampleRate());
+    mEnvelope.setParameters (mSettings.envelope);
+    mSettingsVersion = mSettings.version;
+    mEnvelope.noteOn();
+
+    // the synth has set the channel by now; its pan moves the note
+    mMidiChannel = 1;
+
+    for (int channel = 1; channel <= (int) mSettings.channelAzimuths.size(); ++channel)
+    {
+        if (isPlayingChannel (channel))
+        {
+            mMidiChannel = channel;
+            break;
+        }
+    }
+
+    if (mSettings.spatial.isSpatial())
+        updatePosition (true);
+
+    // the head covers the start of the note while the I/O thread fetches the rest
+    for (int i = 0; i < mNumLayers; ++i)
+        mStreams[(size_t) i].start (mLayers[(size_t) i].data, level);
+}
+
+void StreamingVoice::stopNote (float, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        mReleased = true;
+        mEnvelope.noteOff();
+        return;
+    }
+
+    if (mZone != nullptr)
+        startFadeOut();
+
+    finishNote();
+}
+
+void StreamingVoice::startFadeOut() noexcept
+{
+    const auto length = juce::jlimit (1, maxFadeOutFrames, juce::roundToInt (fadeOutSeconds * getSampleRate()));
+
+    // a voice stolen twice in a row keeps what's left of the first tail, renderNote() adds to it
+    const auto remaining = mFadeOutLength - mFadeOutPosition;
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        auto* data = mFadeOut.getWritePointer (channel);
+
+        for (int i = 0; i < remaining; ++i)
+            data[i] = data[mFadeOutPosition + i];
+    }
+
+    mFadeOut.clear (remaining, maxFadeOutFrames - remaining);
+
+    // the tail plays out where the note was (what's left of an earlier tail moves there with it, for a few ms)
+    mFadeOutGains = mGains;
+
+    renderNote (mFadeOut, 0, length, 1.0f / (float) length);
+
+    mFadeOutLength = juce::jmax (remaining, length);
+    mFadeOutPosition = 0;
+}
+
+void StreamingVoice::finishNote() noexcept
+{
+    for (int i = 0; i < mNumLayers; ++i)
+        mStreams[(size_t) i].stop();
+
+    mEnvelope.reset();
+    mZone = nullptr;
+    mNumLayers = 0;
+    mLoop = nullptr;
+    mLooping = false;
+    mLevel = 0.0f;
+    mPlayhead.store (0, std::memory_order_relaxed);
+    clearCurrentNote();
+}
+
+namespace
+{
+    // dest = the sum of the sources, each with a gain ramping from gains[i] by steps[i] per frame.
+    // One pass over dest however many layers there are; dest may be sources[0].
+    void mixLayers (float* dest, const float* const* sources, const float* gains, const float* steps,
+                    int numSources, int numFrames) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_INTEL
+        const auto offsets = _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f);
+
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            const auto index = _mm_add_ps (_mm_set1_ps ((float) i), offsets);
+            auto sum = _mm_setzero_ps();
+
+            for (int s = 0; s < numSources; ++s)
+            {
+                const auto gain = _mm_add_ps (_mm_set1_ps (gains[s]), _mm_mul_ps (_mm_set1_ps (steps[s]), index));
+                sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (sources[s] + i), gain));
+            }
+
+            _mm_storeu_ps (dest + i, sum);
+        }
+       #elif SPHERINGER_USE_NEON
+        const float offsetValues[] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const auto offsets = vld1q_f32 (offsetValues);
+
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            const auto index = vaddq_f32 (vdupq_n_f32 ((float) i), offsets);
+            auto sum = vdupq_n_f32 (0.0f);
+
+            for (int s = 0; s < numSources; ++s)
+            {
+                const auto gain = vmlaq_f32 (vdupq_n_f32 (gains[s]), vdupq_n_f32 (steps[s]), index);
+                sum = vmlaq_f32 (sum, vld1q_f32 (sources[s] + i), gain);
+            }
+
+            vst1q_f32 (dest + i, sum);
+        }
+       #endif
+
+        for (; i < numFrames; ++i)
+        {
+            float sum = 0.0f;
+
+            for (int s = 0; s < numSources; ++s)
+                sum += sources[s][i] * (gains[s] + steps[s] * (float) i);
+
+            dest[i] = sum;
+        }
+    }
+}
+
+void StreamingVoice::fetchSourceFrames (juce::int64 firstFrame, int numFrames) noexcept
+{
+    // each layer ramps to its mic level across the chunk; the ones that stay silent aren't read
+    std::array<int, SampleZone::maxLayers> audible;
+    std::array<float, SampleZone::maxLayers> gains, steps;
+    int numAudible = 0;
+
+    for (int i = 0; i < mNumLayers; ++i)
+    {
+        auto& layer = mLayers[(size_t) i];
+        const auto target = mSettings.micLevels[(size_t) layer.micPosition];
+
+        if (layer.gain > 0.0f || target > 0.0f)
+        {
+            audible[(size_t) numAudible] = i;
+            gains[(size_t) numAudible] = layer.gain;
+            steps[(size_t) numAudible] = (target - layer.gain) / (float) numFrames;
+            ++numAudible;
+        }
+
+        layer.gain = target;
+    }
+
+    if (numAudible == 0)
+    {
+        mScratch.clear (0, numFrames);
+        return;
+    }
+
+    // one layer at full level is what most zones are: read it straight into place
+    if (numAudible == 1)
+    {
+        fetchLayerFrames (audible[0], mScratch, firstFrame, numFrames);
+
+        if (gains[0] != 1.0f || steps[0] != 0.0f)
+            for (int channel = 0; channel < 2; ++channel)
+                mixLayers (mScratch.getWritePointer (channel), mScratch.getArrayOfReadPointers() + channel,
+                           gains.data(), steps.data(), 1, numFrames);
+
+        return;
+    }
+
+    for (int i = 0; i < numAudible; ++i)
+        fetchLayerFrames (audible[(size_t) i], mLayerScratch[(size_t) i], firstFrame, numFrames);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        std::array<const float*, SampleZone::maxLayers> sources;
+
+        for (int i = 0; i < numAudible; ++i)
+            sources[(size_t) i] = mLayerScratch[(size_t) i].getReadPointer (channel);
+
+        mixLayers (mScratch.getWritePointer (channel), sources.data(), gains.data(), steps.data(), numAudible, numFrames);
+    }
+}
+
+void StreamingVoice::fetchLayerFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames) noexcept
+{
+    if (! mLooping)
+    {
+        fetchPlainFrames (layer, dest, firstFrame, 0, numFrames);
+        return;
+    }
+
+    // anything before the loop's buffer can only be asked for before the first jump back
+    const auto numBefore = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numFrames, mLoop->getFirstFrame() - firstFrame);
+
+    if (numBefore > 0)
+        fetchPlainFrames (layer, dest, firstFrame, 0, numBefore);
+
+    fetchLoopFrames (layer, dest, firstFrame + numBefore, numBefore, numFrames - numBefore);
+}
+
+void StreamingVoice::fetchLoopFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int destStart, int numFrames) noexcept
+{
+    // every layer's loop is at mLoop's frames, only the audio differs
+    const auto& audio = mLayers[(size_t) layer].loop->audio;
+
+    for (int done = 0; done < numFrames;)
+    {
+        auto frame = firstFrame + done;
+
+        if (frame >= mLoop->end)
+            frame = mLoop->start + (frame - mLoop->start) % mLoop->getLength();
+
+        const auto num = (int) juce::jmin ((juce::int64) (numFrames - done), mLoop->end - frame);
+
+        for (int channel = 0; channel < 2; ++channel)
+            audio.read (juce::jmin (channel, audio.getNumChannels() - 1), dest.getWritePointer (channel, destStart + done),
+                        (int) (frame - mLoop->getFirstFrame()), num);
+
+        done += num;
+    }
+}
+
+void StreamingVoice::fetchPlainFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int destStart, int numFrames) noexcept
+{
+    // the head of the source or of its mip level is in memory, the stream brings the rest
+    const auto& source = mLayers[(size_t) layer];
+    auto& stream = mStreams[(size_t) layer];
+    const auto& head = source.mipLevel != nullptr ? *source.mipLevel : source.data->getHead();
+    const auto headLength = (juce::int64) head.getNumSamples();
+    const auto length = source.length;
+
+    int done = 0;
+
+    // silence before the start of the sample
+    if (firstFrame < 0)
+    {
+        done = (int) juce::jmin ((juce::int64) numFrames, -firstFrame);
+        dest.clear (destStart, done);
+    }
+
+    // the preloaded head
+    if (firstFrame + done < headLength && done < numFrames)
+    {
+        const auto numFromHead = (int) juce::jmin ((juce::int64) (numFrames - done), headLength - (firstFrame + done));
+
+        // mono samples play on both sides. Integer storage is decoded here, only as much as this chunk needs
+        for (int channel = 0; channel < 2; ++channel)
+            head.read (juce::jmin (channel, head.getNumChannels() - 1), dest.getWritePointer (channel, destStart + done), (int) (firstFrame + done), numFromHead);
+
+        done += numFromHead;
+    }
+
+    // whatever the I/O thread has streamed
+    const auto numStreamed = (int) juce::jlimit ((juce::int64) 0, (juce::int64) (numFrames - done), length - (firstFrame + done));
+
+    if (numStreamed > 0)
+    {
+        // rendering faster than realtime would outrun the disk thread, so wait for it
+        if (mSettings.nonRealtime)
+            stream.waitUntilAvailable (firstFrame + done + numStreamed, 5000);
+
+        stream.read (dest, destStart + done, firstFrame + done, numStreamed, mStreamer.getStats());
+        done += numStreamed;
+    }
+
+    // silence past the end of the sample
+    if (done < numFrames)
+        dest.clear (destStart + done, numFrames - done);
+}
+
+namespace
+{
+    // mono outputs get both channels at half gain
+    void addStereo (juce::AudioBuffer<float>& dest, int destStart, const juce::AudioBuffer<float>& source, int sourceStart, int numSamples, float gain) noexcept
+    {
+        if (dest.getNumChannels() > 1)
+        {
+            dest.addFrom (0, destStart, source, 0, sourceStart, numSamples, gain);
+            dest.addFrom (1, destStart, source, 1, sourceStart, numSamples, gain);
+        }
+        else
+        {
+            dest.addFrom (0, destStart, source, 0, sourceStart, numSamples, gain * 0.5f);
+            dest.addFrom (0, destStart, source, 1, sourceStart, numSamples, gain * 0.5f);
+        }
+    }
+}
+
+void StreamingVoice::addToOutput (juce::AudioBuffer<float>& dest, int destStart, const juce::AudioBuffer<float>& source, int sourceStart,
+                                  int numSamples, float gain, const SpatialLayout::Gains& from, const SpatialLayout::Gains& to) const noexcept
+{
+    // mFadeOut is stereo whatever the bus, so it never takes this branch
+    const auto& spatial = mSettings.spatial;
+
+    if (spatial.isSpatial() && dest.getNumChannels() >= spatial.getNumChannels())
+        spatial.encode (dest, destStart, source.getReadPointer (0, sourceStart), source.getReadPointer (1, sourceStart),
+                        numSamples, from, to, gain);
+    else
+        addStereo (dest, destStart, source, sourceStart, numSamples, gain);
+}
+
+void StreamingVoice::updatePosition (bool jump) noexcept
+{
+    mGainsRamping = false;
+
+    const auto note = (float) juce::jlimit (0, 127, getCurrentlyPlayingNote());
+    const auto azimuth = mSettings.azimuth + mSettings.spread * (0.5f - note / 127.0f)
+                          + mSettings.channelAzimuths[(size_t) (mMidiChannel - 1)];
+    const auto elevation = mSettings.elevation;
+
+    // the only trigonometry a voice does, and only when it has moved
+    if (! jump && azimuth == mAzimuth && elevation == mElevation && mPositionVersion == mSettings.version)
+        return;
+
+    if (! jump)
+    {
+        mGainsFrom = mGains;
+        mGainsRamping = true;
+    }
+
+    mAzimuth = azimuth;
+    mElevation = elevation;
+    mPositionVersion = mSettings.version;
+    mSettings.spatial.computeGains (azimuth, elevation, sourceWidth, mGains);
+}
+
+void StreamingVoice::renderNextBlock (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    // the faded tail of a note that was cut off, on top of whatever plays now
+    if (mFadeOutPosition < mFadeOutLength)
+    {
+        const auto numToAdd = juce::jmin (numSamples, mFadeOutLength - mFadeOutPosition);
+
+        addToOutput (outputBuffer, startSample, mFadeOut, mFadeOutPosition, numToAdd, 1.0f, mFadeOutGains, mFadeOutGains);
+        mFadeOutPosition += numToAdd;
+    }
+
+    if (mZone == nullptr)
+        return;
+
+    // envelope changes apply to notes that are already playing, too
+    if (mSettingsVersion != mSettings.version)
+    {
+        mEnvelope.setParameters (mSettings.envelope);
+        mSettingsVersion = mSettings.version;
+    }
+
+    if (mSettings.spatial.isSpatial())
+        updatePosition (false);
+
+    renderNote (outputBuffer, startSample, numSamples, 0.0f);
+
+    // in source frames, whichever level the note reads
+    if (mZone != nullptr)
+    {
+        const auto frame = (juce::uint64) juce::jlimit (0.0, 4294967295.0, mSourcePosition * (double) (1 << mMipLevelIndex));
+        mPlayhead.store (((juce::uint64) mZone->getData().getId() << 32) | frame, std::memory_order_relaxed);
+    }
+}
+
+void StreamingVoice::renderNote (juce::AudioBuffer<float>& dest, int destStart, int numSamples, float fadeStep) noexcept
+{
+    const auto length = (double) mLength;
+    const auto before = mFootprint.before;
+    const auto after = mFootprint.after;
+    const auto kernel = mKernels.get (mQuality);
+
+    // as many output samples per chunk as the scratch buffer has source frames for, kernel footprint included
+    const int maxChunk = juce::jlimit (1, scratchFrames, (int) ((scratchFrames - before - after - 2) / mPitchRatio));
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int chunk = juce::jmin (numSamples - done, maxChunk);
+        const auto firstFrame = (juce::int64) mSourcePosition;
+        const auto numFrames = (int) ((juce::int64) (mSourcePosition + mPitchRatio * chunk) - firstFrame) + 1 + before + after;
+
+        // a held note commits to the loop before it reads any of the crossfade; released before that, it plays out
+        if (mLoop != nullptr && ! mLooping && firstFrame - before + numFrames > mLoop->end - mLoop->crossfade)
+        {
+            if (mReleased)
+                mLoop = nullptr;
+            else
+                mLooping = true;
+        }
+
+        fetchSourceFrames (firstFrame - before, numFrames);
+
+        // resample each channel into mRendered, then envelope and velocity on top
+        const auto position = mSourcePosition - (double) firstFrame;
+
+        // a sample at the host rate played at its root (or an octave up from the next mip level) lands on
+        // whole frames: nothing to interpolate
+        if (mPitchRatio == 1.0 && position == 0.0)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                mRendered.copyFrom (channel, 0, mScratch, channel, before, chunk);
+        }
+        else
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                kernel (mScratch.getReadPointer (channel, before), position, mPitchRatio,
+                        mRendered.getWritePointer (channel), chunk, mSincBand);
+        }
+
+        for (int i = 0; i < chunk; ++i)
+            mEnvelopeGains[i] = mEnvelope.getNextSample();
+
+        if (fadeStep > 0.0f)
+            for (int i = 0; i < chunk; ++i)
+                mEnvelopeGains[i] *= juce::jmax (0.0f, 1.0f - (float) (done + i) * fadeStep);
+
+        mLevel = mEnvelopeGains[chunk - 1] * mGain;
+
+        for (int channel = 0; channel < 2; ++channel)
+            juce::FloatVectorOperations::multiply (mRendered.getWritePointer (channel), mEnvelopeGains, chunk);
+
+        // a position that moved this block ramps across all of it, chunk by chunk
+        if (mGainsRamping)
+        {
+            SpatialLayout::Gains from, to;
+            SpatialLayout::Gains::interpolate (mGainsFrom, mGains, (float) done / (float) numSamples, from);
+            SpatialLayout::Gains::interpolate (mGainsFrom, mGains, (float) (done + chunk) / (float) numSamples, to);
+            addToOutput (dest, destStart + done, mRendered, 0, chunk, mGain, from, to);
+        }
+        else
+        {
+            addToOutput (dest, destStart + done, mRendered, 0, chunk, mGain, mGains, mGains);
+        }
+
+        mSourcePosition += mPitchRatio * chunk;
+        done += chunk;
+
+        // back to the start of the loop: from here on everything comes from memory, so the disk can let go
+        if (mLooping && mSourcePosition >= (double) mLoop->end)
+        {
+            mSourcePosition = (double) mLoop->start + std::fmod (mSourcePosition - (double) mLoop->start, (double) mLoop->getLength());
+
+            for (int i = 0; i < mNumLayers; ++i)
+                mStreams[(size_t) i].stop();
+        }
+
+        // the rings may reuse anything before the first frame the kernel will read next
+        for (int i = 0; i < mNumLayers; ++i)
+            mStreams[(size_t) i].setReadPosition ((juce::int64) mSourcePosition - before);
+
+        if ((! mLooping && mSourcePosition >= length) || ! mEnvelope.isActive())
+        {
+            finishNote();
+            break;
+        }
+    }
+}
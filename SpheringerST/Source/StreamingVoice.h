@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    StreamingVoice.h
+    Created: 17 Oct 2026 1:14:22pm
+    Author:  jwmao
+
+    Sampler voice that plays a SampleZone: the start of the note comes from
+    the zone's preloaded head, everything after it from the voice's own
+    VoiceStream, which the DiskStreamer fills from disk ahead of the playhead.
+    A held note that reaches the sample's sustain loop keeps playing it from
+    memory, and lets go of its stream.
+
+    A zone with several mic layers plays them in sync, a stream each. Their
+    source frames are mixed with the mic levels in one pass before the
+    interpolation, which is linear, so the layers cost one resampling between
+    them. Layers whose level is zero when the note starts are never read.
+
+    Zones loaded at the host rate (see SampleRateConverter) play at their
+    root, and an octave above it from the next mip level, with a pitch ratio
+    of exactly 1: those notes copy the source frames instead of interpolating.
+
+    On a spatial bus (see SpatialLayout) the note is encoded at its own
+    azimuth and elevation, from the settings' centre and spread, its key and
+    its MIDI channel's pan. The encoding gains are only worked out again when
+    that position changes, and ramp to the new values across the block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleZone.h"
+#include "DiskStreamer.h"
+#include "Interpolators.h"
+#include "SpatialLayout.h"
+
+//==============================================================================
+/*
+    Settings every voice shares, owned by the synth. Only the audio thread writes
+    them, at the start of a block before any voice renders, so the voices read
+    them without locks; a new version makes playing voices pick them up too.
+*/
+struct VoiceSettings
+{
+    juce::ADSR::Parameters envelope;
+    InterpolationQuality quality = InterpolationQuality::hermite;
+    juce::uint32 version = 0;
+
+    // offline rendering: voices wait for the disk instead of playing silence when it falls behind
+    bool nonRealtime = false;
+
+    // gain of each mic position (SampleZone::Layer::micPosition), followed by playing notes.
+    // A layer that is at zero when its note starts isn't played by that note at all.
+    std::array<float, SampleZone::maxLayers> micLevels { 1.0f, 0.0f, 0.0f, 0.0f };
+
+    // the output bus; set with the version bumped, so playing notes encode for the new one
+    SpatialLayout spatial;
+
+    // where notes go on a spatial bus, in degrees: the centre, and how far apart the lowest and
+    // highest MIDI notes are around it, low notes to the left
+    float azimuth = 0.0f;
+    float elevation = 0.0f;
+    float spread = 60.0f;
+
+    // each MIDI channel's pan (CC 10), in degrees added to the azimuth of its notes
+    std::array<float, 16> channelAzimuths {};
+};
+
+//==============================================================================
+class StreamingVoice : public juce::SynthesiserVoice
+{
+public:
+    StreamingVoice (DiskStreamer& streamer, const VoiceSettings& settings);
+    ~StreamingVoice() override;
+
+    // loader or message thread: makes room for zones with this many mic layers (streams and scratch).
+    // Must happen before a set with that many layers is published; never shrinks.
+    void prepareLayers (int numLayers);
+
+    bool canPlaySound (juce::SynthesiserSound* sound) override;
+
+    void startNote (int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition) override;
+    void stopNote (float velocity, bool allowTailOff) override;
+
+    void pitchWheelMoved (int newPitchWheelValue) override {}
+    void controllerMoved (int controllerNumber, int newControllerValue) override {}
+
+    void renderNextBlock (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+
+    // envelope times velocity at the end of the last block rendered (audio thread), for quietest-voice stealing
+    float getCurrentLevel() const noexcept { return mLevel; }
+
+    // where the note has got to, for the editor: the SampleData::getId() of its sample and the source frame.
+    // The audio thread stores both as one atomic after every block, so they always belong together.
+    struct Playhead
+    {
+        juce::uint32 sampleId = 0;  // 0 while the voice is idle
+        juce::uint32 frame = 0;
+    };
+
+    // any thread
+    Playhead getPlayhead() const noexcept
+    {
+        const auto packed = mPlayhead.load (std::memory_order_relaxed);
+        return { (juce::uint32) (packed >> 32), (juce::uint32) packed };
+    }
+
+private:
+    // source frames are gathered into a small scratch buffer per chunk before interpolating
+    static constexpr int scratchFrames = 4096;
+
+    // anything higher would need more source frames per output sample than is sensible to read
+    static constexpr double maxPitchRatio = 16.0;
+
+    // a note that's cut off (stolen, or stopped without tail-off) fades out over this long instead of clicking
+    static constexpr double fadeOutSeconds = 0.005;
+    static constexpr int maxFadeOutFrames = 1024;
+
+    // on a spatial bus, the degrees between where a note's left and right channels go
+    static constexpr float sourceWidth = 30.0f;
+
+    // what the note reads of one mic layer, at the level it plays from
+    struct Layer
+    {
+        SampleData* data = nullptr;                     // kept alive by the zone
+        const CompactAudioBuffer* mipLevel = nullptr;   // the level's head, or nullptr for the source's; then the stream
+        const SampleLoop::Level* loop = nullptr;        // at the same frames as every other layer's
+        juce::int64 length = 0;
+        int micPosition = 0;
+        float gain = 0.0f;                              // the mic level the last chunk ended on
+    };
+
+    // mixes source frames [firstFrame, firstFrame + numFrames) of the layers into mScratch,
+    // ramping each from its last gain to its current mic level
+    void fetchSourceFrames (juce::int64 firstFrame, int numFrames) noexcept;
+
+    // one layer's frames into dest, from the loop once the note is looping, otherwise from the mip level,
+    // the head or the stream
+    void fetchLayerFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int numFrames) noexcept;
+
+    // the sample as it is, to dest from destStart on. Frames before the start of the sample are
+    // silent, so the kernels can look back from frame 0.
+    void fetchPlainFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int destStart, int numFrames) noexcept;
+
+    // from the loop's baked buffer, frames past its end wrapping round to its start
+    void fetchLoopFrames (int layer, juce::AudioBuffer<float>& dest, juce::int64 firstFrame, int destStart, int numFrames) noexcept;
+
+    // adds the note to dest, fadeStep > 0 fades it out linearly by that much per sample
+    void renderNote (juce::AudioBuffer<float>& dest, int destStart, int numSamples, float fadeStep) noexcept;
+
+    // adds stereo source to dest: encoded with gains ramping from `from` to `to` if dest is the spatial bus,
+    // otherwise to its first two channels (both halved into one for mono)
+    void addToOutput (juce::AudioBuffer<float>& dest, int destStart, const juce::AudioBuffer<float>& source, int sourceStart,
+                      int numSamples, float gain, const SpatialLayout::Gains& from, const SpatialLayout::Gains& to) const noexcept;
+
+    // works out the note's position and, if it moved (or jump is set), its encoding gains: ramping to them
+    // across the next block, or straight there for a note that's just starting
+    void updatePosition (bool jump) noexcept;
+
+    // renders the next few ms of the note, faded out, into mFadeOut; it plays from the next block on
+    void startFadeOut() noexcept;
+
+    void finishNote() noexcept;
+
+    DiskStreamer& mStreamer;
+    std::array<VoiceStream, SampleZone::maxLayers> mStreams;
+    std::atomic<int> mNumPreparedLayers {0};
+
+    // kept alive by currentlyPlayingSound while the note plays
+    SampleZone* mZone = nullptr;
+
+    double mSourcePosition = 0.0;
+    double mPitchRatio = 1.0;
+
+    // the layers this note plays (the zone's that weren't at zero), all at the same mip level:
+    // an octave-decimated copy of the source, so notes far above the root don't stream at all
+    std::array<Layer, SampleZone::maxLayers> mLayers;
+    int mNumLayers = 0;
+    int mMipLevelIndex = 0;
+    juce::int64 mLength = 0;    // the longest layer's
+    float mGain = 0.0f;
+
+    // the sustain loop at the level this note reads, if every layer has one there. A note still held when it
+    // reaches the crossfade loops until its release has finished; one released earlier plays to the end.
+    const SampleLoop::Level* mLoop = nullptr;
+    bool mReleased = false;
+    bool mLooping = false;
+
+    const VoiceSettings& mSettings;
+    juce::uint32 mSettingsVersion = 0;
+
+    // fixed for the length of a note
+    InterpolationQuality mQuality = InterpolationQuality::hermite;
+    Interpolators::Footprint mFootprint;
+    const float* mSincBand = nullptr;
+    const Interpolators::KernelSet& mKernels;
+
+    juce::ADSR mEnvelope;
+    float mLevel = 0.0f;
+
+    // on a spatial bus: where the note is and its gains there, and where they ramp from this block if it moved
+    int mMidiChannel = 1;
+    float mAzimuth = 0.0f;
+    float mElevation = 0.0f;
+    juce::uint32 mPositionVersion = 0;
+    SpatialLayout::Gains mGains, mGainsFrom;
+    bool mGainsRamping = false;
+
+    std::atomic<juce::uint64> mPlayhead {0};
+
+    juce::AudioBuffer<float> mScratch;
+    std::array<juce::AudioBuffer<float>, SampleZone::maxLayers> mLayerScratch;   // only used with more than one layer
+    juce::AudioBuffer<float> mRendered;
+    juce::HeapBlock<float> mEnvelopeGains;
+
+    // the tail of the last note that was cut off, still playing out while the voice starts its next note
+    juce::AudioBuffer<float> mFadeOut;
+    SpatialLayout::Gains mFadeOutGains;
+    int mFadeOutLength = 0;
+    int mFadeOutPosition = 0;
+
+    JUCE_LEAK_DETECTOR (StreamingVoice)
+};
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.cpp
+    Created: 17 Oct 2026 6:24:51pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "VoiceRenderPool.h"
+#include "RealtimeChecker.h"
+#include "WakeSemaphore.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr juce::uint64 packRange (juce::uint32 head, juce::uint32 tail) noexcept
+    {
+        return ((juce::uint64) head << 32) | tail;
+    }
+
+    // how often the audio thread checks on the workers' last voices before it starts yielding to them
+    constexpr int maxSpins = 2000;
+
+    inline void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #endif
+    }
+}
+
+//==============================================================================
+class VoiceRenderPool::Worker : public juce::Thread
+{
+public:
+    Worker (VoiceRenderPool& o, int index)
+        : juce::Thread ("Spheringer voices " + juce::String (index)), owner (o), participant (index)
+    {
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wake.post();
+        stopThread (1000);
+    }
+
+    void start()
+    {
+        // falls back to a normal thread where realtime scheduling isn't allowed
+        if (! startRealtimeThread (juce::Thread::RealtimeOptions{}.withPriority (9)))
+            startThread (juce::Thread::Priority::highest);
+    }
+
+    // audio thread: once per block. A worker that's still busy with the last one just finds nothing to do
+    void signal() noexcept { wake.post(); }
+
+    void run() override
+    {
+        for (;;)
+        {
+            wake.wait();
+
+            if (threadShouldExit())
+                return;
+
+            const juce::ScopedNoDenormals noDenormals;
+            const RealtimeChecker::ScopedRealtimeThread realtimeThread;
+            owner.runTasks (participant);
+        }
+    }
+
+private:
+    VoiceRenderPool& owner;
+    const int participant;
+    WakeSemaphore wake;
+};
+
+//==============================================================================
+VoiceRenderPool::VoiceRenderPool (int numWorkers)
+{
+    numWorkers = juce::jmax (1, numWorkers);
+
+    // participant 0 is the audio thread itself
+    mNumParticipants = numWorkers + 1;
+    mQueues.reset (new std::atomic<juce::uint64>[(size_t) mNumParticipants]);
+
+    for (int i = 0; i < mNumParticipants; ++i)
+        mQueues[(size_t) i].store (0);
+
+    for (int i = 1; i <= numWorkers; ++i)
+        mWorkers.add (new Worker (*this, i))->start();
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+    mWorkers.clear();
+}
+
+int VoiceRenderPool::getDefaultNumWorkers()
+{
+    return juce::jlimit (1, 7, juce::SystemStats::getNumCpus() - 2);
+}
+
+void VoiceRenderPool::prepare (int maxVoices, int maxBlockSize, int maxChannels)
+{
+    mMaxVoices = juce::jmax (1, maxVoices);
+    mMaxBlockSize = juce::jmax (1, maxBlockSize);
+    mMaxChannels = juce::jmax (1, maxChannels);
+    mScratch.setSize (mMaxChannels * mMaxVoices, mMaxBlockSize);
+}
+
+void VoiceRenderPool::render (juce::SynthesiserVoice* const* voices, int numVoices,
+                              juce::AudioBuffer<float>& dest, int startSample, int numSamples) noexcept
+{
+    jassert (numVoices <= mMaxVoices && numSamples <= mMaxBlockSize);
+
+    mVoices = voices;
+    mNumTasks = numVoices;
+    mNumSamples = numSamples;
+    mNumChannels = juce::jmin (mMaxChannels, dest.getNumChannels());
+    mTasksFinished.store (0, std::memory_order_relaxed);
+
+    // deal the voices out round-robin; the release stores publish the block to whoever claims from them
+    for (int q = 0; q < mNumParticipants; ++q)
+    {
+        const auto numInQueue = q < numVoices ? (numVoices - q + mNumParticipants - 1) / mNumParticipants : 0;
+        mQueues[(size_t) q].store (packRange (0, (juce::uint32) numInQueue), std::memory_order_release);
+    }
+
+    for (auto* worker : mWorkers)
+        worker->signal();
+
+    // renders its own share, then every voice no worker has started on yet: a worker that's slow to wake
+    // leaves its whole queue to the audio thread rather than hold the block up
+    runTasks (0);
+
+    // whatever is left is being rendered right now by a worker and can't be taken over half done. It won't
+    // be long, so a short spin first; past that, a worker that isn't getting the CPU is given it
+    for (int spins = 0; mTasksFinished.load (std::memory_order_acquire) < numVoices; ++spins)
+    {
+        if (spins < maxSpins)
+            pause();
+        else
+            std::this_thread::yield();
+    }
+
+    // fixed order, so the sum doesn't depend on which thread finished first
+    for (int task = 0; task < numVoices; ++task)
+        for (int channel = 0; channel < mNumChannels; ++channel)
+            dest.addFrom (channel, startSample, mScratch, mMaxChannels * task + channel, 0, numSamples);
+}
+
+int VoiceRenderPool::claim (int queue, bool fromFront) noexcept
+{
+    auto& range = mQueues[(size_t) queue];
+    auto current = range.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto head = (juce::uint32) (current >> 32);
+        const auto tail = (juce::uint32) current;
+
+        if (head >= tail)
+            return -1;
+
+        const auto position = fromFront ? head : tail - 1;
+        const auto next = fromFront ? packRange (head + 1, tail) : packRange (head, tail - 1);
+
+        if (range.compare_exchange_weak (current, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            return queue + (int) position * mNumParticipants;
+    }
+}
+
+void VoiceRenderPool::runTasks (int participant) noexcept
+{
+    for (int task; (task = claim (participant, true)) >= 0;)
+        renderTask (task);
+
+    // out of our own work: take from the back of everyone else's
+    for (int i = 1; i < mNumParticipants; ++i)
+    {
+        const auto victim = (participant + i) % mNumParticipants;
+
+        for (int task; (task = claim (victim, false)) >= 0;)
+            renderTask (task);
+    }
+}
+
+void VoiceRenderPool::renderTask (int task) noexcept
+{
+    // refers to the scratch, so nothing is allocated here
+    juce::AudioBuffer<float> voiceBuffer (mScratch.getArrayOfWritePointers() + mMaxChannels * task, mNumChannels, mNumSamples);
+    voiceBuffer.clear();
+
+    mVoices[task]->renderNextBlock (voiceBuffer, 0, mNumSamples);
+
+    mTasksFinished.fetch_add (1, std::memory_order_release);
+}
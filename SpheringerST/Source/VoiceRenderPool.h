@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    Created: 17 Oct 2026 6:24:51pm
+    Author:  jwmao
+
+    Renders a block's active voices on a few realtime worker threads, with
+    the audio thread pitching in. Every participant has its own queue of
+    voices and steals from the others once it runs dry, so one slow voice
+    doesn't hold up the rest. The workers are woken with a semaphore post,
+    which takes no lock on the audio thread, and any voice a worker hasn't
+    started on by the time the audio thread runs out of its own is rendered
+    by the audio thread.
+
+    Each voice renders into a scratch buffer of its own, as many channels as
+    the output bus, and the buffers are added to the output in voice order
+    afterwards. Which thread rendered which voice never changes the result.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class VoiceRenderPool
+{
+public:
+    explicit VoiceRenderPool (int numWorkers);
+    ~VoiceRenderPool();
+
+    // message thread, not while render() may run: scratch for up to maxVoices voices of maxBlockSize samples
+    // and maxChannels channels each
+    void prepare (int maxVoices, int maxBlockSize, int maxChannels = 2);
+
+    int getMaxVoices() const noexcept { return mMaxVoices; }
+    int getMaxBlockSize() const noexcept { return mMaxBlockSize; }
+    int getMaxChannels() const noexcept { return mMaxChannels; }
+    int getNumWorkers() const noexcept { return mWorkers.size(); }
+
+    // below this much work per block, waking the workers costs more than it saves
+    static bool isWorthIt (int numVoices, int numSamples) noexcept
+    {
+        return numVoices >= minVoices && numVoices * numSamples >= minVoiceSamples;
+    }
+
+    // audio thread: renders the voices and adds them to dest. numVoices <= getMaxVoices(), numSamples <= getMaxBlockSize();
+    // dest channels past getMaxChannels() get nothing
+    void render (juce::SynthesiserVoice* const* voices, int numVoices,
+                 juce::AudioBuffer<float>& dest, int startSample, int numSamples) noexcept;
+
+    // a sensible worker count for this machine, leaving a core for the host's audio thread
+    static int getDefaultNumWorkers();
+
+private:
+    class Worker;
+
+    static constexpr int minVoices = 8;
+    static constexpr int minVoiceSamples = 8 * 256;
+
+    // renders from the participant's own queue, then steals from the others until nothing is left
+    void runTasks (int participant) noexcept;
+
+    // claims the next task of a queue, from the front for its owner and from the back for thieves
+    int claim (int queue, bool fromFront) noexcept;
+
+    void renderTask (int task) noexcept;
+
+    juce::OwnedArray<Worker> mWorkers;
+
+    // queue q holds tasks q, q + P, q + 2P... (P participants), as a range of positions:
+    // head in the high 32 bits, tail in the low ones, so owner and thieves claim with one CAS
+    std::unique_ptr<std::atomic<juce::uint64>[]> mQueues;
+    int mNumParticipants = 1;
+
+    // the current block, written by the audio thread before the queues are published
+    juce::SynthesiserVoice* const* mVoices = nullptr;
+    int mNumTasks = 0;
+    int mNumSamples = 0;
+    int mNumChannels = 0;
+    std::atomic<int> mTasksFinished {0};
+
+    // mMaxChannels channels per voice
+    juce::AudioBuffer<float> mScratch;
+    int mMaxVoices = 0;
+    int mMaxBlockSize = 0;
+    int mMaxChannels = 2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoiceRenderPool)
+};
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    WakeSemaphore.h
+    Created: 18 Oct 2026 7:12:40pm
+    Author:  jwmao
+
+    A counting semaphore the audio thread can wake another thread with:
+    post() takes no lock, it's an atomic and a kernel call only if the
+    thread is asleep. WaitableEvent::signal() locks a mutex, which the audio
+    thread mustn't. Used by the voice workers and the reverb's tail thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+class WakeSemaphore
+{
+public:
+   #if JUCE_WINDOWS
+    WakeSemaphore() : handle (CreateSemaphoreW (nullptr, 0, 0x7fffffff, nullptr)) {}
+    ~WakeSemaphore() { CloseHandle (handle); }
+
+    void post() noexcept { ReleaseSemaphore (handle, 1, nullptr); }
+    void wait() noexcept { WaitForSingleObject (handle, INFINITE); }
+
+private:
+    HANDLE handle;
+   #elif JUCE_MAC || JUCE_IOS
+    WakeSemaphore() : semaphore (dispatch_semaphore_create (0)) {}
+    ~WakeSemaphore() { dispatch_release (semaphore); }
+
+    void post() noexcept { dispatch_semaphore_signal (semaphore); }
+    void wait() noexcept { dispatch_semaphore_wait (semaphore, DISPATCH_TIME_FOREVER); }
+
+private:
+    dispatch_semaphore_t semaphore;
+   #else
+    WakeSemaphore() { sem_init (&semaphore, 0, 0); }
+    ~WakeSemaphore() { sem_destroy (&semaphore); }
+
+    void post() noexcept { sem_post (&semaphore); }
+
+    void wait() noexcept
+    {
+        while (sem_wait (&semaphore) != 0 && errno == EINTR)
+        {
+        }
+    }
+
+private:
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (WakeSemaphore)
+};
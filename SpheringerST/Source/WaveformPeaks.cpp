@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    WaveformPeaks.cpp
+    Created: 17 Oct 2026 11:52:36pm
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "WaveformPeaks.h"
+#include "SamplePool.h"
+
+namespace
+{
+    const int magic = (int) juce::ByteOrder::littleEndianInt ("SPPK");
+    constexpr int currentVersion = 2;
+
+    // a cache claiming more than this is corrupt
+    constexpr int maxBuckets = 1 << 28;
+
+    constexpr int framesPerRead = WaveformPeaks::framesPerBucket * 1024;
+
+    inline juce::int16 toInt16 (float sample) noexcept
+    {
+        return (juce::int16) juce::roundToInt (juce::jlimit (-1.0f, 1.0f, sample) * 32767.0f);
+    }
+
+    inline float toFloat (juce::int16 value) noexcept
+    {
+        return (float) value / 32767.0f;
+    }
+}
+
+//==============================================================================
+juce::File WaveformPeaks::getCacheFile (const juce::File& sampleFile)
+{
+    return sampleFile.getSiblingFile (sampleFile.getFileName() + ".peaks");
+}
+
+std::unique_ptr<WaveformPeaks> WaveformPeaks::loadOrBuild (const SampleData& data, const std::function<bool()>& shouldCancel)
+{
+    std::unique_ptr<WaveformPeaks> peaks (new WaveformPeaks());
+    const auto cacheFile = getCacheFile (data.getFile());
+
+    if (auto cache = cacheFile.createInputStream())
+        if (peaks->readFrom (*cache, data.getContentHash()) && peaks->mStartFrame == data.getStartFrame()
+             && peaks->mLengthInSamples == data.getLengthInSamples())
+            return peaks;
+
+    // the first level straight from the file, a chunk at a time
+    peaks.reset (new WaveformPeaks());
+    peaks->mStartFrame = data.getStartFrame();
+    peaks->mLengthInSamples = data.getLengthInSamples();
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    if (! data.isMemoryMapped())
+        if ((reader = data.createReader()) == nullptr)
+            return nullptr;
+
+    const auto numBuckets = (size_t) ((peaks->mLengthInSamples + framesPerBucket - 1) / framesPerBucket);
+    std::vector<juce::int16> level (numBuckets * 2);
+    juce::AudioBuffer<float> chunk (data.getNumChannels(), framesPerRead);
+
+    for (juce::int64 start = 0; start < peaks->mLengthInSamples; start += framesPerRead)
+    {
+        if (shouldCancel())
+            return nullptr;
+
+        const auto numFrames = (int) juce::jmin ((juce::int64) framesPerRead, peaks->mLengthInSamples - start);
+
+        if (reader != nullptr)
+            reader->read (&chunk, 0, numFrames, start, true, true);
+        else
+            data.readMapped (chunk, 0, start, numFrames);
+
+        for (int first = 0; first < numFrames; first += framesPerBucket)
+        {
+            const auto num = juce::jmin (framesPerBucket, numFrames - first);
+            auto range = juce::FloatVectorOperations::findMinAndMax (chunk.getReadPointer (0, first), num);
+
+            for (int channel = 1; channel < chunk.getNumChannels(); ++channel)
+                range = range.getUnionWith (juce::FloatVectorOperations::findMinAndMax (chunk.getReadPointer (channel, first), num));
+
+            const auto bucket = (size_t) ((start + first) / framesPerBucket);
+            level[bucket * 2] = toInt16 (range.getStart());
+            level[bucket * 2 + 1] = toInt16 (range.getEnd());
+        }
+    }
+
+    peaks->mLevels.push_back (std::move (level));
+
+    // then every level from the one before, until a level has a single bucket
+    while (peaks->mLevels.back().size() > 2)
+    {
+        const auto& previous = peaks->mLevels.back();
+        const auto numPrevious = previous.size() / 2;
+        std::vector<juce::int16> next (((numPrevious + 1) / 2) * 2);
+
+        for (size_t i = 0; i < numPrevious; i += 2)
+        {
+            const auto j = juce::jmin (i + 1, numPrevious - 1);
+            next[i] = juce::jmin (previous[i * 2], previous[j * 2]);
+            next[i + 1] = juce::jmax (previous[i * 2 + 1], previous[j * 2 + 1]);
+        }
+
+        peaks->mLevels.push_back (std::move (next));
+    }
+
+    // written to a temporary file first, so another instance never reads half a cache. Read-only folders just don't get one.
+    juce::TemporaryFile temporary (cacheFile);
+
+    if (auto output = temporary.getFile().createOutputStream())
+    {
+        peaks->writeTo (*output, data.getContentHash());
+        output.reset();
+        temporary.overwriteTargetFileWithTemporary();
+    }
+
+    return peaks;
+}
+
+//==============================================================================
+void WaveformPeaks::getColumns (double startFrame, double framesPerColumn, int numColumns, juce::Range<float>* dest) const noexcept
+{
+    // the coarsest level that still has at least one bucket per column
+    size_t levelIndex = 0;
+
+    while (levelIndex + 1 < mLevels.size() && (double) (framesPerBucket << (levelIndex + 1)) <= framesPerColumn)
+        ++levelIndex;
+
+    const auto& level = mLevels[levelIndex];
+    const auto numBuckets = (juce::int64) level.size() / 2;
+    const auto bucketFrames = (double) (framesPerBucket << levelIndex);
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const auto from = startFrame + column * framesPerColumn;
+        const auto first = (juce::int64) std::floor (from / bucketFrames);
+        const auto last = juce::jmax (first + 1, (juce::int64) std::ceil ((from + framesPerColumn) / bucketFrames));
+
+        if (first < 0 || first >= numBuckets)
+        {
+            dest[column] = {};
+            continue;
+        }
+
+        auto low = level[(size_t) first * 2];
+        auto high = level[(size_t) first * 2 + 1];
+
+        for (auto bucket = first + 1; bucket < juce::jmin (last, numBuckets); ++bucket)
+        {
+            low = juce::jmin (low, level[(size_t) bucket * 2]);
+            high = juce::jmax (high, level[(size_t) bucket * 2 + 1]);
+        }
+
+        dest[column] = { toFloat (low), toFloat (high) };
+    }
+}
+
+juce::int64 WaveformPeaks::getSizeInBytes() const noexcept
+{
+    juce::int64 bytes = 0;
+
+    for (auto& level : mLevels)
+        bytes += (juce::int64) (level.size() * sizeof (juce::int16));
+
+    return bytes;
+}
+
+//==============================================================================
+bool WaveformPeaks::readFrom (juce::InputStream& input, const juce::String& contentHash)
+{
+    if (input.readInt() != magic || input.readInt() != currentVersion)
+        return false;
+
+    // a sample that was replaced gets new peaks
+    if (input.readString() != contentHash)
+        return false;
+
+    mStartFrame = input.readInt64();
+    mLengthInSamples = input.readInt64();
+    const auto numLevels = input.readCompressedInt();
+
+    if (mLengthInSamples <= 0 || ! juce::isPositiveAndBelow (numLevels, 64))
+        return false;
+
+    mLevels.clear();
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        const auto numBuckets = input.readCompressedInt();
+
+        if (! juce::isPositiveAndNotGreaterThan (numBuckets, maxBuckets))
+            return false;
+
+        std::vector<juce::int16> level ((size_t) numBuckets * 2);
+
+        for (auto& value : level)
+            value = input.readShort();
+
+        if (input.isExhausted() && i + 1 < numLevels)
+            return false;
+
+        mLevels.push_back (std::move (level));
+    }
+
+    return ! mLevels.empty();
+}
+
+void WaveformPeaks::writeTo (juce::OutputStream& output, const juce::String& contentHash) const
+{
+    output.writeInt (magic);
+    output.writeInt (currentVersion);
+    output.writeString (contentHash);
+    output.writeInt64 (mStartFrame);
+    output.writeInt64 (mLengthInSamples);
+    output.writeCompressedInt ((int) mLevels.size());
+
+    for (auto& level : mLevels)
+    {
+        output.writeCompressedInt ((int) (level.size() / 2));
+
+        for (auto value : level)
+            output.writeShort (value);
+    }
+}
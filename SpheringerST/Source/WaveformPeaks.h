@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    WaveformPeaks.h
+    Created: 17 Oct 2026 11:52:36pm
+    Author:  jwmao
+
+    Min/max peaks of a sample for drawing its waveform, as a pyramid: the
+    first level has the peaks of every 64 frames, each level after it those
+    of twice as many. Drawing picks the coarsest level that still has a
+    bucket per pixel, so a column never looks at more than a few buckets
+    however far the view is zoomed out.
+
+    The pyramid is built on the loader thread, reading the whole file once,
+    and written next to the sample as "<file name>.peaks" with the sample's
+    content hash and where the part that's kept of it starts, so loading it
+    again only reads the cache.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SampleData;
+
+class WaveformPeaks
+{
+public:
+    static constexpr int framesPerBucket = 64;
+
+    // loader thread: reads the cache next to the sample if it's there and still matches the sample,
+    // otherwise reads the sample and writes the cache. nullptr if shouldCancel() stopped it.
+    static std::unique_ptr<WaveformPeaks> loadOrBuild (const SampleData& data, const std::function<bool()>& shouldCancel);
+
+    static juce::File getCacheFile (const juce::File& sampleFile);
+
+    juce::int64 getLengthInSamples() const noexcept { return mLengthInSamples; }
+
+    // any thread: the lowest and highest sample (all channels, -1..1) of each of numColumns columns,
+    // the first one starting at startFrame and each one framesPerColumn long
+    void getColumns (double startFrame, double framesPerColumn, int numColumns, juce::Range<float>* dest) const noexcept;
+
+    juce::int64 getSizeInBytes() const noexcept;
+
+private:
+    WaveformPeaks() = default;
+
+    bool readFrom (juce::InputStream& input, const juce::String& contentHash);
+    void writeTo (juce::OutputStream& output, const juce::String& contentHash) const;
+
+    juce::int64 mStartFrame = 0;
+    juce::int64 mLengthInSamples = 0;
+
+    // per level, a min and a max per bucket, scaled to 16 bits
+    std::vector<std::vector<juce::int16>> mLevels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformPeaks)
+};
@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    WaveformView.cpp
+    Created: 18 Oct 2026 12:20:14am
+    Author:  jwmao
+
+  ==============================================================================
+*/
+
+#include "WaveformView.h"
+
+namespace
+{
+    const juce::Colour backgroundColour { 0xff1b2226 };
+    const juce::Colour waveformColour { 0xff6fb3d2 };
+    const juce::Colour headColour { 0x40ffffff };
+    const juce::Colour loopColour { 0x30f0c040 };
+    const juce::Colour playheadColour { 0xffffffff };
+
+    // the closest zoom shows this many frames per pixel
+    constexpr double minFramesPerPixel = 1.0;
+}
+
+WaveformView::WaveformView()
+{
+    setOpaque (true);
+    startTimerHz (30);
+}
+
+WaveformView::~WaveformView()
+{
+    stopTimer();
+}
+
+void WaveformView::setZone (SampleZone::Ptr zone)
+{
+    if (zone == mZone)
+        return;
+
+    mZone = std::move (zone);
+    mPeaks = mZone != nullptr ? mZone->getData().getPeaks() : nullptr;
+    mVisible = { 0.0, mZone != nullptr ? (double) mZone->getLengthInSamples() : 0.0 };
+    mPlayheadX.clearQuick();
+
+    mWaveformNeedsRendering = true;
+    repaint();
+}
+
+void WaveformView::setVisibleRange (juce::Range<double> frames)
+{
+    if (mZone == nullptr)
+        return;
+
+    const auto length = (double) mZone->getLengthInSamples();
+    const auto minLength = juce::jmin (length, minFramesPerPixel * juce::jmax (1, getWidth()));
+
+    frames.setLength (juce::jlimit (minLength, length, frames.getLength()));
+    frames = frames.movedToStartAt (juce::jlimit (0.0, length - frames.getLength(), frames.getStart()));
+
+    if (frames == mVisible)
+        return;
+
+    mVisible = frames;
+    mWaveformNeedsRendering = true;
+    repaint();
+}
+
+float WaveformView::frameToX (double frame) const noexcept
+{
+    return mVisible.getLength() > 0.0 ? (float) ((frame - mVisible.getStart()) / mVisible.getLength() * getWidth()) : 0.0f;
+}
+
+double WaveformView::xToFrame (float x) const noexcept
+{
+    return mVisible.getStart() + (double) x / juce::jmax (1, getWidth()) * mVisible.getLength();
+}
+
+//==============================================================================
+void WaveformView::timerCallback()
+{
+    // the loader reads the peaks after the set is already playing
+    if (mZone != nullptr && mPeaks == nullptr && mZone->getData().getPeaks() != nullptr)
+    {
+        mPeaks = mZone->getData().getPeaks();
+        mWaveformNeedsRendering = true;
+        repaint();
+    }
+
+    mNewPlayheadX.clearQuick();
+
+    if (mZone != nullptr && getPlayheads != nullptr)
+    {
+        getPlayheads (mZone->getData().getId(), mPlayheadFrames);
+
+        for (auto frame : mPlayheadFrames)
+        {
+            const auto x = juce::roundToInt (frameToX ((double) frame));
+
+            if (juce::isPositiveAndBelow (x, getWidth()))
+                mNewPlayheadX.addIfNotAlreadyThere (x);
+        }
+    }
+
+    // only the columns around lines that appeared or went away
+    for (auto x : mPlayheadX)
+        if (! mNewPlayheadX.contains (x))
+            repaint (x - 1, 0, 3, getHeight());
+
+    for (auto x : mNewPlayheadX)
+        if (! mPlayheadX.contains (x))
+            repaint (x - 1, 0, 3, getHeight());
+
+    mPlayheadX.swapWith (mNewPlayheadX);
+}
+
+void WaveformView::paint (juce::Graphics& g)
+{
+    if (mWaveformNeedsRendering)
+        renderWaveform();
+
+    g.drawImageAt (mWaveform, 0, 0);
+
+    g.setColour (playheadColour);
+
+    for (auto x : mPlayheadX)
+        g.fillRect (x, 0, 1, getHeight());
+}
+
+void WaveformView::resized()
+{
+    setVisibleRange (mVisible);
+    mWaveformNeedsRendering = true;
+}
+
+void WaveformView::renderWaveform()
+{
+    mWaveformNeedsRendering = false;
+
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    if (mWaveform.getWidth() != getWidth() || mWaveform.getHeight() != getHeight())
+        mWaveform = juce::Image (juce::Image::RGB, getWidth(), getHeight(), false);
+
+    juce::Graphics g (mWaveform);
+    g.fillAll (backgroundColour);
+    g.setFont (12.0f);
+
+    if (mZone == nullptr)
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawText ("No sample loaded", getLocalBounds(), juce::Justification::centred);
+        return;
+    }
+
+    const auto height = (float) getHeight();
+
+    // what's preloaded plays before the stream has caught up
+    g.setColour (headColour);
+    g.fillRect (juce::Rectangle<float> (0.0f, 0.0f, juce::jmax (0.0f, frameToX ((double) mZone->getHeadLength())), height)
+                    .withTrimmedTop (height - 3.0f));
+
+    if (auto* loop = mZone->getData().getLoop())
+    {
+        const auto& level = loop->getLevel (0);
+        const auto start = frameToX ((double) level.start);
+
+        g.setColour (loopColour);
+        g.fillRect (juce::Rectangle<float> (start, 0.0f, frameToX ((double) level.end) - start, height));
+    }
+
+    if (mPeaks == nullptr)
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawText ("Reading " + mZone->getName() + "...", getLocalBounds(), juce::Justification::centred);
+        return;
+    }
+
+    mColumns.resize ((size_t) getWidth());
+    mPeaks->getColumns (mVisible.getStart(), mVisible.getLength() / getWidth(), getWidth(), mColumns.data());
+
+    g.setColour (waveformColour);
+
+    const auto middle = height * 0.5f;
+
+    for (int x = 0; x < getWidth(); ++x)
+    {
+        const auto& column = mColumns[(size_t) x];
+        const auto top = middle - column.getEnd() * middle;
+        const auto bottom = middle - column.getStart() * middle;
+
+        g.fillRect ((float) x, top, 1.0f, juce::jmax (1.0f, bottom - top));
+    }
+
+    g.setColour (juce::Colours::white.withAlpha (0.7f));
+    g.drawText (mZone->getName() + "  (root " + juce::MidiMessage::getMidiNoteName (mZone->getMidiRootNote(), true, true, 4) + ")",
+                getLocalBounds().reduced (4, 2), juce::Justification::topLeft);
+}
+
+//==============================================================================
+void WaveformView::mouseWheelMove (const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
+{
+    if (mZone == nullptr)
+        return;
+
+    // keep the frame under the mouse where it is
+    const auto anchor = xToFrame (e.position.x);
+    const auto scale = std::pow (0.5, (double) wheel.deltaY * 2.0);
+    const auto length = mVisible.getLength() * scale;
+    const auto start = anchor - (anchor - mVisible.getStart()) * scale;
+
+    setVisibleRange ({ start, start + length });
+}
+
+void WaveformView::mouseDoubleClick (const juce::MouseEvent&)
+{
+    if (mZone != nullptr)
+        setVisibleRange ({ 0.0, (double) mZone->getLengthInSamples() });
+}
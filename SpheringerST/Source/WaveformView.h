@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    WaveformView.h
+    Created: 18 Oct 2026 12:20:14am
+    Author:  jwmao
+
+    Shows one zone's sample: the waveform from its WaveformPeaks, the part
+    that is preloaded, the sustain loop and a line for every voice playing it.
+
+    The waveform is drawn into an image only when the zone, the zoom or the
+    size changes. The playheads are polled from the voices' atomics 30 times
+    a second, and only the few pixels around playheads that moved are
+    repainted, so a busy view costs the message thread next to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleZone.h"
+
+class WaveformView : public juce::Component,
+                     private juce::Timer
+{
+public:
+    WaveformView();
+    ~WaveformView() override;
+
+    // message thread: the zone to show, nullptr for none. Zoomed all the way out whenever it changes.
+    void setZone (SampleZone::Ptr zone);
+    const SampleZone* getZone() const noexcept { return mZone.get(); }
+
+    // fills in the source frames of the voices playing the sample with that SampleData::getId()
+    std::function<void (juce::uint32 sampleId, juce::Array<juce::int64>& frames)> getPlayheads;
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+    // the wheel zooms around the mouse, a double click shows the whole sample again
+    void mouseWheelMove (const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
+    void mouseDoubleClick (const juce::MouseEvent& e) override;
+
+private:
+    void timerCallback() override;
+
+    // redraws mWaveform, the only place the peaks are read
+    void renderWaveform();
+
+    void setVisibleRange (juce::Range<double> frames);
+
+    float frameToX (double frame) const noexcept;
+    double xToFrame (float x) const noexcept;
+
+    SampleZone::Ptr mZone;
+    const WaveformPeaks* mPeaks = nullptr;  // once the loader has them
+
+    juce::Range<double> mVisible;           // source frames across the width
+    juce::Image mWaveform;
+    bool mWaveformNeedsRendering = true;
+    std::vector<juce::Range<float>> mColumns;
+
+    // where the playhead lines were drawn last, and where they are now
+    juce::Array<int> mPlayheadX, mNewPlayheadX;
+    juce::Array<juce::int64> mPlayheadFrames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformView)
+};
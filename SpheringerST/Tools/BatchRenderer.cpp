@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Created: 17 Oct 2026 8:12:37pm
+    Author:  jwmao
+
+    Headless MIDI to WAV renderer: loads a sample file or folder into the
+    plugin's processor (no editor, no audio device, no display) and renders
+    standard MIDI files through processBlock() as fast as the machine allows.
+    Every MIDI file is a job with its own processor instance, and the jobs run
+    in parallel, one per core by default. The decoded samples are shared
+    between the instances through the SamplePool.
+
+        BatchRenderer --samples <file|folder> [--out <folder>] [--rate 48000]
+                      [--block 512] [--tail 3] [--bits 24] [--jobs N]
+                      [--polyphony 32] [--storage float32|int16|int24]
+                      song1.mid song2.mid ...
+
+    Build as a console app with the same modules and JuceLibraryCode config as
+    the plugin, adding all of ../Source/*.cpp to the target (the editor is
+    linked, but never created). On Linux it needs no X server or audio device.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+namespace
+{
+    struct Options
+    {
+        juce::File samples;
+        juce::File outputFolder;
+        juce::Array<juce::File> midiFiles;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        double tailSeconds = 3.0;
+        int bitsPerSample = 24;
+        int numJobs = juce::SystemStats::getNumCpus();
+        int polyphony = 32;
+        SampleStorage storage = SampleStorage::float32;
+    };
+
+    void printUsage()
+    {
+        std::cout << "usage: BatchRenderer --samples <file|folder> [--out <folder>] [--rate 48000] [--block 512]" << std::endl
+                  << "                     [--tail 3] [--bits 24] [--jobs N] [--polyphony 32]" << std::endl
+                  << "                     [--storage float32|int16|int24] song.mid..." << std::endl;
+    }
+
+    bool parseOptions (const juce::ArgumentList& args, Options& options)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i].text;
+            const auto hasValue = i + 1 < args.size();
+
+            if (arg.startsWith ("--") && ! hasValue)
+                return false;
+
+            if      (arg == "--samples")   options.samples = cwd.getChildFile (args[++i].text);
+            else if (arg == "--out")       options.outputFolder = cwd.getChildFile (args[++i].text);
+            else if (arg == "--rate")      options.sampleRate = args[++i].text.getDoubleValue();
+            else if (arg == "--block")     options.blockSize = args[++i].text.getIntValue();
+            else if (arg == "--tail")      options.tailSeconds = args[++i].text.getDoubleValue();
+            else if (arg == "--bits")      options.bitsPerSample = args[++i].text.getIntValue();
+            else if (arg == "--jobs")      options.numJobs = args[++i].text.getIntValue();
+            else if (arg == "--polyphony") options.polyphony = args[++i].text.getIntValue();
+            else if (arg == "--storage")
+            {
+                const auto name = args[++i].text;
+
+                for (auto storage : { SampleStorage::float32, SampleStorage::int16, SampleStorage::int24 })
+                    if (name == CompactAudioBuffer::getName (storage))
+                        options.storage = storage;
+            }
+            else if (arg.startsWith ("--")) return false;
+            else                            options.midiFiles.add (cwd.getChildFile (arg));
+        }
+
+        if (options.outputFolder == juce::File())
+            options.outputFolder = cwd;
+
+        return options.samples.exists() && ! options.midiFiles.isEmpty()
+            && options.sampleRate > 0.0 && options.blockSize > 0 && options.numJobs > 0
+            && (options.bitsPerSample == 16 || options.bitsPerSample == 24 || options.bitsPerSample == 32);
+    }
+
+    // all tracks merged, timestamps in seconds
+    bool readMidiFile (const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream input (file);
+        juce::MidiFile midiFile;
+
+        if (! input.openedOk() || ! midiFile.readFrom (input))
+            return false;
+
+        midiFile.convertTimestampTicksToSeconds();
+
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+            sequence.addSequence (*midiFile.getTrack (track), 0.0);
+
+        sequence.updateMatchedPairs();
+        return true;
+    }
+
+    //==============================================================================
+    class RenderJob : public juce::ThreadPoolJob
+    {
+    public:
+        RenderJob (const Options& o, const juce::File& midi, std::atomic<int>& failures)
+            : juce::ThreadPoolJob ("Render " + midi.getFileName()), options (o), midiFile (midi), numFailed (failures)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            if (! render())
+                ++numFailed;
+
+            return jobHasFinished;
+        }
+
+    private:
+        bool render()
+        {
+            juce::MidiMessageSequence sequence;
+
+            if (! readMidiFile (midiFile, sequence))
+                return fail ("could not read MIDI file");
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            // a processor of our own, so the jobs share nothing but the decoded samples
+            SpheringerSTAudioProcessor processor;
+            processor.setNonRealtime (true);
+            processor.setPolyphony (options.polyphony);
+            processor.setSampleStorage (options.storage);
+            processor.setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+            processor.prepareToPlay (options.sampleRate, options.blockSize);
+
+            processor.loadSamples (options.samples);
+
+            if (! processor.waitUntilLoaded (10 * 60 * 1000) || processor.getNumSamplerSounds() == 0)
+                return fail ("could not load samples from " + options.samples.getFullPathName());
+
+            const auto outputFile = options.outputFolder.getChildFile (midiFile.getFileNameWithoutExtension() + ".wav");
+            outputFile.deleteFile();
+
+            std::unique_ptr<juce::FileOutputStream> stream (outputFile.createOutputStream());
+
+            if (stream == nullptr)
+                return fail ("could not create " + outputFile.getFullPathName());
+
+            const auto numChannels = processor.getTotalNumOutputChannels();
+            std::unique_ptr<juce::AudioFormatWriter> writer (juce::WavAudioFormat().createWriterFor (stream.get(), options.sampleRate,
+                                                                                                     (unsigned int) numChannels,
+                                                                                                     options.bitsPerSample, {}, 0));
+            if (writer == nullptr)
+                return fail ("could not write " + outputFile.getFullPathName());
+
+            // the writer owns the stream now
+            stream.release();
+
+            const auto lengthInSamples = (juce::int64) std::ceil ((sequence.getEndTime() + options.tailSeconds) * options.sampleRate);
+
+            juce::AudioBuffer<float> buffer (juce::jmax (numChannels, processor.getTotalNumInputChannels()), options.blockSize);
+            juce::MidiBuffer midi;
+            int nextEvent = 0;
+
+            for (juce::int64 position = 0; position < lengthInSamples; position += options.blockSize)
+            {
+                if (shouldExit())
+                    return fail ("cancelled");
+
+                const auto numSamples = (int) juce::jmin ((juce::int64) options.blockSize, lengthInSamples - position);
+                const auto blockEnd = position + numSamples;
+
+                midi.clear();
+
+                for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+                {
+                    const auto& message = sequence.getEventPointer (nextEvent)->message;
+                    const auto samplePosition = (juce::int64) std::floor (message.getTimeStamp() * options.sampleRate);
+
+                    if (samplePosition >= blockEnd)
+                        break;
+
+                    if (! message.isMetaEvent())
+                        midi.addEvent (message, (int) juce::jmax ((juce::int64) 0, samplePosition - position));
+                }
+
+                buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+
+                if (! writer->writeFromAudioSampleBuffer (buffer, 0, numSamples))
+                    return fail ("could not write " + outputFile.getFullPathName());
+            }
+
+            processor.releaseResources();
+            writer.reset();
+
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            const auto renderedSeconds = (double) lengthInSamples / options.sampleRate;
+
+            std::cout << midiFile.getFileName() << " -> " << outputFile.getFullPathName() << ": "
+                      << juce::String (renderedSeconds, 1) << "s in " << juce::String (seconds, 1) << "s ("
+                      << juce::String (renderedSeconds / juce::jmax (seconds, 0.001), 1) << "x realtime)" << std::endl;
+            return true;
+        }
+
+        bool fail (const juce::String& reason)
+        {
+            std::cout << midiFile.getFileName() << ": " << reason << std::endl;
+            return false;
+        }
+
+        const Options& options;
+        const juce::File midiFile;
+        std::atomic<int>& numFailed;
+    };
+}
+
+int main (int argc, char* argv[])
+{
+    // the processor's parameters need a message manager, but nothing here ever shows a window
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+
+    if (! parseOptions (juce::ArgumentList (argc, argv), options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    options.outputFolder.createDirectory();
+
+    std::atomic<int> numFailed {0};
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool (juce::jmin (options.numJobs, options.midiFiles.size()));
+
+        for (auto& file : options.midiFiles)
+            pool.addJob (new RenderJob (options, file, numFailed), true);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (50);
+    }
+
+    std::cout << options.midiFiles.size() - numFailed.load() << " of " << options.midiFiles.size() << " files rendered in "
+              << juce::String ((juce::Time::getMillisecondCounterHiRes() - start) / 1000.0, 1) << "s" << std::endl;
+
+    return numFailed.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 18 Oct 2026 1:53:20pm
+    Author:  jwmao
+
+    Realtime safety check for processBlock(): an audio thread calls it block
+    after block, paced like a host would, with a stream of notes, pitch bends
+    and controllers, while the main thread scripts a session around it:
+    loading the samples, sweeping every parameter, injecting notes through
+    the keyboard state, changing the polyphony and how samples are stored,
+    reloading and stopping a load, swapping the impulse response, and
+    changing the sample rate.
+
+    Every allocation, free, lock or wait on the audio thread (or a voice
+    worker, with --parallel) is a violation, see RealtimeChecker. At the end
+    each distinct one is printed with how often it happened and its stack,
+    and the exit code is 1 if there were any.
+
+        RealtimeCheck [--samples <folder>] [--seconds 2] [--rate 48000]
+                      [--block 256] [--parallel]
+
+    --seconds is how long each step of the session plays for. Without
+    --samples it looks for the bundled "Omni AB_S_*" WAVs in the current
+    folder and the folders above it.
+
+    Build as a console app with the same modules and JuceLibraryCode config as
+    the plugin, adding all of ../Source/*.cpp, and SPHERINGER_REALTIME_CHECKS=1
+    in the preprocessor definitions (for the whole target, so JUCE's own
+    sources see it too). For stacks with function names, link with -rdynamic
+    on Linux.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/RealtimeChecker.h"
+
+namespace
+{
+    struct Options
+    {
+        juce::File samples;
+        double seconds = 2.0;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        bool parallel = false;
+    };
+
+    // the folder the bundled samples are in: here or somewhere above
+    juce::File findSamples()
+    {
+        for (auto folder = juce::File::getCurrentWorkingDirectory(); ! folder.isRoot(); folder = folder.getParentDirectory())
+            if (! folder.findChildFiles (juce::File::findFiles, false, "Omni AB_S_*.wav").isEmpty())
+                return folder;
+
+        return {};
+    }
+
+    bool parseOptions (const juce::ArgumentList& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i].text;
+
+            if (arg == "--parallel")
+            {
+                options.parallel = true;
+                continue;
+            }
+
+            if (i + 1 >= args.size())
+                return false;
+
+            const auto value = args[++i].text;
+
+            if      (arg == "--samples") options.samples = juce::File::getCurrentWorkingDirectory().getChildFile (value);
+            else if (arg == "--seconds") options.seconds = value.getDoubleValue();
+            else if (arg == "--rate")    options.sampleRate = value.getDoubleValue();
+            else if (arg == "--block")   options.blockSize = value.getIntValue();
+            else                         return false;
+        }
+
+        if (options.samples == juce::File())
+            options.samples = findSamples();
+
+        return options.samples.isDirectory() && options.seconds > 0.0 && options.sampleRate > 0.0 && options.blockSize > 0;
+    }
+
+    //==============================================================================
+    // a note every 5 ms, most of them let go again; pitch bends, sustain, modulation and pan in between,
+    // and all notes off now and then
+    class StressGenerator
+    {
+    public:
+        void fillBlock (juce::MidiBuffer& midi, juce::int64 start, int numSamples, double sampleRate)
+        {
+            midi.clear();
+
+            const auto notePeriod = juce::jmax ((juce::int64) 1, (juce::int64) (0.005 * sampleRate));
+
+            for (auto t = ((start + notePeriod - 1) / notePeriod) * notePeriod; t < start + numSamples; t += notePeriod)
+            {
+                const auto offset = (int) (t - start);
+                const auto tick = t / notePeriod;
+                const auto channel = 1 + random.nextInt (4);
+
+                if (random.nextInt (4) != 0)
+                    midi.addEvent (juce::MidiMessage::noteOff (channel, 24 + random.nextInt (84)), offset);
+
+                midi.addEvent (juce::MidiMessage::noteOn (channel, 24 + random.nextInt (84), (juce::uint8) (1 + random.nextInt (127))), offset);
+
+                if (tick % 4 == 0)
+                {
+                    midi.addEvent (juce::MidiMessage::pitchWheel (channel, random.nextInt (16384)), offset);
+                    midi.addEvent (juce::MidiMessage::controllerEvent (channel, 1, random.nextInt (128)), offset);
+                    midi.addEvent (juce::MidiMessage::controllerEvent (channel, 10, random.nextInt (128)), offset);
+                }
+
+                if (tick % 40 == 0)
+                    midi.addEvent (juce::MidiMessage::controllerEvent (channel, 64, (tick / 40) % 2 == 0 ? 127 : 0), offset);
+
+                if (tick % 400 == 0)
+                    midi.addEvent (juce::MidiMessage::allNotesOff (channel), offset);
+            }
+        }
+
+    private:
+        juce::Random random {1234};
+    };
+
+    //==============================================================================
+    // calls processBlock() once per block's worth of time, like a host's audio callback
+    class AudioThread : public juce::Thread
+    {
+    public:
+        AudioThread (SpheringerSTAudioProcessor& p, int block)
+            : juce::Thread ("Realtime check audio"), processor (p), blockSize (block)
+        {
+        }
+
+        ~AudioThread() override
+        {
+            stopThread (5000);
+        }
+
+        void start (double rate)
+        {
+            sampleRate = rate;
+            startThread (juce::Thread::Priority::highest);
+        }
+
+        int getNumBlocks() const noexcept { return numBlocks.load(); }
+
+        void run() override
+        {
+            juce::AudioBuffer<float> buffer (juce::jmax (processor.getTotalNumOutputChannels(), processor.getTotalNumInputChannels()), blockSize);
+
+            // about what a host hands over; the keyboard state's notes are added on top
+            juce::MidiBuffer midi;
+            midi.ensureSize (2048);
+
+            const auto blockMs = 1000.0 * blockSize / sampleRate;
+            auto due = juce::Time::getMillisecondCounterHiRes();
+
+            while (! threadShouldExit())
+            {
+                generator.fillBlock (midi, position, blockSize, sampleRate);
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+
+                position += blockSize;
+                ++numBlocks;
+
+                // a block late is as good as on time here; more than that and the schedule starts over
+                due += blockMs;
+                const auto now = juce::Time::getMillisecondCounterHiRes();
+
+                if (due - now >= 1.0)
+                    wait ((int) (due - now));
+                else if (now - due > blockMs)
+                    due = now;
+            }
+        }
+
+    private:
+        SpheringerSTAudioProcessor& processor;
+        const int blockSize;
+        double sampleRate = 48000.0;
+        StressGenerator generator;
+        juce::int64 position = 0;
+        std::atomic<int> numBlocks {0};
+    };
+
+    //==============================================================================
+    // half a second of decaying noise, so the reverb has a response to swap in
+    juce::File writeImpulseResponse (double sampleRate)
+    {
+        const auto file = juce::File::createTempFile (".wav");
+        const auto numSamples = (int) (0.5 * sampleRate);
+
+        juce::AudioBuffer<float> response (2, numSamples);
+        juce::Random random {42};
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                response.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-8.0f * (float) i / (float) numSamples));
+
+        if (auto output = file.createOutputStream())
+        {
+            std::unique_ptr<juce::AudioFormatWriter> writer (juce::WavAudioFormat().createWriterFor (output.get(), sampleRate, 2, 24, {}, 0));
+
+            if (writer != nullptr)
+            {
+                output.release();
+                writer->writeFromAudioSampleBuffer (response, 0, numSamples);
+            }
+        }
+
+        return file;
+    }
+
+    void step (const char* name, double seconds)
+    {
+        std::cout << name << std::endl;
+        juce::Thread::sleep ((int) (seconds * 1000.0));
+    }
+
+    // every parameter to a random value every few milliseconds, for a while
+    void sweepParameters (SpheringerSTAudioProcessor& processor, double seconds)
+    {
+        std::cout << "parameter sweep" << std::endl;
+
+        juce::Random random {99};
+        const auto end = juce::Time::getMillisecondCounterHiRes() + seconds * 1000.0;
+
+        while (juce::Time::getMillisecondCounterHiRes() < end)
+        {
+            for (auto* parameter : processor.getParameters())
+                parameter->setValueNotifyingHost (random.nextFloat());
+
+            juce::Thread::sleep (3);
+        }
+    }
+
+    // notes from the on-screen keyboard, which reach the audio thread through the processor's ring
+    void playKeyboard (SpheringerSTAudioProcessor& processor, double seconds)
+    {
+        std::cout << "keyboard notes" << std::endl;
+
+        juce::Random random {7};
+        const auto end = juce::Time::getMillisecondCounterHiRes() + seconds * 1000.0;
+
+        while (juce::Time::getMillisecondCounterHiRes() < end)
+        {
+            for (int i = 0; i < 8; ++i)
+                processor.keyboardState.noteOn (1, 36 + random.nextInt (60), random.nextFloat());
+
+            juce::Thread::sleep (10);
+
+            for (int i = 0; i < 8; ++i)
+                processor.keyboardState.noteOff (1, 36 + random.nextInt (60), 0.0f);
+        }
+
+        processor.keyboardState.allNotesOff (1);
+    }
+
+    // the scripted session; the audio thread plays through all of it
+    void runSession (SpheringerSTAudioProcessor& processor, AudioThread& audioThread, const Options& options)
+    {
+        const auto waitForLoader = [&processor] { processor.waitUntilLoaded (5 * 60 * 1000); };
+
+        std::cout << "loading " << options.samples.getFullPathName() << std::endl;
+        processor.loadSamples (options.samples);
+        waitForLoader();
+        step ("playing", options.seconds);
+
+        playKeyboard (processor, options.seconds);
+        sweepParameters (processor, options.seconds);
+
+        // the mic levels the sweep left behind decide which layers this one loads
+        std::cout << "reloading" << std::endl;
+        processor.loadSamples (options.samples);
+        waitForLoader();
+
+        std::cout << "polyphony" << std::endl;
+
+        for (auto numVoices : { 128, 8, 64, 32 })
+        {
+            processor.setPolyphony (numVoices);
+            juce::Thread::sleep ((int) (options.seconds * 250.0));
+        }
+
+        for (auto storage : { SampleStorage::int16, SampleStorage::int24, SampleStorage::float32 })
+        {
+            std::cout << "storage " << CompactAudioBuffer::getName (storage) << std::endl;
+            processor.setSampleStorage (storage);
+            waitForLoader();
+            juce::Thread::sleep ((int) (options.seconds * 500.0));
+        }
+
+        std::cout << "stopped load" << std::endl;
+        processor.loadSamples (options.samples);
+        juce::Thread::sleep (50);
+        processor.stopLoading();
+        waitForLoader();
+        step ("playing", options.seconds);
+
+        const auto impulseResponse = writeImpulseResponse (options.sampleRate);
+        std::cout << "impulse response" << std::endl;
+        processor.loadImpulseResponse (impulseResponse);
+        impulseResponse.deleteFile();
+        step ("playing with reverb", options.seconds);
+
+        // what a host does: stops calling, prepares again, carries on
+        const auto newRate = options.sampleRate == 44100.0 ? 96000.0 : 44100.0;
+        std::cout << "sample rate " << newRate << std::endl;
+        audioThread.stopThread (5000);
+        processor.setRateAndBufferSizeDetails (newRate, options.blockSize);
+        processor.prepareToPlay (newRate, options.blockSize);
+        audioThread.start (newRate);
+        waitForLoader();
+        step ("playing", options.seconds);
+        sweepParameters (processor, options.seconds);
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    // the processor's parameters need a message manager, but nothing here ever shows a window
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+
+    if (! parseOptions (juce::ArgumentList (argc, argv), options))
+    {
+        std::cerr << "usage: RealtimeCheck [--samples <folder>] [--seconds 2] [--rate 48000] [--block 256] [--parallel]" << std::endl;
+        return 1;
+    }
+
+    if (! RealtimeChecker::isEnabled())
+    {
+        std::cerr << "built without SPHERINGER_REALTIME_CHECKS=1, so there's nothing to check" << std::endl;
+        return 1;
+    }
+
+    SpheringerSTAudioProcessor processor;
+    processor.setParallelRendering (options.parallel);
+    processor.setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+    processor.prepareToPlay (options.sampleRate, options.blockSize);
+
+    int numBlocks = 0;
+
+    {
+        AudioThread audioThread (processor, options.blockSize);
+        audioThread.start (options.sampleRate);
+
+        runSession (processor, audioThread, options);
+
+        audioThread.stopThread (5000);
+        numBlocks = audioThread.getNumBlocks();
+    }
+
+    processor.releaseResources();
+
+    const auto violations = RealtimeChecker::takeViolations();
+
+    for (auto& violation : violations)
+        std::cout << std::endl << RealtimeChecker::getName (violation.kind) << ", " << violation.count << " times:" << std::endl
+                  << violation.stackTrace << std::endl;
+
+    std::cout << numBlocks << " blocks, " << violations.size() << " distinct violations" << std::endl;
+    return violations.isEmpty() ? 0 : 1;
+}